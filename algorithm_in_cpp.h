@@ -3,11 +3,924 @@
 
 #pragma once
 
+#include "std.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+
 namespace AlgorithmInCpp
 {
-    
-} // namespace AlgorithmInCpp
+    /**
+     * NOTE 1. Chase-Lev work-stealing deque
+     * The owner thread pushes and pops at the bottom without any lock , the other threads steal from the top with
+     * one compare-and-swap , so the owner works depth first on its newest tasks while thieves take the oldest ,
+     * i.e. the largest pieces of a recursive split. The ring doubles when full; the old rings are kept until the
+     * deque is destroyed since a thief may still be reading one of them.
+     * From "Correct and Efficient Work-Stealing for Weak Memory Models" (Le , Pop , Cohen , Zappa Nardelli) , with its
+     * fences folded into seq_cst / release accesses of top and bottom , which cost the same on x86.
+     */
+    template <typename T>
+    class ChaseLevDeque
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "elements are read by thieves racing with the owner");
+
+        struct Ring
+        {
+            explicit Ring(std::size_t capacity) : mask(capacity - 1), slots(new std::atomic<T>[capacity])
+            {
+            }
+            std::size_t capacity() const noexcept
+            {
+                return mask + 1;
+            }
+            T load(std::int64_t index) const noexcept
+            {
+                return slots[static_cast<std::size_t>(index) & mask].load(std::memory_order_relaxed);
+            }
+            void store(std::int64_t index, T value) noexcept
+            {
+                slots[static_cast<std::size_t>(index) & mask].store(value, std::memory_order_relaxed);
+            }
+
+            std::size_t mask;
+            std::unique_ptr<std::atomic<T>[]> slots;
+        };
+
+    public:
+        // capacity is rounded up to a power of two
+        explicit ChaseLevDeque(std::size_t capacity = 256)
+        {
+            std::size_t rounded = 1;
+            while (rounded < capacity)
+                rounded <<= 1;
+            rings_.push_back(std::make_unique<Ring>(rounded));
+            ring_.store(rings_.back().get(), std::memory_order_relaxed);
+        }
+        ChaseLevDeque(ChaseLevDeque const &) = delete;
+        ChaseLevDeque &operator=(ChaseLevDeque const &) = delete;
+
+        // Owner thread only
+        void push(T value)
+        {
+            auto bottom = bottom_.load(std::memory_order_relaxed);
+            auto top = top_.load(std::memory_order_acquire);
+            auto ring = ring_.load(std::memory_order_relaxed);
+            if (bottom - top >= static_cast<std::int64_t>(ring->capacity()))
+                ring = grow(ring, top, bottom);
+            ring->store(bottom, value);
+            bottom_.store(bottom + 1, std::memory_order_release);
+        }
+        // Owner thread only: the element pushed last , unless the thieves took everything
+        std::optional<T> pop()
+        {
+            auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+            auto ring = ring_.load(std::memory_order_relaxed);
+            // The store of bottom and the load of top must not be reordered , hence seq_cst on both
+            bottom_.store(bottom, std::memory_order_seq_cst);
+            auto top = top_.load(std::memory_order_seq_cst);
+            if (top > bottom)
+            {
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+            auto value = ring->load(bottom);
+            if (top == bottom)
+            {
+                // The last element: whoever moves top first gets it
+                bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                if (!won)
+                    return std::nullopt;
+            }
+            return value;
+        }
+        // Any thread: the oldest element , or nothing when empty or when another thread won the race for it
+        std::optional<T> steal()
+        {
+            auto top = top_.load(std::memory_order_seq_cst);
+            auto bottom = bottom_.load(std::memory_order_seq_cst);
+            if (top >= bottom)
+                return std::nullopt;
+            auto value = ring_.load(std::memory_order_acquire)->load(top);
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return std::nullopt;
+            return value;
+        }
+        // A hint only , the other threads keep moving
+        bool empty() const noexcept
+        {
+            return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        Ring *grow(Ring *ring, std::int64_t top, std::int64_t bottom)
+        {
+            auto bigger = std::make_unique<Ring>(ring->capacity() * 2);
+            for (auto i = top; i < bottom; ++i)
+                bigger->store(i, ring->load(i));
+            rings_.push_back(std::move(bigger));
+            ring_.store(rings_.back().get(), std::memory_order_release);
+            return rings_.back().get();
+        }
+
+        // top and bottom on their own cache lines: thieves only write top , the owner mostly bottom
+        alignas(64) std::atomic<std::int64_t> top_{0};
+        alignas(64) std::atomic<std::int64_t> bottom_{0};
+        std::atomic<Ring *> ring_{nullptr};
+        std::vector<std::unique_ptr<Ring>> rings_; // owner only
+    };
+
+    /**
+     * NOTE 2. Tasks live on the stack of the thread that forks them , the deques only hold pointers: the forking
+     * thread always waits for its tasks before returning , so forking allocates nothing.
+     * An exception thrown by the work is kept and rethrown by the thread waiting for the task.
+     */
+    class Task
+    {
+    public:
+        Task(Task const &) = delete;
+        Task &operator=(Task const &) = delete;
+
+        void run() noexcept
+        {
+            try
+            {
+                invoke_(*this);
+            }
+            catch (...)
+            {
+                error_ = std::current_exception();
+            }
+            // The last access: the owner may destroy the task as soon as it sees done
+            done_.store(true, std::memory_order_release);
+        }
+        bool done() const noexcept
+        {
+            return done_.load(std::memory_order_acquire);
+        }
+        void rethrowIfFailed() const
+        {
+            if (error_)
+                std::rethrow_exception(error_);
+        }
+
+    protected:
+        explicit Task(void (*invoke)(Task &)) noexcept : invoke_(invoke)
+        {
+        }
+        ~Task() = default;
+
+    private:
+        void (*invoke_)(Task &);
+        std::exception_ptr error_;
+        std::atomic<bool> done_{false};
+    };
+
+    template <typename Fn>
+    class FunctionTask final : public Task
+    {
+    public:
+        explicit FunctionTask(Fn &fn) noexcept : Task(&FunctionTask::invoke), fn_(fn)
+        {
+        }
+
+    private:
+        static void invoke(Task &task)
+        {
+            static_cast<FunctionTask &>(task).fn_();
+        }
+
+        Fn &fn_;
+    };
+
+    /**
+     * NOTE 3. Work-stealing thread pool
+     * Every worker owns a ChaseLevDeque. invoke(a, b) pushes b , runs a , then pops b back and runs it unless an
+     * idle worker stole it meanwhile , in which case the caller steals other work until b is done. Threads that
+     * are not workers of the pool enter through run() , which queues the work for the workers and blocks.
+     * Idle workers spin briefly , then sleep until new work is pushed.
+     *
+     * NOTICE a worker of one pool calling run() of another pool blocks like any outside thread
+     */
+    class WorkStealingPool
+    {
+        struct Worker
+        {
+            explicit Worker(unsigned index) : seed(index * 2654435761u + 1)
+            {
+            }
+
+            std::uint32_t seed; // victim selection
+            ChaseLevDeque<Task *> deque;
+            std::thread thread;
+        };
+        struct Current
+        {
+            WorkStealingPool const *pool;
+            Worker *worker;
+        };
+
+    public:
+        explicit WorkStealingPool(unsigned threads = std::thread::hardware_concurrency())
+        {
+            threads = std::max(threads, 1u);
+            workers_.reserve(threads);
+            for (unsigned i = 0; i < threads; ++i)
+                workers_.push_back(std::make_unique<Worker>(i));
+            for (unsigned i = 0; i < threads; ++i)
+                workers_[i]->thread = std::thread([this, i]
+                                                  { workerLoop(*workers_[i]); });
+        }
+        WorkStealingPool(WorkStealingPool const &) = delete;
+        WorkStealingPool &operator=(WorkStealingPool const &) = delete;
+        ~WorkStealingPool()
+        {
+            {
+                std::lock_guard lock(sleepMutex_);
+                stopping_.store(true);
+            }
+            sleep_.notify_all();
+            for (auto &worker : workers_)
+                worker->thread.join();
+        }
+
+        unsigned threadCount() const noexcept
+        {
+            return static_cast<unsigned>(workers_.size());
+        }
+
+        // Run fn on a worker and wait for it , from any thread; a worker of this pool just calls it
+        template <typename Fn>
+        void run(Fn &&fn)
+        {
+            if (currentWorker())
+                return static_cast<void>(fn());
+            FunctionTask<std::remove_reference_t<Fn>> task(fn);
+            {
+                std::lock_guard lock(injectedMutex_);
+                injected_.push_back(&task);
+                injectedCount_.fetch_add(1, std::memory_order_relaxed);
+            }
+            wake();
+            {
+                std::unique_lock lock(injectedMutex_);
+                injectedDone_.wait(lock, [&]
+                                   { return task.done(); });
+            }
+            task.rethrowIfFailed();
+        }
+
+        // Run a and b , in parallel when a worker is idle , and return when both are done. An exception of a is
+        // rethrown in preference to one of b
+        template <typename A, typename B>
+        void invoke(A &&a, B &&b)
+        {
+            auto self = currentWorker();
+            if (!self)
+                return run([&]
+                           { invoke(a, b); });
+            FunctionTask<std::remove_reference_t<B>> right(b);
+            self->deque.push(&right);
+            wake();
+            std::exception_ptr error;
+            try
+            {
+                a();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            // Everything a pushed has been popped or stolen , so the bottom is right unless right was stolen
+            if (auto popped = self->deque.pop())
+            {
+                assert(*popped == &right);
+                right.run();
+            }
+            else
+            {
+                while (!right.done())
+                {
+                    if (auto task = steal(*self))
+                        task->run();
+                    else
+                        std::this_thread::yield();
+                }
+            }
+            if (error)
+                std::rethrow_exception(error);
+            right.rethrowIfFailed();
+        }
+
+    private:
+        static constexpr int spinRounds = 64;
+
+        Worker *currentWorker() const noexcept
+        {
+            return current_.pool == this ? current_.worker : nullptr;
+        }
+
+        void wake()
+        {
+            epoch_.fetch_add(1);
+            if (sleepers_.load() != 0)
+            {
+                std::lock_guard lock(sleepMutex_);
+                sleep_.notify_one();
+            }
+        }
+
+        // Another worker's oldest task , starting from a random victim
+        Task *steal(Worker &self)
+        {
+            self.seed ^= self.seed << 13;
+            self.seed ^= self.seed >> 17;
+            self.seed ^= self.seed << 5;
+            auto count = workers_.size();
+            for (std::size_t i = 0, start = self.seed % count; i < count; ++i)
+            {
+                auto &victim = *workers_[(start + i) % count];
+                if (&victim == &self)
+                    continue;
+                if (auto task = victim.deque.steal())
+                    return *task;
+            }
+            return nullptr;
+        }
+        Task *takeInjected()
+        {
+            if (injectedCount_.load(std::memory_order_relaxed) == 0)
+                return nullptr;
+            std::lock_guard lock(injectedMutex_);
+            if (injected_.empty())
+                return nullptr;
+            auto task = injected_.front();
+            injected_.pop_front();
+            injectedCount_.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+
+        // Own deque first , then the other deques , then the work of outside threads
+        bool runOne(Worker &self)
+        {
+            if (auto task = self.deque.pop())
+            {
+                (*task)->run();
+                return true;
+            }
+            if (auto task = steal(self))
+            {
+                task->run();
+                return true;
+            }
+            if (auto task = takeInjected())
+            {
+                task->run();
+                {
+                    std::lock_guard lock(injectedMutex_);
+                }
+                injectedDone_.notify_all();
+                return true;
+            }
+            return false;
+        }
 
+        void workerLoop(Worker &self)
+        {
+            current_ = {this, &self};
+            while (!stopping_.load())
+            {
+                auto epoch = epoch_.load();
+                bool worked = false;
+                for (int round = 0; round < spinRounds && !worked; ++round)
+                {
+                    worked = runOne(self);
+                    if (!worked)
+                        std::this_thread::yield();
+                }
+                if (worked)
+                    continue;
+                // Nothing was pushed since epoch was read , so sleeping cannot miss a wake()
+                std::unique_lock lock(sleepMutex_);
+                sleepers_.fetch_add(1);
+                sleep_.wait(lock, [&]
+                            { return epoch_.load() != epoch || stopping_.load(); });
+                sleepers_.fetch_sub(1);
+            }
+            current_ = {nullptr, nullptr};
+        }
 
+        static inline thread_local Current current_{nullptr, nullptr};
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::mutex injectedMutex_;
+        std::condition_variable injectedDone_;
+        std::deque<Task *> injected_;
+        std::atomic<std::size_t> injectedCount_{0};
+        std::mutex sleepMutex_;
+        std::condition_variable sleep_;
+        std::atomic<std::uint64_t> epoch_{0};
+        std::atomic<unsigned> sleepers_{0};
+        std::atomic<bool> stopping_{false};
+    };
+
+    // One worker per hardware thread , started on first use
+    inline WorkStealingPool &defaultPool()
+    {
+        static WorkStealingPool pool;
+        return pool;
+    }
+
+    /**
+     * NOTE 4. Parallel algorithms on the pool , with the shapes of their <algorithm> / <numeric> counterparts:
+     * an iterator pair or a range , optionally preceded by a Policy naming the pool and the grain size.
+     * Random access iterators are split recursively until grain elements are left; other iterators run the
+     * sequential std algorithm. Call them qualified , parallel::sort(...) , since ADL also finds std::sort.
+     *
+     * NOTICE as with std::execution::par , the functions are called concurrently on different elements , and
+     * reduce / the scans may regroup the operations , so op must be associative
+     */
+    namespace parallel
+    {
+        class Policy
+        {
+        public:
+            constexpr Policy() = default;
+            // grain 0 picks one from the size of the input
+            explicit Policy(WorkStealingPool &pool, std::size_t grain = 0) noexcept : pool_(&pool), grain_(grain)
+            {
+            }
+            Policy withGrain(std::size_t grain) const noexcept
+            {
+                auto copy = *this;
+                copy.grain_ = grain;
+                return copy;
+            }
+
+            WorkStealingPool &pool() const
+            {
+                return pool_ ? *pool_ : defaultPool();
+            }
+            // Elements per task: the grain given , else about eight tasks per thread but no fewer than minimum elements ,
+            // and everything at once with a single worker , which has nobody to share with
+            std::size_t grainFor(std::size_t count, std::size_t minimum) const
+            {
+                if (grain_)
+                    return grain_;
+                if (pool().threadCount() == 1)
+                    return std::max(count, minimum);
+                auto tasks = std::size_t(pool().threadCount()) * 8;
+                return std::max(minimum, (count + tasks - 1) / tasks);
+            }
+
+        private:
+            WorkStealingPool *pool_ = nullptr;
+            std::size_t grain_ = 0;
+        };
+
+        // The default pool , with the default grain
+        inline constexpr Policy par{};
+
+        namespace detail
+        {
+            // Smallest automatic grains: below them the hand-off to another thread costs more than the work
+            constexpr std::size_t elementGrain = 1024;
+            constexpr std::size_t reduceGrain = 4096;
+            constexpr std::size_t sortGrain = 4096;
+
+            template <typename T, typename = void>
+            constexpr bool isIterator = false;
+            template <typename T>
+            constexpr bool isIterator<T, std::void_t<typename std::iterator_traits<T>::iterator_category>> = true;
+
+            template <typename T, typename = void>
+            constexpr bool isRange = false;
+            template <typename T>
+            constexpr bool isRange<T, std::void_t<decltype(std::begin(std::declval<T &>())), decltype(std::end(std::declval<T &>()))>> = true;
+
+            template <typename... It>
+            constexpr bool isRandomAccess = (std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category> && ...);
+
+            template <typename It>
+            It advanced(It first, std::size_t count)
+            {
+                return first + static_cast<typename std::iterator_traits<It>::difference_type>(count);
+            }
+            template <typename It>
+            std::size_t countOf(It first, It last)
+            {
+                return static_cast<std::size_t>(last - first);
+            }
+
+            // Halve [begin , end) until at most grain indices are left , then call body(begin, end) on every piece
+            template <typename Body>
+            void splitFor(WorkStealingPool &pool, std::size_t begin, std::size_t end, std::size_t grain, Body const &body)
+            {
+                if (end - begin <= grain)
+                    return body(begin, end);
+                auto middle = begin + (end - begin) / 2;
+                pool.invoke([&]
+                            { splitFor(pool, begin, middle, grain, body); },
+                            [&]
+                            { splitFor(pool, middle, end, grain, body); });
+            }
+            template <typename Body>
+            void parallelFor(Policy const &policy, std::size_t count, std::size_t minimumGrain, Body const &body)
+            {
+                auto grain = policy.grainFor(count, minimumGrain);
+                if (count <= grain)
+                    return count ? body(0, count) : void();
+                auto &pool = policy.pool();
+                pool.run([&]
+                         { splitFor(pool, 0, count, grain, body); });
+            }
+
+            // op over a non-empty range , from its first element; std::reduce keeps several partial sums in flight
+            template <typename T, typename It, typename Op>
+            T reduceNonEmpty(It first, It last, Op &op)
+            {
+                T init = *first;
+                return std::reduce(std::next(first), last, std::move(init), op);
+            }
+            template <typename T, typename It, typename Op>
+            T reduceSplit(WorkStealingPool &pool, It first, std::size_t begin, std::size_t end, std::size_t grain, Op &op)
+            {
+                if (end - begin <= grain)
+                    return reduceNonEmpty<T>(advanced(first, begin), advanced(first, end), op);
+                auto middle = begin + (end - begin) / 2;
+                std::optional<T> left, right;
+                pool.invoke([&]
+                            { left.emplace(reduceSplit<T>(pool, first, begin, middle, grain, op)); },
+                            [&]
+                            { right.emplace(reduceSplit<T>(pool, first, middle, end, grain, op)); });
+                return op(std::move(*left), std::move(*right));
+            }
+
+            // Sequential scans from an optional carry , in place when out is first as the std versions allow
+            template <bool inclusive, typename T, typename It, typename Out, typename Op>
+            Out scanSequential(It first, It last, Out out, std::optional<T> carry, Op &op)
+            {
+                if constexpr (!inclusive)
+                    return std::exclusive_scan(first, last, out, std::move(*carry), op);
+                else if (carry)
+                    return std::inclusive_scan(first, last, out, op, std::move(*carry));
+                else
+                    return std::inclusive_scan(first, last, out, op);
+            }
+
+            /**
+             * Scan in three passes over blocks of grain elements: the sum of every block in parallel , the carry
+             * into every block sequentially over the sums , then every block scanned from its carry in parallel.
+             * Each element is read twice , in exchange for running on every thread.
+             */
+            template <bool inclusive, typename T, typename It, typename Out, typename Op>
+            Out scan(Policy const &policy, It first, It last, Out out, std::optional<T> init, Op &op)
+            {
+                auto count = countOf(first, last);
+                auto grain = policy.grainFor(count, reduceGrain);
+                if (count <= grain)
+                    return scanSequential<inclusive>(first, last, out, std::move(init), op);
+                auto blocks = (count + grain - 1) / grain;
+                auto blockFirst = [&](std::size_t block)
+                { return advanced(first, block * grain); };
+                auto blockLast = [&](std::size_t block)
+                { return advanced(first, std::min(count, (block + 1) * grain)); };
+
+                auto &pool = policy.pool();
+                std::vector<std::optional<T>> sums(blocks);
+                pool.run([&]
+                         { splitFor(pool, 0, blocks - 1, 1, [&](std::size_t begin, std::size_t end)
+                                    {
+                                        for (auto block = begin; block < end; ++block)
+                                            sums[block].emplace(reduceNonEmpty<T>(blockFirst(block), blockLast(block), op));
+                                    }); });
+                // sums[block] becomes the carry into block; the last block's own sum is not needed
+                auto carry = std::move(init);
+                for (std::size_t block = 0; block < blocks; ++block)
+                {
+                    auto sum = std::move(sums[block]);
+                    sums[block] = carry;
+                    if (block + 1 < blocks)
+                    {
+                        if (carry)
+                            *carry = op(std::move(*carry), std::move(*sum));
+                        else
+                            carry = std::move(sum);
+                    }
+                }
+                pool.run([&]
+                         { splitFor(pool, 0, blocks, 1, [&](std::size_t begin, std::size_t end)
+                                    {
+                                        for (auto block = begin; block < end; ++block)
+                                            scanSequential<inclusive>(blockFirst(block), blockLast(block), advanced(out, block * grain), std::move(sums[block]), op);
+                                    }); });
+                return advanced(out, count);
+            }
+
+            // Stable parallel merge: split the longer run in the middle , binary search the split of the other one
+            template <typename It, typename Out, typename Compare>
+            void mergeSplit(WorkStealingPool &pool, It first1, It last1, It first2, It last2, Out out, std::size_t grain, Compare &comp)
+            {
+                auto size1 = countOf(first1, last1), size2 = countOf(first2, last2);
+                if (size1 + size2 <= grain)
+                {
+                    std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1), std::make_move_iterator(first2),
+                               std::make_move_iterator(last2), out, comp);
+                    return;
+                }
+                It middle1, middle2;
+                if (size1 >= size2)
+                {
+                    middle1 = advanced(first1, size1 / 2);
+                    middle2 = std::lower_bound(first2, last2, *middle1, comp);
+                }
+                else
+                {
+                    middle2 = advanced(first2, size2 / 2);
+                    middle1 = std::upper_bound(first1, last1, *middle2, comp);
+                }
+                auto outMiddle = advanced(out, countOf(first1, middle1) + countOf(first2, middle2));
+                pool.invoke([&]
+                            { mergeSplit(pool, first1, middle1, first2, middle2, out, grain, comp); },
+                            [&]
+                            { mergeSplit(pool, middle1, last1, middle2, last2, outMiddle, grain, comp); });
+            }
+
+            // Sort a[0 , count) leaving the result in a , or in b when toB; b is scratch of as many elements
+            template <typename A, typename B, typename Compare>
+            void mergeSort(WorkStealingPool &pool, A a, B b, std::size_t count, bool toB, std::size_t grain, Compare &comp)
+            {
+                if (count <= grain)
+                {
+                    std::sort(a, advanced(a, count), comp);
+                    if (toB)
+                        std::move(a, advanced(a, count), b);
+                    return;
+                }
+                auto half = count / 2;
+                pool.invoke([&]
+                            { mergeSort(pool, a, b, half, !toB, grain, comp); },
+                            [&]
+                            { mergeSort(pool, advanced(a, half), advanced(b, half), count - half, !toB, grain, comp); });
+                // The halves are where !toB left them
+                if (toB)
+                    mergeSplit(pool, a, advanced(a, half), advanced(a, half), advanced(a, count), b, grain, comp);
+                else
+                    mergeSplit(pool, b, advanced(b, half), advanced(b, half), advanced(b, count), a, grain, comp);
+            }
+        } // namespace detail
+
+        template <typename It, typename Fn, typename = std::enable_if_t<detail::isIterator<It>>>
+        void forEach(Policy const &policy, It first, It last, Fn fn)
+        {
+            if constexpr (!detail::isRandomAccess<It>)
+                std::for_each(first, last, fn);
+            else
+                detail::parallelFor(policy, detail::countOf(first, last), detail::elementGrain, [&](std::size_t begin, std::size_t end)
+                                    { std::for_each(detail::advanced(first, begin), detail::advanced(first, end), fn); });
+        }
+        template <typename It, typename Fn, typename = std::enable_if_t<detail::isIterator<It>>>
+        void forEach(It first, It last, Fn fn)
+        {
+            forEach(par, first, last, std::move(fn));
+        }
+        template <typename Range, typename Fn, typename = std::enable_if_t<detail::isRange<Range>>>
+        void forEach(Policy const &policy, Range &&range, Fn fn)
+        {
+            forEach(policy, std::begin(range), std::end(range), std::move(fn));
+        }
+        template <typename Range, typename Fn, typename = std::enable_if_t<detail::isRange<Range>>>
+        void forEach(Range &&range, Fn fn)
+        {
+            forEach(par, std::begin(range), std::end(range), std::move(fn));
+        }
+
+        template <typename It, typename Out, typename Op, typename = std::enable_if_t<detail::isIterator<It>>>
+        Out transform(Policy const &policy, It first, It last, Out out, Op op)
+        {
+            if constexpr (!detail::isRandomAccess<It, Out>)
+                return std::transform(first, last, out, op);
+            else
+            {
+                auto count = detail::countOf(first, last);
+                detail::parallelFor(policy, count, detail::elementGrain, [&](std::size_t begin, std::size_t end)
+                                    { std::transform(detail::advanced(first, begin), detail::advanced(first, end), detail::advanced(out, begin), op); });
+                return detail::advanced(out, count);
+            }
+        }
+        template <typename It, typename Out, typename Op, typename = std::enable_if_t<detail::isIterator<It>>>
+        Out transform(It first, It last, Out out, Op op)
+        {
+            return transform(par, first, last, out, std::move(op));
+        }
+        // Binary transform: out[i] = op(first1[i] , first2[i])
+        template <typename It1, typename It2, typename Out, typename Op, typename = std::enable_if_t<detail::isIterator<It1>>>
+        Out transform(Policy const &policy, It1 first1, It1 last1, It2 first2, Out out, Op op)
+        {
+            if constexpr (!detail::isRandomAccess<It1, It2, Out>)
+                return std::transform(first1, last1, first2, out, op);
+            else
+            {
+                auto count = detail::countOf(first1, last1);
+                detail::parallelFor(policy, count, detail::elementGrain, [&](std::size_t begin, std::size_t end)
+                                    { std::transform(detail::advanced(first1, begin), detail::advanced(first1, end), detail::advanced(first2, begin),
+                                                     detail::advanced(out, begin), op); });
+                return detail::advanced(out, count);
+            }
+        }
+        template <typename It1, typename It2, typename Out, typename Op, typename = std::enable_if_t<detail::isIterator<It1>>>
+        Out transform(It1 first1, It1 last1, It2 first2, Out out, Op op)
+        {
+            return transform(par, first1, last1, first2, out, std::move(op));
+        }
+        template <typename Range, typename Out, typename Op, typename = std::enable_if_t<detail::isRange<Range>>>
+        Out transform(Policy const &policy, Range &&range, Out out, Op op)
+        {
+            return transform(policy, std::begin(range), std::end(range), out, std::move(op));
+        }
+        template <typename Range, typename Out, typename Op, typename = std::enable_if_t<detail::isRange<Range>>>
+        Out transform(Range &&range, Out out, Op op)
+        {
+            return transform(par, std::begin(range), std::end(range), out, std::move(op));
+        }
+
+        template <typename It, typename T, typename Op, typename = std::enable_if_t<detail::isIterator<It>>>
+        T reduce(Policy const &policy, It first, It last, T init, Op op)
+        {
+            if constexpr (!detail::isRandomAccess<It>)
+                return std::accumulate(first, last, std::move(init), op);
+            else
+            {
+                auto count = detail::countOf(first, last);
+                auto grain = policy.grainFor(count, detail::reduceGrain);
+                if (count <= grain)
+                    return std::reduce(first, last, std::move(init), op);
+                auto &pool = policy.pool();
+                std::optional<T> total;
+                pool.run([&]
+                         { total.emplace(detail::reduceSplit<T>(pool, first, 0, count, grain, op)); });
+                return op(std::move(init), std::move(*total));
+            }
+        }
+        template <typename It, typename T, typename = std::enable_if_t<detail::isIterator<It>>>
+        T reduce(Policy const &policy, It first, It last, T init)
+        {
+            return reduce(policy, first, last, std::move(init), std::plus<>());
+        }
+        template <typename It, typename = std::enable_if_t<detail::isIterator<It>>>
+        auto reduce(Policy const &policy, It first, It last)
+        {
+            return reduce(policy, first, last, typename std::iterator_traits<It>::value_type{}, std::plus<>());
+        }
+        template <typename It, typename T, typename Op, typename = std::enable_if_t<detail::isIterator<It>>>
+        T reduce(It first, It last, T init, Op op)
+        {
+            return reduce(par, first, last, std::move(init), std::move(op));
+        }
+        template <typename It, typename T, typename = std::enable_if_t<detail::isIterator<It>>>
+        T reduce(It first, It last, T init)
+        {
+            return reduce(par, first, last, std::move(init), std::plus<>());
+        }
+        template <typename It, typename = std::enable_if_t<detail::isIterator<It>>>
+        auto reduce(It first, It last)
+        {
+            return reduce(par, first, last);
+        }
+        template <typename Range, typename T, typename Op, typename = std::enable_if_t<detail::isRange<Range>>>
+        T reduce(Policy const &policy, Range &&range, T init, Op op)
+        {
+            return reduce(policy, std::begin(range), std::end(range), std::move(init), std::move(op));
+        }
+        template <typename Range, typename T, typename = std::enable_if_t<detail::isRange<Range>>>
+        T reduce(Policy const &policy, Range &&range, T init)
+        {
+            return reduce(policy, std::begin(range), std::end(range), std::move(init), std::plus<>());
+        }
+        template <typename Range, typename T, typename Op, typename = std::enable_if_t<detail::isRange<Range>>>
+        T reduce(Range &&range, T init, Op op)
+        {
+            return reduce(par, std::begin(range), std::end(range), std::move(init), std::move(op));
+        }
+        template <typename Range, typename T, typename = std::enable_if_t<detail::isRange<Range>>>
+        T reduce(Range &&range, T init)
+        {
+            return reduce(par, std::begin(range), std::end(range), std::move(init), std::plus<>());
+        }
+
+        // out[i] = first[0] op ... op first[i] , out may be first
+        template <typename It, typename Out, typename Op, typename = std::enable_if_t<detail::isIterator<It>>>
+        Out inclusiveScan(Policy const &policy, It first, It last, Out out, Op op)
+        {
+            using T = typename std::iterator_traits<It>::value_type;
+            if constexpr (!detail::isRandomAccess<It, Out>)
+                return std::inclusive_scan(first, last, out, op);
+            else
+                return detail::scan<true>(policy, first, last, out, std::optional<T>(), op);
+        }
+        template <typename It, typename Out, typename = std::enable_if_t<detail::isIterator<It>>>
+        Out inclusiveScan(Policy const &policy, It first, It last, Out out)
+        {
+            return inclusiveScan(policy, first, last, out, std::plus<>());
+        }
+        template <typename It, typename Out, typename Op, typename = std::enable_if_t<detail::isIterator<It>>>
+        Out inclusiveScan(It first, It last, Out out, Op op)
+        {
+            return inclusiveScan(par, first, last, out, std::move(op));
+        }
+        template <typename It, typename Out, typename = std::enable_if_t<detail::isIterator<It>>>
+        Out inclusiveScan(It first, It last, Out out)
+        {
+            return inclusiveScan(par, first, last, out, std::plus<>());
+        }
+
+        // out[i] = init op first[0] op ... op first[i - 1] , out may be first
+        template <typename It, typename Out, typename T, typename Op, typename = std::enable_if_t<detail::isIterator<It>>>
+        Out exclusiveScan(Policy const &policy, It first, It last, Out out, T init, Op op)
+        {
+            if constexpr (!detail::isRandomAccess<It, Out>)
+                return std::exclusive_scan(first, last, out, std::move(init), op);
+            else
+                return detail::scan<false>(policy, first, last, out, std::optional<T>(std::move(init)), op);
+        }
+        template <typename It, typename Out, typename T, typename = std::enable_if_t<detail::isIterator<It>>>
+        Out exclusiveScan(Policy const &policy, It first, It last, Out out, T init)
+        {
+            return exclusiveScan(policy, first, last, out, std::move(init), std::plus<>());
+        }
+        template <typename It, typename Out, typename T, typename Op, typename = std::enable_if_t<detail::isIterator<It>>>
+        Out exclusiveScan(It first, It last, Out out, T init, Op op)
+        {
+            return exclusiveScan(par, first, last, out, std::move(init), std::move(op));
+        }
+        template <typename It, typename Out, typename T, typename = std::enable_if_t<detail::isIterator<It>>>
+        Out exclusiveScan(It first, It last, Out out, T init)
+        {
+            return exclusiveScan(par, first, last, out, std::move(init), std::plus<>());
+        }
+
+        /**
+         * Merge sort: both halves sorted in parallel , then merged in parallel , ping-ponging between the range and
+         * a buffer of the same size. Not stable , like std::sort , since the pieces of grain elements are std::sort-ed.
+         * NOTICE if comp throws , the elements are left valid but unspecified , some of them possibly moved-from
+         */
+        template <typename It, typename Compare, typename = std::enable_if_t<detail::isIterator<It>>>
+        void sort(Policy const &policy, It first, It last, Compare comp)
+        {
+            static_assert(detail::isRandomAccess<It>, "sort needs random access iterators , as std::sort");
+            auto count = detail::countOf(first, last);
+            auto grain = policy.grainFor(count, detail::sortGrain);
+            if (count <= grain)
+                return std::sort(first, last, comp);
+            // The values move to the buffer , the moved-from elements of the range are the scratch space
+            std::vector<typename std::iterator_traits<It>::value_type> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+            auto &pool = policy.pool();
+            pool.run([&]
+                     { detail::mergeSort(pool, buffer.begin(), first, count, true, grain, comp); });
+        }
+        template <typename It, typename = std::enable_if_t<detail::isIterator<It>>>
+        void sort(Policy const &policy, It first, It last)
+        {
+            sort(policy, first, last, std::less<>());
+        }
+        template <typename It, typename Compare, typename = std::enable_if_t<detail::isIterator<It>>>
+        void sort(It first, It last, Compare comp)
+        {
+            sort(par, first, last, std::move(comp));
+        }
+        template <typename It, typename = std::enable_if_t<detail::isIterator<It>>>
+        void sort(It first, It last)
+        {
+            sort(par, first, last, std::less<>());
+        }
+        template <typename Range, typename Compare, typename = std::enable_if_t<detail::isRange<Range>>>
+        void sort(Policy const &policy, Range &&range, Compare comp)
+        {
+            sort(policy, std::begin(range), std::end(range), std::move(comp));
+        }
+        template <typename Range, typename = std::enable_if_t<detail::isRange<Range>>>
+        void sort(Policy const &policy, Range &&range)
+        {
+            sort(policy, std::begin(range), std::end(range), std::less<>());
+        }
+        template <typename Range, typename Compare, typename = std::enable_if_t<detail::isRange<Range>>>
+        void sort(Range &&range, Compare comp)
+        {
+            sort(par, std::begin(range), std::end(range), std::move(comp));
+        }
+        template <typename Range, typename = std::enable_if_t<detail::isRange<Range>>>
+        void sort(Range &&range)
+        {
+            sort(par, std::begin(range), std::end(range), std::less<>());
+        }
+    } // namespace parallel
+
+} // namespace AlgorithmInCpp
 
-#endif
\ No newline at end of file
+#endif
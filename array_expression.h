@@ -0,0 +1,168 @@
+#ifndef ARRAY_EXPRESSION_H
+#define ARRAY_EXPRESSION_H
+
+#pragma once
+
+#include "cpp_features.h"
+#include "instrumentation.h"
+#include <thread>
+
+namespace CppFeatures
+{
+    /**
+     * NOTE 3. Expression templates
+     * Applying Operation<op> (or + - * /) to array views builds a lazy ArrayExpression node instead of a result
+     * array , e.g. a * b + c - d is a tree of nodes holding views. Nothing is computed until the tree is assigned
+     * to a destination view , which then runs a single fused loop: no temporary array is materialized and every
+     * input element is read once.
+     */
+    template <typename T>
+    class ArrayView
+    {
+    public:
+        using value_type = std::remove_const_t<T>;
+
+        constexpr ArrayView(T *data, std::size_t size) : data_(data), size_(size)
+        {
+        }
+        template <typename Container, typename = std::enable_if_t<!isArrayOperand<Container>, decltype(std::data(std::declval<Container &>()))>>
+        constexpr ArrayView(Container &container) : ArrayView(std::data(container), std::size(container))
+        {
+        }
+
+        constexpr T &operator[](std::size_t i) const
+        {
+            return data_[i];
+        }
+        constexpr std::size_t size() const
+        {
+            return size_;
+        }
+        constexpr T *data() const
+        {
+            return data_;
+        }
+
+        // Evaluate an expression into the viewed elements , assigning a view of the same type rebinds it instead
+        template <typename Expr, typename = std::enable_if_t<isArrayOperand<Expr>>>
+        ArrayView const &operator=(Expr const &expr) const
+        {
+            evaluate(*this, expr);
+            return *this;
+        }
+
+    private:
+        T *data_;
+        std::size_t size_;
+    };
+    template <typename Container>
+    ArrayView(Container &) -> ArrayView<std::remove_pointer_t<decltype(std::data(std::declval<Container &>()))>>;
+
+    template <typename T>
+    struct IsArrayOperand<ArrayView<T>> : std::true_type
+    {
+    };
+    template <Operators op, typename L, typename R>
+    struct IsArrayOperand<ArrayExpression<op, L, R>> : std::true_type
+    {
+    };
+
+    // Element i of an operand , scalars are broadcast to every element
+    template <typename T>
+    constexpr decltype(auto) elementAt(T const &operand, std::size_t i)
+    {
+        if constexpr (isArrayOperand<T>)
+            return operand[i];
+        else
+            return (operand);
+    }
+    template <typename T>
+    constexpr std::size_t operandSize(T const &operand)
+    {
+        if constexpr (isArrayOperand<T>)
+            return operand.size();
+        else
+            return 0;
+    }
+
+    template <Operators op, typename L, typename R>
+    struct ArrayExpression
+    {
+        L lhs;
+        R rhs;
+
+        constexpr auto operator[](std::size_t i) const
+        {
+            return Operation<op>{}(elementAt(lhs, i), elementAt(rhs, i));
+        }
+        constexpr std::size_t size() const
+        {
+            assert(!isArrayOperand<L> || !isArrayOperand<R> || operandSize(lhs) == operandSize(rhs));
+            return isArrayOperand<L> ? operandSize(lhs) : operandSize(rhs);
+        }
+    };
+
+    template <typename L, typename R>
+    using EnableIfArrayOperands = std::enable_if_t<isArrayOperand<L> || isArrayOperand<R>>;
+
+    template <typename L, typename R, typename = EnableIfArrayOperands<L, R>>
+    constexpr auto operator+(L const &lhs, R const &rhs)
+    {
+        return Operation<Operators::Add>{}(lhs, rhs);
+    }
+    template <typename L, typename R, typename = EnableIfArrayOperands<L, R>>
+    constexpr auto operator-(L const &lhs, R const &rhs)
+    {
+        return Operation<Operators::Sub>{}(lhs, rhs);
+    }
+    template <typename L, typename R, typename = EnableIfArrayOperands<L, R>>
+    constexpr auto operator*(L const &lhs, R const &rhs)
+    {
+        return Operation<Operators::Mut>{}(lhs, rhs);
+    }
+    template <typename L, typename R, typename = EnableIfArrayOperands<L, R>>
+    constexpr auto operator/(L const &lhs, R const &rhs)
+    {
+        return Operation<Operators::Div>{}(lhs, rhs);
+    }
+
+    // The fused loop: one pass over the inputs , one store per element. Instrumented per evaluation , outside the
+    // loop , so that it still vectorizes
+    template <typename T, typename Expr>
+    void evaluate(ArrayView<T> const &dest, Expr const &expr, std::size_t first = 0, std::size_t last = std::size_t(-1))
+    {
+        assert(expr.size() == dest.size());
+        last = std::min(last, dest.size());
+        TCG_COUNTER_INC("CppFeatures.ArrayExpression.evaluate");
+        TCG_COUNTER_ADD("CppFeatures.ArrayExpression.elements", last > first ? last - first : 0);
+        auto out = dest.data();
+        for (auto i = first; i < last; ++i)
+            out[i] = expr[i];
+    }
+
+    /**
+     * Evaluate large arrays in contiguous chunks on several threads , each chunk being the same fused loop.
+     * Arrays shorter than minChunk elements per thread are evaluated on the calling thread.
+     */
+    template <typename T, typename Expr>
+    void evaluateParallel(ArrayView<T> const &dest, Expr const &expr, unsigned threads = std::thread::hardware_concurrency(),
+                          std::size_t minChunk = std::size_t(1) << 16)
+    {
+        auto size = dest.size();
+        threads = static_cast<unsigned>(std::min<std::size_t>(std::max(threads, 1u), std::max<std::size_t>(size / minChunk, 1)));
+        if (threads == 1)
+            return evaluate(dest, expr);
+        auto chunk = (size + threads - 1) / threads;
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        for (unsigned t = 1; t < threads; ++t)
+            workers.emplace_back([&, t]
+                                 { evaluate(dest, expr, t * chunk, (t + 1) * chunk); });
+        evaluate(dest, expr, 0, chunk);
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+} // namespace CppFeatures
+
+#endif
@@ -0,0 +1,553 @@
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#pragma once
+
+#include "buffered_print.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter4
+    {
+        /**
+         * NOTE 11. Asynchronous detailedPrint
+         * Same call shape and same overload selection as overload::preferred::detailedPrint , but the calling
+         * thread only copies the raw arguments into a ring buffer of its own , next to a pointer to a function
+         * instantiated for the selected overloads: the compile-time descriptor of the record. A background thread
+         * decodes the records , formats them the way detailedPrint does and writes them to a file in batches.
+         *
+         *  AsyncLogger log("app.log");
+         *  log.detailedPrint(42, 3.25, std::string("text"), 'c'); // int , double , string and generic printers
+         *
+         * NOTICE the lines of different threads are ordered per thread only
+         */
+        namespace asynchronous
+        {
+            // NOTE 11.1 The overload chosen for an argument , exactly as detailedPrintArg is chosen
+            struct IntArg
+            {
+            };
+            struct DoubleArg
+            {
+            };
+            struct StringArg
+            {
+            };
+            template <typename T>
+            struct GenericArg
+            {
+            };
+
+            template <typename T>
+            GenericArg<T> select(T const &);
+            IntArg select(int);
+            DoubleArg select(double);
+            StringArg select(std::string const &);
+
+            template <typename T>
+            using Selected = decltype(select(std::declval<T const &>()));
+
+            // NOTE 11.2 Encoding of one argument on the calling thread , decoding and formatting on the background one
+            template <typename Tag>
+            struct Codec;
+
+            template <typename T>
+            void appendFormatted(std::string &line, T value)
+            {
+                char text[buffered::FormattedSize<T>::value];
+                line.append(text, buffered::formatPiece(text, value));
+            }
+
+            template <>
+            struct Codec<IntArg>
+            {
+                static int stage(int arg)
+                {
+                    return arg;
+                }
+                static std::size_t size(int)
+                {
+                    return sizeof(int);
+                }
+                static char *encode(char *out, int arg)
+                {
+                    std::memcpy(out, &arg, sizeof arg);
+                    return out + sizeof arg;
+                }
+                static char const *decode(char const *in, std::string &line)
+                {
+                    int arg;
+                    std::memcpy(&arg, in, sizeof arg);
+                    line += "Calling int printer: ";
+                    appendFormatted(line, arg);
+                    line += '\n';
+                    return in + sizeof arg;
+                }
+            };
+            template <>
+            struct Codec<DoubleArg>
+            {
+                static double stage(double arg)
+                {
+                    return arg;
+                }
+                static std::size_t size(double)
+                {
+                    return sizeof(double);
+                }
+                static char *encode(char *out, double arg)
+                {
+                    std::memcpy(out, &arg, sizeof arg);
+                    return out + sizeof arg;
+                }
+                static char const *decode(char const *in, std::string &line)
+                {
+                    double arg;
+                    std::memcpy(&arg, in, sizeof arg);
+                    line += "Calling double printer: ";
+                    appendFormatted(line, arg);
+                    line += '\n';
+                    return in + sizeof arg;
+                }
+            };
+
+            // Text is stored as its length followed by the characters
+            inline std::size_t textSize(std::string_view text)
+            {
+                return sizeof(std::uint32_t) + text.size();
+            }
+            inline char *encodeText(char *out, std::string_view text)
+            {
+                auto length = static_cast<std::uint32_t>(text.size());
+                std::memcpy(out, &length, sizeof length);
+                std::memcpy(out + sizeof length, text.data(), text.size());
+                return out + sizeof length + text.size();
+            }
+            inline char const *decodeText(char const *in, std::string &line)
+            {
+                std::uint32_t length;
+                std::memcpy(&length, in, sizeof length);
+                line.append(in + sizeof length, length);
+                return in + sizeof length + length;
+            }
+
+            template <>
+            struct Codec<StringArg>
+            {
+                static std::string_view stage(std::string const &arg)
+                {
+                    return arg;
+                }
+                static std::size_t size(std::string_view arg)
+                {
+                    return textSize(arg);
+                }
+                static char *encode(char *out, std::string_view arg)
+                {
+                    return encodeText(out, arg);
+                }
+                static char const *decode(char const *in, std::string &line)
+                {
+                    line += "Calling string printer: ";
+                    in = decodeText(in, line);
+                    line += '\n';
+                    return in;
+                }
+            };
+
+            /**
+             * Trivially copyable values are copied as they are and streamed on the background thread , so is
+             * typeid(T).name(). Text is copied , as the pointer may not outlive the call; any other type is
+             * streamed on the calling thread , the slow path of buffered::piece too.
+             */
+            template <typename T>
+            struct Codec<GenericArg<T>>
+            {
+                static constexpr bool isText = std::is_convertible_v<T const &, std::string_view>;
+                static constexpr bool isRaw = !isText && std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>;
+
+                static decltype(auto) stage(T const &arg)
+                {
+                    if constexpr (isRaw)
+                        return arg;
+                    else if constexpr (isText)
+                        return std::string_view(arg);
+                    else
+                    {
+                        std::ostringstream os;
+                        os << arg;
+                        return std::move(os).str();
+                    }
+                }
+                template <typename Staged>
+                static std::size_t size(Staged const &staged)
+                {
+                    if constexpr (isRaw)
+                        return sizeof(T);
+                    else
+                        return textSize(staged);
+                }
+                template <typename Staged>
+                static char *encode(char *out, Staged const &staged)
+                {
+                    if constexpr (isRaw)
+                    {
+                        std::memcpy(out, &staged, sizeof(T));
+                        return out + sizeof(T);
+                    }
+                    else
+                        return encodeText(out, staged);
+                }
+                static char const *decode(char const *in, std::string &line)
+                {
+                    line += "Calling generic printer:\n\btype:";
+                    line += typeid(T).name();
+                    line += "\n\bvalue:";
+                    if constexpr (isRaw)
+                    {
+                        alignas(T) unsigned char storage[sizeof(T)];
+                        std::memcpy(storage, in, sizeof(T));
+                        std::ostringstream os;
+                        os << *std::launder(reinterpret_cast<T const *>(storage));
+                        line += std::move(os).str();
+                        in += sizeof(T);
+                    }
+                    else
+                        in = decodeText(in, line);
+                    line += '\n';
+                    return in;
+                }
+            };
+
+            // NOTE 11.3 A record is a header followed by the encoded arguments , padded to the header alignment
+            struct alignas(16) RecordHeader
+            {
+                void (*decode)(char const *payload, std::string &line); // nullptr: padding up to the end of the ring
+                std::uint32_t size;                                     // of the whole record
+            };
+            constexpr std::size_t recordAlignment = alignof(RecordHeader);
+
+            template <typename... Tags>
+            void decodeRecord(char const *payload, std::string &line)
+            {
+                ((payload = Codec<Tags>::decode(payload, line)), ...);
+            }
+
+            /**
+             * NOTE 11.4 Single producer / single consumer ring of records
+             * Positions only grow , their difference is the used size. A record never wraps: when it does not fit
+             * before the end , the rest is skipped with a padding record , which is why records are limited to
+             * half of the capacity.
+             */
+            class Ring
+            {
+            public:
+                explicit Ring(std::size_t capacity)
+                    : capacity_(roundUp(capacity)), mask_(capacity_ - 1), blocks_(std::make_unique<Block[]>(capacity_ / sizeof(Block)))
+                {
+                }
+
+                std::size_t maxRecordSize() const noexcept
+                {
+                    return capacity_ / 2;
+                }
+
+                // Producer: room for size bytes , or nullptr when the ring is full; commit() publishes them
+                char *reserve(std::size_t size) noexcept
+                {
+                    auto head = head_.load(std::memory_order_relaxed);
+                    auto contiguous = capacity_ - (head & mask_);
+                    auto needed = size <= contiguous ? size : contiguous + size;
+                    if (head + needed - tailCache_ > capacity_)
+                    {
+                        tailCache_ = tail_.load(std::memory_order_acquire);
+                        if (head + needed - tailCache_ > capacity_)
+                            return nullptr;
+                    }
+                    if (size > contiguous)
+                    {
+                        *reinterpret_cast<RecordHeader *>(at(head)) = {nullptr, static_cast<std::uint32_t>(contiguous)};
+                        head += contiguous;
+                    }
+                    reserved_ = needed;
+                    return at(head);
+                }
+                void commit() noexcept
+                {
+                    head_.store(head_.load(std::memory_order_relaxed) + reserved_, std::memory_order_release);
+                }
+
+                // Consumer: decode every published record into line , true when there was any
+                bool drain(std::string &line)
+                {
+                    auto tail = tail_.load(std::memory_order_relaxed);
+                    auto head = head_.load(std::memory_order_acquire);
+                    if (tail == head)
+                        return false;
+                    while (tail != head)
+                    {
+                        auto header = reinterpret_cast<RecordHeader const *>(at(tail));
+                        if (header->decode)
+                            header->decode(reinterpret_cast<char const *>(header + 1), line);
+                        tail += header->size;
+                    }
+                    tail_.store(tail, std::memory_order_release);
+                    return true;
+                }
+
+                std::atomic<std::uint64_t> dropped{0}; // records refused under Overflow::count , not yet reported
+                std::atomic<bool> closed{false};       // the producing thread has exited
+
+            private:
+                struct alignas(recordAlignment) Block
+                {
+                    char bytes[recordAlignment];
+                };
+
+                static std::size_t roundUp(std::size_t capacity)
+                {
+                    std::size_t result = 4 * recordAlignment;
+                    while (result < capacity)
+                        result *= 2;
+                    return result;
+                }
+                char *at(std::size_t position) const noexcept
+                {
+                    return reinterpret_cast<char *>(blocks_.get()) + (position & mask_);
+                }
+
+                std::size_t const capacity_, mask_;
+                std::unique_ptr<Block[]> blocks_;
+                alignas(64) std::atomic<std::size_t> head_{0};
+                std::size_t tailCache_ = 0, reserved_ = 0; // producer only
+                alignas(64) std::atomic<std::size_t> tail_{0};
+            };
+
+            // What a thread does when its ring is full
+            enum class Overflow
+            {
+                block, // wait for the background thread
+                drop,  // discard the record
+                count, // discard the record , the background thread logs how many were discarded
+            };
+
+            /**
+             * NOTE 11.5 The logger: one ring per (logger , thread) and one background thread
+             * A thread's ring is created on its first record and dropped by the background thread once the
+             * thread has exited and the ring is drained.
+             */
+            class AsyncLogger
+            {
+            public:
+                struct Options
+                {
+                    std::size_t ringCapacity = 1 << 16; // bytes per thread
+                    Overflow overflow = Overflow::block;
+                    std::chrono::milliseconds flushInterval{1}; // how long the background thread sleeps when idle
+                };
+
+                explicit AsyncLogger(std::string const &path) : AsyncLogger(path, Options{})
+                {
+                }
+                AsyncLogger(std::string const &path, Options options)
+                    : options_(options), id_(nextId().fetch_add(1, std::memory_order_relaxed)), file_(std::fopen(path.c_str(), "wb"))
+                {
+                    if (!file_)
+                        throw std::runtime_error("AsyncLogger: cannot open " + path);
+                    worker_ = std::thread([this] { work(); });
+                }
+                AsyncLogger(AsyncLogger const &) = delete;
+                AsyncLogger &operator=(AsyncLogger const &) = delete;
+                // Everything logged before is written
+                ~AsyncLogger()
+                {
+                    {
+                        std::lock_guard lock(mutex_);
+                        stopping_ = true;
+                    }
+                    wake_.notify_all();
+                    worker_.join();
+                    std::fclose(file_);
+                }
+
+                // False when the record was discarded , see Overflow and Ring::maxRecordSize
+                template <typename... Ts>
+                bool detailedPrint(Ts const &...args)
+                {
+                    TCG_SCOPED_TIMER("chapter4.asynchronous.AsyncLogger.detailedPrint");
+                    return write<Selected<Ts>...>(Codec<Selected<Ts>>::stage(args)...);
+                }
+
+                // Wait until everything this thread logged before is in the file
+                void flush()
+                {
+                    std::unique_lock lock(mutex_);
+                    auto ticket = ++flushRequested_;
+                    wake_.notify_all();
+                    flushed_.wait(lock, [&] { return flushDone_ >= ticket; });
+                }
+
+                // Records discarded under Overflow::count and already reported in the file
+                std::uint64_t dropped() const noexcept
+                {
+                    return dropped_.load(std::memory_order_relaxed);
+                }
+
+            private:
+                template <typename... Tags, typename... Staged>
+                bool write(Staged const &...staged)
+                {
+                    auto payload = (std::size_t{0} + ... + Codec<Tags>::size(staged));
+                    auto size = (sizeof(RecordHeader) + payload + recordAlignment - 1) / recordAlignment * recordAlignment;
+                    auto &ring = threadRing();
+                    if (size > ring.maxRecordSize())
+                        return refuse(ring);
+                    auto out = ring.reserve(size);
+                    while (!out)
+                    {
+                        if (options_.overflow != Overflow::block)
+                            return refuse(ring);
+                        wake_.notify_one();
+                        std::this_thread::yield();
+                        out = ring.reserve(size);
+                    }
+                    *reinterpret_cast<RecordHeader *>(out) = {&decodeRecord<Tags...>, static_cast<std::uint32_t>(size)};
+                    out += sizeof(RecordHeader);
+                    ((out = Codec<Tags>::encode(out, staged)), ...);
+                    ring.commit();
+                    return true;
+                }
+                bool refuse(Ring &ring)
+                {
+                    if (options_.overflow == Overflow::count)
+                        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                static std::atomic<std::uint64_t> &nextId()
+                {
+                    static std::atomic<std::uint64_t> id{0};
+                    return id;
+                }
+
+                // The rings of this thread , one per logger it logged to; they are closed when it exits
+                struct ThreadRings
+                {
+                    std::vector<std::pair<std::uint64_t, std::shared_ptr<Ring>>> rings;
+                    ~ThreadRings()
+                    {
+                        for (auto &[id, ring] : rings)
+                            ring->closed.store(true, std::memory_order_release);
+                    }
+                };
+                Ring &threadRing()
+                {
+                    thread_local ThreadRings mine;
+                    thread_local std::uint64_t lastId = ~std::uint64_t(0);
+                    thread_local Ring *last = nullptr;
+                    if (lastId == id_)
+                        return *last;
+                    auto found = std::find_if(mine.rings.begin(), mine.rings.end(), [&](auto const &each) { return each.first == id_; });
+                    if (found == mine.rings.end())
+                    {
+                        auto ring = std::make_shared<Ring>(options_.ringCapacity);
+                        {
+                            std::lock_guard lock(mutex_);
+                            rings_.push_back(ring);
+                        }
+                        found = mine.rings.emplace(mine.rings.end(), id_, std::move(ring));
+                    }
+                    lastId = id_;
+                    last = found->second.get();
+                    return *last;
+                }
+
+                // The background thread: drain every ring , write what was decoded , sleep when there was nothing
+                void work()
+                {
+                    std::string lines;
+                    std::vector<std::shared_ptr<Ring>> rings;
+                    for (;;)
+                    {
+                        std::uint64_t ticket;
+                        bool stopping;
+                        {
+                            std::lock_guard lock(mutex_);
+                            rings = rings_;
+                            ticket = flushRequested_;
+                            stopping = stopping_;
+                        }
+                        bool any = false;
+                        for (auto &ring : rings)
+                        {
+                            // Read before draining: a closed ring is empty afterwards
+                            auto closed = ring->closed.load(std::memory_order_acquire);
+                            any |= ring->drain(lines);
+                            if (auto count = ring->dropped.exchange(0, std::memory_order_relaxed))
+                            {
+                                dropped_.fetch_add(count, std::memory_order_relaxed);
+                                lines += "AsyncLogger dropped ";
+                                appendFormatted(lines, count);
+                                lines += " records\n";
+                                any = true;
+                            }
+                            if (closed)
+                                removeRing(ring);
+                            if (lines.size() >= batchSize)
+                                writeOut(lines);
+                        }
+                        if (!lines.empty())
+                        {
+                            writeOut(lines);
+                            std::fflush(file_);
+                        }
+                        std::unique_lock lock(mutex_);
+                        if (ticket > flushDone_)
+                        {
+                            flushDone_ = ticket;
+                            flushed_.notify_all();
+                        }
+                        if (stopping)
+                            return;
+                        if (!any)
+                            wake_.wait_for(lock, options_.flushInterval, [&] { return stopping_ || flushRequested_ > flushDone_; });
+                    }
+                }
+                void writeOut(std::string &lines)
+                {
+                    std::fwrite(lines.data(), 1, lines.size(), file_);
+                    lines.clear();
+                }
+                void removeRing(std::shared_ptr<Ring> const &ring)
+                {
+                    std::lock_guard lock(mutex_);
+                    rings_.erase(std::find(rings_.begin(), rings_.end(), ring));
+                }
+
+                static constexpr std::size_t batchSize = 1 << 16;
+
+                Options const options_;
+                std::uint64_t const id_;
+                std::FILE *file_;
+                std::mutex mutex_;
+                std::condition_variable wake_, flushed_;
+                std::vector<std::shared_ptr<Ring>> rings_;
+                std::uint64_t flushRequested_ = 0, flushDone_ = 0;
+                bool stopping_ = false;
+                std::atomic<std::uint64_t> dropped_{0};
+                std::thread worker_;
+            };
+
+        } // namespace asynchronous
+
+    } // namespace chapter4
+
+} // namespace TemplateCompleteGuide
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef BATCHED_TRAVERSE_H
+#define BATCHED_TRAVERSE_H
+
+#pragma once
+
+#include "platform.h"
+#include "template_complete_guide.h"
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter4
+    {
+        namespace application
+        {
+            /**
+             * e.g. 6. Batched traverse: resolve the same path for many roots
+             * Calling traverse(root, paths...) in a loop serializes the cache misses: every step needs the node
+             * loaded by the previous one. Here a group of roots advances one level at a time , and the child
+             * reached by each root is prefetched as soon as it is known , so the misses of a whole group are in
+             * flight together and the next level mostly hits the cache.
+             * A null child ends the path of its root , nullptr is written for it instead of crashing.
+             */
+            constexpr std::size_t traverseGroupSize = 64; // roots in flight , small enough to stay in L1
+
+            template <typename Iterator, typename OutputIterator, typename... TP>
+            OutputIterator traverseBatch(Iterator first, Iterator last, OutputIterator out, TP... paths)
+            {
+                Node *group[traverseGroupSize];
+                while (first != last)
+                {
+                    std::size_t count = 0;
+                    for (; first != last && count < traverseGroupSize; ++first)
+                    {
+                        group[count] = *first;
+                        platform::prefetch(group[count++]); // prefetching a null pointer is harmless
+                    }
+                    auto step = [&](auto path)
+                    {
+                        for (std::size_t i = 0; i < count; ++i)
+                        {
+                            if (auto node = group[i])
+                            {
+                                group[i] = node->*path;
+                                platform::prefetch(group[i]);
+                            }
+                        }
+                    };
+                    (step(paths), ...);
+                    out = std::copy(group, group + count, out);
+                }
+                return out;
+            }
+
+        } // namespace application
+
+    } // namespace chapter4
+
+} // namespace TemplateCompleteGuide
+
+#endif
@@ -0,0 +1,79 @@
+#include "benchmark.h"
+#include "../template_complete_guide.h"
+#include "../async_log.h"
+#include <filesystem>
+#include <fstream>
+
+/**
+ * Latency seen by the caller of detailedPrint: written synchronously to a file through std::cout , against
+ * asynchronous::AsyncLogger. Every call is timed on its own , p50 / p99 / p999 of a sample are reported as
+ * counters (averaged over the samples) next to the usual per-iteration figures.
+ * NOTICE the clock is read around every call in both cases , its cost is part of the figures
+ */
+namespace
+{
+    using namespace TemplateCompleteGuide::chapter4;
+    using TemplateCompleteGuide::benchmark::Clock;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+
+    constexpr std::size_t maxTimedCalls = 1 << 20;
+
+    std::string logPath(char const *name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    template <typename Call>
+    void callLatency(TemplateCompleteGuide::benchmark::State &state, Call call)
+    {
+        std::vector<std::uint32_t> latencies;
+        latencies.reserve(std::min<std::uint64_t>(state.iterations(), maxTimedCalls));
+        int number = 42;
+        double real = 3.25;
+        std::string text = "World";
+        for (auto _ : state)
+        {
+            doNotOptimize(number);
+            auto start = Clock::now();
+            call(number, real, text);
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            if (latencies.size() < maxTimedCalls)
+                latencies.push_back(static_cast<std::uint32_t>(ns));
+        }
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p)
+        {
+            auto rank = static_cast<std::size_t>(std::ceil(p * latencies.size()));
+            return static_cast<double>(latencies[std::max<std::size_t>(rank, 1) - 1]);
+        };
+        state.setCounter("p50_ns", percentile(0.5));
+        state.setCounter("p99_ns", percentile(0.99));
+        state.setCounter("p999_ns", percentile(0.999));
+    }
+} // namespace
+
+TCG_BENCHMARK(DetailedPrint_SyncFile)
+{
+    auto path = logPath("tcg_bench_sync.log");
+    {
+        std::ofstream file(path);
+        auto previous = std::cout.rdbuf(file.rdbuf());
+        callLatency(state, [](int number, double real, std::string const &text)
+                    { overload::preferred::detailedPrint(number, real, text, 'c'); });
+        std::cout.rdbuf(previous);
+    }
+    std::filesystem::remove(path);
+}
+
+TCG_BENCHMARK(DetailedPrint_AsyncLogger)
+{
+    auto path = logPath("tcg_bench_async.log");
+    {
+        asynchronous::AsyncLogger::Options options;
+        options.ringCapacity = 1 << 20;
+        asynchronous::AsyncLogger log(path, options);
+        callLatency(state, [&](int number, double real, std::string const &text)
+                    { log.detailedPrint(number, real, text, 'c'); });
+    }
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,85 @@
+#include "benchmark.h"
+#include "../columns.h"
+
+// Columns against an array of tuples: scans of one field and filters over two , argument: number of rows
+namespace
+{
+    using namespace TemplateCompleteGuide::chapter4::variadicClassTemplates;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+
+    // age , score , balance , region
+    using Rows = std::vector<std::tuple<int, double, std::int64_t, float>>;
+    using Table = Columns<int, double, std::int64_t, float>;
+
+    template <typename Append>
+    void fill(std::size_t rows, Append append)
+    {
+        for (std::size_t i = 0; i < rows; ++i)
+            append(static_cast<int>(i % 90), static_cast<double>(i % 1000) * 0.5, static_cast<std::int64_t>(i * 7), static_cast<float>(i % 16));
+    }
+    Rows makeRows(std::size_t count)
+    {
+        Rows rows;
+        rows.reserve(count);
+        fill(count, [&](auto... fields) { rows.emplace_back(fields...); });
+        return rows;
+    }
+    Table makeTable(std::size_t count)
+    {
+        Table table;
+        table.reserve(count);
+        fill(count, [&](auto... fields) { table.append(fields...); });
+        return table;
+    }
+} // namespace
+
+TCG_BENCHMARK_ARGS(ColumnScan_Tuples, 1 << 20, 10000000)
+{
+    auto rows = makeRows(static_cast<std::size_t>(state.arg()));
+    state.setItemsPerIteration(static_cast<double>(rows.size()));
+    for (auto _ : state)
+    {
+        std::int64_t sum = 0;
+        for (auto const &row : rows)
+            sum += std::get<0>(row);
+        doNotOptimize(sum);
+    }
+}
+
+TCG_BENCHMARK_ARGS(ColumnScan_Columns, 1 << 20, 10000000)
+{
+    auto table = makeTable(static_cast<std::size_t>(state.arg()));
+    state.setItemsPerIteration(static_cast<double>(table.size()));
+    for (auto _ : state)
+    {
+        std::int64_t sum = 0;
+        table.forEach<0>([&](int age) { sum += age; });
+        doNotOptimize(sum);
+    }
+}
+
+// SELECT SUM(balance) WHERE age >= 18 AND score > 250
+TCG_BENCHMARK_ARGS(ColumnFilter_Tuples, 1 << 20, 10000000)
+{
+    auto rows = makeRows(static_cast<std::size_t>(state.arg()));
+    state.setItemsPerIteration(static_cast<double>(rows.size()));
+    for (auto _ : state)
+    {
+        std::int64_t sum = 0;
+        for (auto const &[age, score, balance, region] : rows)
+            sum += (age >= 18 && score > 250) ? balance : 0;
+        doNotOptimize(sum);
+    }
+}
+
+TCG_BENCHMARK_ARGS(ColumnFilter_Columns, 1 << 20, 10000000)
+{
+    auto table = makeTable(static_cast<std::size_t>(state.arg()));
+    state.setItemsPerIteration(static_cast<double>(table.size()));
+    for (auto _ : state)
+    {
+        std::int64_t sum = 0;
+        table.forEach<0, 1, 2>([&](int age, double score, std::int64_t balance) { sum += (age >= 18 && score > 250) ? balance : 0; });
+        doNotOptimize(sum);
+    }
+}
@@ -0,0 +1,91 @@
+#include "benchmark.h"
+#include "../concurrent_stack.h"
+#include <mutex>
+#include <thread>
+
+/**
+ * Push / pop throughput of chapter2::ConcurrentStack against a std::vector guarded by a std::mutex ,
+ * argument: number of threads , run as given even past the hardware threads (the "hardware" counter). Every
+ * thread pushes burst values and pops them back , rounds times per iteration; the threads are started and
+ * joined inside the iteration.
+ */
+namespace
+{
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+
+    constexpr int burst = 32;
+    constexpr int rounds = 512;
+
+    template <typename Push, typename Pop>
+    void pushPop(TemplateCompleteGuide::benchmark::State &state, Push push, Pop pop)
+    {
+        auto threads = static_cast<unsigned>(state.arg());
+        state.setCounter("threads", threads);
+        state.setCounter("hardware", std::thread::hardware_concurrency());
+        state.setItemsPerIteration(static_cast<double>(threads * rounds * burst * 2));
+        auto work = [&]
+        {
+            long long sum = 0;
+            for (int round = 0; round < rounds; ++round)
+            {
+                for (int i = 0; i < burst; ++i)
+                    push(i);
+                for (int i = 0; i < burst; ++i)
+                    sum += pop();
+            }
+            doNotOptimize(sum);
+        };
+        for (auto _ : state)
+        {
+            std::vector<std::thread> workers;
+            for (unsigned t = 1; t < threads; ++t)
+                workers.emplace_back(work);
+            work();
+            for (auto &worker : workers)
+                worker.join();
+        }
+    }
+
+    // Another thread may have taken the values this one pushed , but never more than all threads pushed
+    template <typename TryPop>
+    int popSome(TryPop tryPop)
+    {
+        for (;;)
+            if (auto value = tryPop())
+                return *value;
+    }
+} // namespace
+
+#define TCG_THREAD_COUNTS 1, 2, 4, 8, 16, 32, 64
+
+TCG_BENCHMARK_ARGS(StackPushPop_MutexVector, TCG_THREAD_COUNTS)
+{
+    std::mutex mutex;
+    std::vector<int> values;
+    pushPop(
+        state,
+        [&](int value)
+        {
+            std::lock_guard lock(mutex);
+            values.push_back(value);
+        },
+        [&]
+        {
+            return popSome([&]() -> std::optional<int>
+                           {
+                               std::lock_guard lock(mutex);
+                               if (values.empty())
+                                   return std::nullopt;
+                               auto value = values.back();
+                               values.pop_back();
+                               return value;
+                           });
+        });
+}
+
+TCG_BENCHMARK_ARGS(StackPushPop_Concurrent, TCG_THREAD_COUNTS)
+{
+    TemplateCompleteGuide::chapter2::ConcurrentStack<int> values;
+    pushPop(
+        state, [&](int value) { values.push(value); }, [&] { return popSome([&] { return values.try_pop(); }); });
+}
@@ -0,0 +1,168 @@
+#include "benchmark.h"
+#include "../template_complete_guide.h"
+#include "../static_dispatch.h"
+#include <random>
+
+/**
+ * isArray and DispatchHelper against the RTTI based versions they replaced and a plain virtual call ,
+ * argument of the zoo cases: number of objects , 4096 (cache resident) and 10M (memory bound).
+ */
+namespace
+{
+    using namespace TemplateCompleteGuide::constexprValidation;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+    using TemplateCompleteGuide::chapter4::variadicBaseClassAndUsing::Overloader;
+
+    // The former isArray: search the mangled type name
+    template <typename T>
+    bool isArrayByName()
+    {
+        return std::string::npos != std::string(typeid(T).name()).find("ArrayList");
+    }
+
+    // The former DispatchHelper
+    template <typename Q>
+    void dispatchByCast(Animal *animal)
+    {
+        if (auto derived = dynamic_cast<Q *>(animal))
+            derived->speak();
+    }
+
+    // Dogs , cats and plain animals in random order
+    struct Zoo
+    {
+        std::vector<std::unique_ptr<Animal>> storage;
+        std::vector<Animal *> animals;
+
+        explicit Zoo(std::size_t size)
+        {
+            std::mt19937 random(7);
+            storage.reserve(size);
+            animals.reserve(size);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                switch (random() % 3)
+                {
+                case 0:
+                    storage.push_back(std::make_unique<Dog>());
+                    break;
+                case 1:
+                    storage.push_back(std::make_unique<Cat>());
+                    break;
+                default:
+                    storage.push_back(std::make_unique<Animal>());
+                    break;
+                }
+                animals.push_back(storage.back().get());
+            }
+        }
+    };
+
+    // Built once per size , a 10M zoo takes longer to build than to visit
+    Zoo const &zoo(TemplateCompleteGuide::benchmark::State const &state)
+    {
+        static std::map<std::int64_t, Zoo> zoos;
+        auto found = zoos.find(state.arg());
+        if (found == zoos.end())
+            found = zoos.try_emplace(state.arg(), static_cast<std::size_t>(state.arg())).first;
+        return found->second;
+    }
+} // namespace
+
+TCG_BENCHMARK(IsArray_TypeidName)
+{
+    for (auto _ : state)
+    {
+        auto result = isArrayByName<MoreFoolArrayList>() + isArrayByName<Animal>();
+        doNotOptimize(result);
+    }
+}
+
+TCG_BENCHMARK(IsArray_Tag)
+{
+    for (auto _ : state)
+    {
+        auto result = isArray<MoreFoolArrayList>() + isArray<Animal>();
+        doNotOptimize(result);
+    }
+}
+
+#define TCG_ZOO_SIZES 4096, 10000000
+
+// DispatchHelper<Dog> over the zoo , speak() writes to the null std::cout
+TCG_BENCHMARK_ARGS(DispatchHelper_DynamicCast, TCG_ZOO_SIZES)
+{
+    auto const &animals = zoo(state).animals;
+    state.setItemsPerIteration(static_cast<double>(animals.size()));
+    for (auto _ : state)
+        for (auto animal : animals)
+            dispatchByCast<Dog>(animal);
+}
+
+TCG_BENCHMARK_ARGS(DispatchHelper_Kind, TCG_ZOO_SIZES)
+{
+    auto const &animals = zoo(state).animals;
+    DispatchHelper<Dog> helper;
+    state.setItemsPerIteration(static_cast<double>(animals.size()));
+    for (auto _ : state)
+        for (auto animal : animals)
+            helper(animal);
+}
+
+// The baseline without any type test: every animal speaks , cats to the null std::cout too
+TCG_BENCHMARK_ARGS(DispatchHelper_Virtual, TCG_ZOO_SIZES)
+{
+    auto const &animals = zoo(state).animals;
+    state.setItemsPerIteration(static_cast<double>(animals.size()));
+    for (auto _ : state)
+        for (auto animal : animals)
+            animal->speak();
+}
+
+// Type switch with a visitor that only counts , so the dispatch itself is measured
+TCG_BENCHMARK_ARGS(TypeSwitch_DynamicCastChain, TCG_ZOO_SIZES)
+{
+    auto const &animals = zoo(state).animals;
+    std::size_t counts[3] = {};
+    state.setItemsPerIteration(static_cast<double>(animals.size()));
+    for (auto _ : state)
+    {
+        for (auto animal : animals)
+        {
+            if (dynamic_cast<Dog *>(animal))
+                ++counts[0];
+            else if (dynamic_cast<Cat *>(animal))
+                ++counts[1];
+            else
+                ++counts[2];
+        }
+        doNotOptimize(counts);
+    }
+}
+
+TCG_BENCHMARK_ARGS(TypeSwitch_Dispatch, TCG_ZOO_SIZES)
+{
+    auto const &animals = zoo(state).animals;
+    std::size_t counts[3] = {};
+    auto counter = Overloader{[&](Dog &) { ++counts[0]; }, [&](Cat &) { ++counts[1]; }, [&](Animal &) { ++counts[2]; }};
+    state.setItemsPerIteration(static_cast<double>(animals.size()));
+    for (auto _ : state)
+    {
+        for (auto animal : animals)
+            staticDispatch::dispatch(animal, counter);
+        doNotOptimize(counts);
+    }
+}
+
+TCG_BENCHMARK_ARGS(TypeSwitch_DispatchBatch, TCG_ZOO_SIZES)
+{
+    auto const &animals = zoo(state).animals;
+    std::size_t counts[3] = {};
+    auto counter = Overloader{[&](Dog &) { ++counts[0]; }, [&](Cat &) { ++counts[1]; }, [&](Animal &) { ++counts[2]; }};
+    state.setItemsPerIteration(static_cast<double>(animals.size()));
+    for (auto _ : state)
+    {
+        staticDispatch::dispatchBatch(animals.begin(), animals.end(), counter);
+        doNotOptimize(counts);
+    }
+}
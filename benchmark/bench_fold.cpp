@@ -0,0 +1,173 @@
+#include "benchmark.h"
+#include "../template_complete_guide.h"
+#include "../simd_reduce.h"
+
+/**
+ * Fold expressions over packs , and their runtime counterparts over ranges at every SIMD level. Argument of the
+ * range cases: number of elements , 4K (L1 resident) , 256K , 8M and 64M (far past the last level cache) ,
+ * reported in bytes read per second.
+ */
+namespace
+{
+    using namespace TemplateCompleteGuide::chapter4::variadicExpression;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+    using TemplateCompleteGuide::benchmark::State;
+    using TemplateCompleteGuide::platform::SimdLevel;
+
+    constexpr std::size_t listSize = 4096;
+
+    // Kept across the runs of a benchmark , filling 64M elements takes longer than reducing them
+    template <typename T, typename Fill>
+    std::vector<T> const &rangeOf(std::size_t size, Fill fill)
+    {
+        static std::vector<T> values;
+        if (values.size() != size)
+        {
+            values.assign(size, T());
+            for (std::size_t i = 0; i < size; ++i)
+                values[i] = fill(i);
+        }
+        return values;
+    }
+    template <typename T>
+    std::vector<T> const &rangeOf(std::size_t size)
+    {
+        return rangeOf<T>(size, [](std::size_t i) { return static_cast<T>(1 + i % 7); });
+    }
+
+    template <typename Op, typename T>
+    void reduceRange(State &state, std::vector<T> const &values, SimdLevel level)
+    {
+        state.setItemsPerIteration(static_cast<double>(values.size()));
+        state.setBytesPerIteration(static_cast<double>(values.size() * sizeof(T)));
+        for (auto _ : state)
+        {
+            doNotOptimize(values.data());
+            auto result = simd::reduce<Op>(values.data(), values.size(), level);
+            doNotOptimize(result);
+        }
+    }
+    template <typename T>
+    void sumRange(State &state, SimdLevel level)
+    {
+        reduceRange<simd::Plus>(state, rangeOf<T>(static_cast<std::size_t>(state.arg())), level);
+    }
+    void productRange(State &state, SimdLevel level)
+    {
+        reduceRange<simd::Multiplies>(state, rangeOf<double>(static_cast<std::size_t>(state.arg()), [](std::size_t) { return 1.0001; }), level);
+    }
+} // namespace
+
+TCG_BENCHMARK(Fold_SumPack)
+{
+    int a = 1, b = 2, c = 3, d = 4, e = 5, f = 6, g = 7, h = 8;
+    for (auto _ : state)
+    {
+        doNotOptimize(a);
+        auto sum = foldSum(a, b, c, d, e, f, g, h);
+        doNotOptimize(sum);
+    }
+}
+
+TCG_BENCHMARK(Fold_CalcSumPack)
+{
+    double a = 1, b = 2, c = 3, d = 4;
+    for (auto _ : state)
+    {
+        doNotOptimize(a);
+        auto sum = calcSum<10>(a, b, c, d);
+        doNotOptimize(sum);
+    }
+}
+
+TCG_BENCHMARK(Fold_MultiplePack)
+{
+    long a = 1, b = 2, c = 3, d = 4, e = 5;
+    for (auto _ : state)
+    {
+        doNotOptimize(a);
+        auto product = foldMutiple<0>(a, b, c, d, e);
+        doNotOptimize(product);
+    }
+}
+
+#define TCG_RANGE_SIZES 4096, 262144, 8388608, 67108864
+
+// Baseline of the range folds: the left fold as a plain loop
+TCG_BENCHMARK_ARGS(FoldRange_IntAccumulate, TCG_RANGE_SIZES)
+{
+    auto const &values = rangeOf<int>(static_cast<std::size_t>(state.arg()));
+    state.setItemsPerIteration(static_cast<double>(values.size()));
+    state.setBytesPerIteration(static_cast<double>(values.size() * sizeof(int)));
+    for (auto _ : state)
+    {
+        doNotOptimize(values.data());
+        auto sum = std::accumulate(values.begin(), values.end(), 0);
+        doNotOptimize(sum);
+    }
+}
+
+// One case per SimdLevel , lowered to what the CPU supports
+TCG_BENCHMARK_ARGS(FoldRange_IntSum_Scalar, TCG_RANGE_SIZES)
+{
+    sumRange<int>(state, SimdLevel::Scalar);
+}
+TCG_BENCHMARK_ARGS(FoldRange_IntSum_SSE2, TCG_RANGE_SIZES)
+{
+    sumRange<int>(state, SimdLevel::SSE2);
+}
+TCG_BENCHMARK_ARGS(FoldRange_IntSum_AVX2, TCG_RANGE_SIZES)
+{
+    sumRange<int>(state, SimdLevel::AVX2);
+}
+TCG_BENCHMARK_ARGS(FoldRange_IntSum_AVX512, TCG_RANGE_SIZES)
+{
+    sumRange<int>(state, SimdLevel::AVX512);
+}
+
+TCG_BENCHMARK_ARGS(FoldRange_FloatSum_Scalar, TCG_RANGE_SIZES)
+{
+    sumRange<float>(state, SimdLevel::Scalar);
+}
+TCG_BENCHMARK_ARGS(FoldRange_FloatSum_SSE2, TCG_RANGE_SIZES)
+{
+    sumRange<float>(state, SimdLevel::SSE2);
+}
+TCG_BENCHMARK_ARGS(FoldRange_FloatSum_AVX2, TCG_RANGE_SIZES)
+{
+    sumRange<float>(state, SimdLevel::AVX2);
+}
+TCG_BENCHMARK_ARGS(FoldRange_FloatSum_AVX512, TCG_RANGE_SIZES)
+{
+    sumRange<float>(state, SimdLevel::AVX512);
+}
+
+TCG_BENCHMARK_ARGS(FoldRange_DoubleProduct_Scalar, TCG_RANGE_SIZES)
+{
+    productRange(state, SimdLevel::Scalar);
+}
+TCG_BENCHMARK_ARGS(FoldRange_DoubleProduct_SSE2, TCG_RANGE_SIZES)
+{
+    productRange(state, SimdLevel::SSE2);
+}
+TCG_BENCHMARK_ARGS(FoldRange_DoubleProduct_AVX2, TCG_RANGE_SIZES)
+{
+    productRange(state, SimdLevel::AVX2);
+}
+TCG_BENCHMARK_ARGS(FoldRange_DoubleProduct_AVX512, TCG_RANGE_SIZES)
+{
+    productRange(state, SimdLevel::AVX512);
+}
+
+// Non contiguous ranges fall back to the plain loop
+TCG_BENCHMARK(FoldRange_ListSum)
+{
+    auto const &source = rangeOf<int>(listSize);
+    std::list<int> values(source.begin(), source.end());
+    state.setItemsPerIteration(listSize);
+    for (auto _ : state)
+    {
+        auto sum = foldSumRange(values);
+        doNotOptimize(sum);
+    }
+}
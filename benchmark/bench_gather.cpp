@@ -0,0 +1,124 @@
+#include "benchmark.h"
+#include "../gather.h"
+#include <random>
+
+// gather by sequential , strided and random index lists , argument: SimdLevel (0 scalar ... 3 AVX-512)
+namespace
+{
+    using namespace TemplateCompleteGuide::chapter4::variadicIndices;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+    using TemplateCompleteGuide::platform::SimdLevel;
+
+    constexpr std::size_t sourceSize = 1 << 22; // 32 MiB of doubles , larger than the last level cache
+    constexpr std::size_t indexCount = 1 << 16;
+
+    enum class Pattern
+    {
+        Sequential,
+        Strided,
+        Random
+    };
+
+    std::vector<int> indicesOf(Pattern pattern)
+    {
+        std::vector<int> indices(indexCount);
+        std::mt19937 random(5);
+        for (std::size_t i = 0; i < indexCount; ++i)
+        {
+            switch (pattern)
+            {
+            case Pattern::Sequential:
+                indices[i] = static_cast<int>(i);
+                break;
+            case Pattern::Strided:
+                indices[i] = static_cast<int>(i * 16 % sourceSize); // one element per two cache lines
+                break;
+            case Pattern::Random:
+                indices[i] = static_cast<int>(random() % sourceSize);
+                break;
+            }
+        }
+        return indices;
+    }
+
+    std::vector<double> const &source()
+    {
+        static std::vector<double> values = []
+        {
+            std::vector<double> result(sourceSize);
+            for (std::size_t i = 0; i < sourceSize; ++i)
+                result[i] = static_cast<double>(i);
+            return result;
+        }();
+        return values;
+    }
+
+    void gatherPattern(TemplateCompleteGuide::benchmark::State &state, Pattern pattern)
+    {
+        auto const &values = source();
+        auto indices = indicesOf(pattern);
+        std::vector<double> out(indexCount);
+        auto level = static_cast<SimdLevel>(state.arg());
+        state.setItemsPerIteration(indexCount);
+        for (auto _ : state)
+        {
+            gather(values.data(), values.size(), indices.data(), indices.size(), out.data(), level);
+            doNotOptimize(out.data());
+        }
+    }
+} // namespace
+
+TCG_BENCHMARK_ARGS(Gather_Sequential, 0, 2, 3)
+{
+    gatherPattern(state, Pattern::Sequential);
+}
+
+TCG_BENCHMARK_ARGS(Gather_Strided, 0, 2, 3)
+{
+    gatherPattern(state, Pattern::Strided);
+}
+
+TCG_BENCHMARK_ARGS(Gather_Random, 0, 2, 3)
+{
+    gatherPattern(state, Pattern::Random);
+}
+
+// Baseline of the random pattern: the loop printElements would write , without prefetching
+TCG_BENCHMARK(Gather_RandomPlainLoop)
+{
+    auto const &values = source();
+    auto indices = indicesOf(Pattern::Random);
+    std::vector<double> out(indexCount);
+    state.setItemsPerIteration(indexCount);
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < indexCount; ++i)
+            out[i] = values[indices[i]];
+        doNotOptimize(out.data());
+    }
+}
+
+TCG_BENCHMARK_ARGS(Scatter_Random, 0, 3)
+{
+    std::vector<double> dest(sourceSize);
+    auto indices = indicesOf(Pattern::Random);
+    std::vector<double> values(indexCount, 1.0);
+    auto level = static_cast<SimdLevel>(state.arg());
+    state.setItemsPerIteration(indexCount);
+    for (auto _ : state)
+    {
+        scatter(values.data(), indices.data(), indices.size(), dest.data(), dest.size(), level);
+        doNotOptimize(dest.data());
+    }
+}
+
+TCG_BENCHMARK(Gather_FixedIndices)
+{
+    std::array<double, 64> values{};
+    for (auto _ : state)
+    {
+        doNotOptimize(values);
+        auto picked = gatherIndex<1, 9, 17, 33, 63>(values);
+        doNotOptimize(picked);
+    }
+}
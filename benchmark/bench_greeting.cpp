@@ -0,0 +1,61 @@
+#include "benchmark.h"
+#include "../template_complete_guide.h"
+#include <fstream>
+
+/**
+ * chapter3::greeting<Msg, times> , all the lines from one static buffer in a single write , against the former
+ * loop flushing std::endl on every line. Both write to the null device through std::cout , argument: times.
+ * The binary-size side of the comparison is in compile_time.cpp (greeting cases).
+ */
+namespace
+{
+    using namespace TemplateCompleteGuide::chapter3;
+
+    constexpr char msg[] = "World";
+
+    namespace loop
+    {
+        template <auto Msg, int times>
+        void greeting()
+        {
+            for (auto i = 0; i < times; i++)
+                std::cout << " Hello " << Msg << std::endl;
+        }
+    } // namespace loop
+
+    template <int times, typename Greeting>
+    void toDevice(TemplateCompleteGuide::benchmark::State &state, Greeting greeting)
+    {
+        std::ofstream device(TemplateCompleteGuide::benchmark::nullDevice);
+        auto previous = std::cout.rdbuf(device.rdbuf());
+        state.setItemsPerIteration(times);
+        for (auto _ : state)
+            greeting();
+        std::cout.rdbuf(previous);
+    }
+} // namespace
+
+TCG_BENCHMARK(Greeting_Loop_10)
+{
+    toDevice<10>(state, loop::greeting<msg, 10>);
+}
+TCG_BENCHMARK(Greeting_Static_10)
+{
+    toDevice<10>(state, greeting<msg, 10>);
+}
+TCG_BENCHMARK(Greeting_Loop_1000)
+{
+    toDevice<1000>(state, loop::greeting<msg, 1000>);
+}
+TCG_BENCHMARK(Greeting_Static_1000)
+{
+    toDevice<1000>(state, greeting<msg, 1000>);
+}
+TCG_BENCHMARK(Greeting_Loop_10000)
+{
+    toDevice<10000>(state, loop::greeting<msg, 10000>);
+}
+TCG_BENCHMARK(Greeting_Static_10000)
+{
+    toDevice<10000>(state, greeting<msg, 10000>);
+}
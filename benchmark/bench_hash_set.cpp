@@ -0,0 +1,299 @@
+#include "benchmark.h"
+#include "../flat_hash_set.h"
+#include "../concurrent_hash_set.h"
+#include <mutex>
+#include <random>
+#include <thread>
+
+/**
+ * FlatHashSet and ConcurrentHashSet against std::unordered_set , argument: number of elements , 1K , 1M and 10M.
+ * Insertion builds the whole set , the lookups probe lookups keys that are all present (_Hit) or all absent (_Miss).
+ */
+namespace
+{
+    using namespace TemplateCompleteGuide::chapter4::variadicBaseClassAndUsing;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+    using CustomerOP = Overloader<CustomerHash, CustomerEq>;
+
+    constexpr std::size_t lookups = 4096;
+
+    // Even keys in the set , odd ones never are
+    struct Keys
+    {
+        std::vector<int> inserted, hits, misses;
+
+        explicit Keys(std::size_t size)
+        {
+            std::mt19937 random(11);
+            for (std::size_t i = 0; i < size; ++i)
+                inserted.push_back(static_cast<int>(random() & ~1u));
+            for (std::size_t i = 0; i < lookups; ++i)
+            {
+                hits.push_back(inserted[random() % size]);
+                misses.push_back(static_cast<int>(random() | 1u));
+            }
+        }
+    };
+
+    template <typename Set>
+    struct IntSet
+    {
+        Keys keys;
+        Set set;
+
+        explicit IntSet(std::size_t size) : keys(size)
+        {
+            for (auto key : keys.inserted)
+                set.insert(key);
+        }
+    };
+
+    template <typename Set>
+    struct CustomerSet
+    {
+        std::vector<std::string> present, absent;
+        Set set;
+
+        explicit CustomerSet(std::size_t size)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                set.emplace("Customer number " + std::to_string(i));
+            std::mt19937 random(13);
+            for (std::size_t i = 0; i < lookups; ++i)
+            {
+                present.push_back("Customer number " + std::to_string(random() % size));
+                absent.push_back("Customer number " + std::to_string(size + i));
+            }
+        }
+    };
+
+    /**
+     * What a benchmark builds for its argument , kept across its runs since a 10M set takes seconds to build.
+     * One at a time: the previous one is released first , so the 10M sets of different benchmarks never add up.
+     */
+    struct Cache
+    {
+        std::shared_ptr<void> value;
+        std::type_info const *type = nullptr;
+        std::int64_t arg = 0;
+    } cache;
+
+    template <typename T>
+    T &cached(std::int64_t arg)
+    {
+        if (cache.type != &typeid(T) || cache.arg != arg)
+        {
+            cache.value.reset();
+            cache.value = std::make_shared<T>(static_cast<std::size_t>(arg));
+            cache.type = &typeid(T);
+            cache.arg = arg;
+        }
+        return *static_cast<T *>(cache.value.get());
+    }
+
+    template <typename Set>
+    void lookUp(TemplateCompleteGuide::benchmark::State &state, Set const &set, std::vector<int> const &probes)
+    {
+        state.setItemsPerIteration(lookups);
+        for (auto _ : state)
+        {
+            std::size_t found = 0;
+            for (auto probe : probes)
+                found += set.find(probe) != set.end();
+            doNotOptimize(found);
+        }
+    }
+    template <typename Set>
+    void insertAll(TemplateCompleteGuide::benchmark::State &state)
+    {
+        auto const &keys = cached<Keys>(state.arg());
+        state.setItemsPerIteration(static_cast<double>(keys.inserted.size()));
+        for (auto _ : state)
+        {
+            Set set;
+            for (auto key : keys.inserted)
+                set.insert(key);
+            doNotOptimize(set);
+        }
+    }
+
+    // Looking customers up by name: unordered_set needs a Customer , FlatHashSet takes the string_view
+    void lookUpCustomers(TemplateCompleteGuide::benchmark::State &state, std::unordered_set<Customer, CustomerOP, CustomerOP> const &set,
+                         std::vector<std::string> const &probes)
+    {
+        state.setItemsPerIteration(lookups);
+        for (auto _ : state)
+        {
+            std::size_t found = 0;
+            for (auto const &probe : probes)
+                found += set.count(Customer(probe));
+            doNotOptimize(found);
+        }
+    }
+    void lookUpCustomers(TemplateCompleteGuide::benchmark::State &state, FlatHashSet<Customer, CustomerOP, CustomerOP> const &set,
+                         std::vector<std::string> const &probes)
+    {
+        state.setItemsPerIteration(lookups);
+        for (auto _ : state)
+        {
+            std::size_t found = 0;
+            for (auto const &probe : probes)
+                found += set.contains(std::string_view(probe));
+            doNotOptimize(found);
+        }
+    }
+
+    using UnorderedInts = IntSet<std::unordered_set<int>>;
+    using FlatInts = IntSet<FlatHashSet<int>>;
+    using UnorderedCustomers = CustomerSet<std::unordered_set<Customer, CustomerOP, CustomerOP>>;
+    using FlatCustomers = CustomerSet<FlatHashSet<Customer, CustomerOP, CustomerOP>>;
+} // namespace
+
+#define TCG_SET_SIZES 1024, 1 << 20, 10000000
+
+TCG_BENCHMARK_ARGS(HashSet_LookupUnordered_Hit, TCG_SET_SIZES)
+{
+    auto const &fixture = cached<UnorderedInts>(state.arg());
+    lookUp(state, fixture.set, fixture.keys.hits);
+}
+TCG_BENCHMARK_ARGS(HashSet_LookupUnordered_Miss, TCG_SET_SIZES)
+{
+    auto const &fixture = cached<UnorderedInts>(state.arg());
+    lookUp(state, fixture.set, fixture.keys.misses);
+}
+
+TCG_BENCHMARK_ARGS(HashSet_LookupFlat_Hit, TCG_SET_SIZES)
+{
+    auto const &fixture = cached<FlatInts>(state.arg());
+    lookUp(state, fixture.set, fixture.keys.hits);
+}
+TCG_BENCHMARK_ARGS(HashSet_LookupFlat_Miss, TCG_SET_SIZES)
+{
+    auto const &fixture = cached<FlatInts>(state.arg());
+    lookUp(state, fixture.set, fixture.keys.misses);
+}
+
+TCG_BENCHMARK_ARGS(HashSet_InsertUnordered, TCG_SET_SIZES)
+{
+    insertAll<std::unordered_set<int>>(state);
+}
+
+TCG_BENCHMARK_ARGS(HashSet_InsertFlat, TCG_SET_SIZES)
+{
+    insertAll<FlatHashSet<int>>(state);
+}
+
+TCG_BENCHMARK_ARGS(CustomerLookup_Unordered_Hit, TCG_SET_SIZES)
+{
+    auto const &fixture = cached<UnorderedCustomers>(state.arg());
+    lookUpCustomers(state, fixture.set, fixture.present);
+}
+TCG_BENCHMARK_ARGS(CustomerLookup_Unordered_Miss, TCG_SET_SIZES)
+{
+    auto const &fixture = cached<UnorderedCustomers>(state.arg());
+    lookUpCustomers(state, fixture.set, fixture.absent);
+}
+
+TCG_BENCHMARK_ARGS(CustomerLookup_Flat_Hit, TCG_SET_SIZES)
+{
+    auto const &fixture = cached<FlatCustomers>(state.arg());
+    lookUpCustomers(state, fixture.set, fixture.present);
+}
+TCG_BENCHMARK_ARGS(CustomerLookup_Flat_Miss, TCG_SET_SIZES)
+{
+    auto const &fixture = cached<FlatCustomers>(state.arg());
+    lookUpCustomers(state, fixture.set, fixture.absent);
+}
+
+namespace
+{
+    /**
+     * Several threads looking keys up and inserting new ones , 99/1 (_Read99) or 50/50 (_Read50) , argument: number
+     * of threads , run as given even past the hardware threads (the "hardware" counter).
+     * Every iteration is sharedOperations operations split between the threads , started and joined.
+     */
+    constexpr std::size_t sharedOperations = 1 << 16;
+
+    template <typename Set>
+    void mixedWorkload(TemplateCompleteGuide::benchmark::State &state, Set &set, Keys const &keys, std::size_t writePercent)
+    {
+        auto threads = static_cast<std::size_t>(state.arg());
+        state.setCounter("threads", static_cast<double>(threads));
+        state.setCounter("hardware", std::thread::hardware_concurrency());
+        state.setItemsPerIteration(sharedOperations);
+        for (auto _ : state)
+        {
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < threads; ++t)
+                workers.emplace_back([&, t]
+                                     {
+                                         std::size_t found = 0;
+                                         for (std::size_t i = t; i < sharedOperations; i += threads)
+                                         {
+                                             if (i % 100 < writePercent)
+                                                 set.insert(keys.hits[i % lookups] + static_cast<int>(i));
+                                             else
+                                                 found += set.contains(keys.hits[i % lookups]);
+                                         }
+                                         doNotOptimize(found);
+                                     });
+            for (auto &worker : workers)
+                worker.join();
+        }
+    }
+
+    // std::unordered_set behind one lock , the obvious alternative
+    struct LockedSet
+    {
+        std::mutex mutex;
+        std::unordered_set<int> set;
+
+        explicit LockedSet(Keys const &keys) : set(keys.inserted.begin(), keys.inserted.end())
+        {
+        }
+        void insert(int key)
+        {
+            std::lock_guard lock(mutex);
+            set.insert(key);
+        }
+        bool contains(int key)
+        {
+            std::lock_guard lock(mutex);
+            return set.count(key) != 0;
+        }
+    };
+
+    void lockedWorkload(TemplateCompleteGuide::benchmark::State &state, std::size_t writePercent)
+    {
+        Keys keys(1 << 16);
+        LockedSet set(keys);
+        mixedWorkload(state, set, keys, writePercent);
+    }
+    void concurrentWorkload(TemplateCompleteGuide::benchmark::State &state, std::size_t writePercent)
+    {
+        Keys keys(1 << 16);
+        ConcurrentHashSet<int> set;
+        set.bulkInsert(keys.inserted.begin(), keys.inserted.end());
+        mixedWorkload(state, set, keys, writePercent);
+    }
+} // namespace
+
+#define TCG_THREAD_COUNTS 1, 2, 4, 8, 16, 32, 64
+
+TCG_BENCHMARK_ARGS(SharedSet_Locked_Read99, TCG_THREAD_COUNTS)
+{
+    lockedWorkload(state, 1);
+}
+TCG_BENCHMARK_ARGS(SharedSet_Locked_Read50, TCG_THREAD_COUNTS)
+{
+    lockedWorkload(state, 50);
+}
+
+TCG_BENCHMARK_ARGS(SharedSet_Concurrent_Read99, TCG_THREAD_COUNTS)
+{
+    concurrentWorkload(state, 1);
+}
+TCG_BENCHMARK_ARGS(SharedSet_Concurrent_Read50, TCG_THREAD_COUNTS)
+{
+    concurrentWorkload(state, 50);
+}
@@ -0,0 +1,65 @@
+#include "benchmark.h"
+#include "../instrumentation.h"
+#include <atomic>
+
+/**
+ * Cost of one instrumentation event , what TCG_INSTRUMENT adds to a hot construct: a counter update , a
+ * histogram record and a scoped timer (two tick reads and a record) , next to the clocks themselves and to a
+ * counter shared by all the threads. The registry is used directly , the macros only as configured: without
+ * -DTCG_INSTRUMENT=ON , Instrumentation_Macro measures an empty loop.
+ */
+namespace
+{
+    using namespace TemplateCompleteGuide;
+    using namespace TemplateCompleteGuide::instrumentation;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+
+    std::atomic<std::uint64_t> sharedCounter{0};
+} // namespace
+
+TCG_BENCHMARK(Instrumentation_Macro)
+{
+    for (auto _ : state)
+        TCG_COUNTER_INC("benchmark.macro");
+}
+TCG_BENCHMARK(Instrumentation_Ticks)
+{
+    for (auto _ : state)
+        doNotOptimize(platform::ticks());
+}
+TCG_BENCHMARK(Instrumentation_SteadyClock)
+{
+    for (auto _ : state)
+        doNotOptimize(std::chrono::steady_clock::now());
+}
+TCG_BENCHMARK(Instrumentation_SharedAtomicCounter)
+{
+    for (auto _ : state)
+        sharedCounter.fetch_add(1, std::memory_order_relaxed);
+}
+TCG_BENCHMARK(Instrumentation_Counter)
+{
+    auto counter = Registry::instance().counter("benchmark.counter");
+    for (auto _ : state)
+        Registry::add(counter, 1);
+}
+TCG_BENCHMARK(Instrumentation_HistogramRecord)
+{
+    auto histogram = Registry::instance().histogram("benchmark.histogram");
+    std::uint64_t value = 1;
+    for (auto _ : state)
+        Registry::record(histogram, (value = value * 6364136223846793005u + 1442695040888963407u) >> 40);
+}
+TCG_BENCHMARK(Instrumentation_ScopedTimer)
+{
+    auto histogram = Registry::instance().histogram("benchmark.timer", Unit::Ticks);
+    for (auto _ : state)
+    {
+        ScopedTimer timer(histogram);
+    }
+}
+TCG_BENCHMARK(Instrumentation_Snapshot)
+{
+    for (auto _ : state)
+        doNotOptimize(Registry::instance().snapshot());
+}
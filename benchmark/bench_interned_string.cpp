@@ -0,0 +1,149 @@
+#include "benchmark.h"
+#include "../interned_string.h"
+#include <random>
+
+/**
+ * Annotated values with std::string comments against interned ones , drawn from a small vocabulary as real
+ * annotations are. Construction and equality throughput , and the memory footprint per value ("bytes_per_value":
+ * the object , plus the heap bytes of its strings or its share of the pool).
+ */
+namespace
+{
+    using namespace TemplateCompleteGuide::chapter2;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+
+    constexpr std::size_t valueCount = 1 << 16;
+    constexpr std::size_t vocabulary = 1024;
+
+    // Texts beyond the small-string buffer , e.g. "annotation of sensor 417 (calibrated)"
+    std::vector<std::string> const &words()
+    {
+        static std::vector<std::string> texts = []
+        {
+            std::vector<std::string> result;
+            for (std::size_t i = 0; i < vocabulary; ++i)
+                result.push_back("annotation of sensor " + std::to_string(i) + (i % 2 ? " (calibrated)" : " (raw)"));
+            return result;
+        }();
+        return texts;
+    }
+    std::vector<std::uint32_t> const &picks()
+    {
+        static std::vector<std::uint32_t> indices = []
+        {
+            std::vector<std::uint32_t> result(valueCount);
+            std::mt19937 random(11);
+            for (auto &each : result)
+                each = static_cast<std::uint32_t>(random() % vocabulary);
+            return result;
+        }();
+        return indices;
+    }
+
+    std::size_t heapBytes(std::string const &text)
+    {
+        auto object = reinterpret_cast<char const *>(&text);
+        auto inside = text.data() >= object && text.data() < object + sizeof(text);
+        return inside ? 0 : text.capacity() + 1;
+    }
+} // namespace
+
+TCG_BENCHMARK(AnnotatedValues_Construct_String)
+{
+    auto const &texts = words();
+    auto const &indices = picks();
+    state.setItemsPerIteration(valueCount);
+    std::size_t bytes = 0;
+    for (auto _ : state)
+    {
+        std::vector<ValueWithComment<std::string>> values;
+        values.reserve(valueCount);
+        for (auto index : indices)
+            values.push_back({texts[index], texts[(index * 7) % vocabulary]});
+        doNotOptimize(values.data());
+        bytes = values.size() * sizeof(values[0]);
+        for (auto const &each : values)
+            bytes += heapBytes(each.value) + heapBytes(each.comment);
+    }
+    state.setCounter("bytes_per_value", static_cast<double>(bytes) / valueCount);
+}
+
+TCG_BENCHMARK(AnnotatedValues_Construct_Interned)
+{
+    auto const &texts = words();
+    auto const &indices = picks();
+    state.setItemsPerIteration(valueCount);
+    std::size_t bytes = 0;
+    for (auto _ : state)
+    {
+        StringPool pool;
+        std::vector<ValueWithComment<InternedString, InternedString>> values;
+        values.reserve(valueCount);
+        for (auto index : indices)
+            values.push_back({pool.intern(texts[index]), pool.intern(texts[(index * 7) % vocabulary])});
+        doNotOptimize(values.data());
+        bytes = values.size() * sizeof(values[0]) + pool.bytes();
+    }
+    state.setCounter("bytes_per_value", static_cast<double>(bytes) / valueCount);
+}
+
+// How many values carry the same comment as their neighbour
+TCG_BENCHMARK(AnnotatedValues_Compare_String)
+{
+    std::vector<std::string> comments;
+    for (auto index : picks())
+        comments.push_back(words()[index % 64]);
+    state.setItemsPerIteration(valueCount - 1);
+    for (auto _ : state)
+    {
+        std::size_t same = 0;
+        for (std::size_t i = 1; i < comments.size(); ++i)
+            same += comments[i] == comments[i - 1];
+        doNotOptimize(same);
+    }
+}
+
+TCG_BENCHMARK(AnnotatedValues_Compare_Interned)
+{
+    StringPool pool;
+    std::vector<InternedString> comments;
+    for (auto index : picks())
+        comments.push_back(pool.intern(words()[index % 64]));
+    state.setItemsPerIteration(valueCount - 1);
+    for (auto _ : state)
+    {
+        std::size_t same = 0;
+        for (std::size_t i = 1; i < comments.size(); ++i)
+            same += comments[i] == comments[i - 1];
+        doNotOptimize(same);
+    }
+}
+
+// comment + " " + value: a new std::string per concatenation against a rope copied into one buffer
+TCG_BENCHMARK(AnnotatedValues_Concat_String)
+{
+    auto const &texts = words();
+    state.setItemsPerIteration(vocabulary);
+    for (auto _ : state)
+        for (std::size_t i = 0; i < vocabulary; ++i)
+        {
+            auto sentence = texts[i] + " " + texts[(i * 7) % vocabulary];
+            doNotOptimize(sentence.data());
+        }
+}
+
+TCG_BENCHMARK(AnnotatedValues_Concat_Rope)
+{
+    StringPool pool;
+    std::vector<InternedString> texts;
+    for (auto const &each : words())
+        texts.push_back(pool.intern(each));
+    char line[256];
+    state.setItemsPerIteration(vocabulary);
+    for (auto _ : state)
+        for (std::size_t i = 0; i < vocabulary; ++i)
+        {
+            auto sentence = texts[i] + " " + texts[(i * 7) % vocabulary];
+            doNotOptimize(sentence.copy(line));
+        }
+}
@@ -0,0 +1,79 @@
+#include "benchmark.h"
+#include "../design_pattern.h"
+#include "../template_complete_guide.h"
+#include <memory_resource>
+#include <thread>
+
+/**
+ * Allocate / free throughput of tree nodes: ObjectPool against new / delete and
+ * std::pmr::synchronized_pool_resource , argument: number of threads , run as given even past the hardware
+ * threads (the "hardware" counter).
+ * Every thread allocates burst nodes and frees them , rounds times per iteration; the threads are started
+ * and joined inside the iteration , the same cost for every allocator.
+ * NOTICE the harness counts allocations with an atomic in operator new , which new / delete pays here
+ */
+namespace
+{
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+    using TemplateCompleteGuide::chapter4::application::Node;
+
+    constexpr std::size_t burst = 64;
+    constexpr std::size_t rounds = 256;
+
+    template <typename Allocate, typename Free>
+    void churn(TemplateCompleteGuide::benchmark::State &state, Allocate allocate, Free free)
+    {
+        auto threads = static_cast<unsigned>(state.arg());
+        state.setCounter("threads", threads);
+        state.setCounter("hardware", std::thread::hardware_concurrency());
+        state.setItemsPerIteration(static_cast<double>(threads * rounds * burst));
+        auto work = [&]
+        {
+            Node *nodes[burst];
+            for (std::size_t round = 0; round < rounds; ++round)
+            {
+                for (std::size_t i = 0; i < burst; ++i)
+                    nodes[i] = allocate(static_cast<int>(i));
+                doNotOptimize(nodes);
+                for (std::size_t i = 0; i < burst; ++i)
+                    free(nodes[i]);
+            }
+        };
+        for (auto _ : state)
+        {
+            std::vector<std::thread> workers;
+            for (unsigned t = 1; t < threads; ++t)
+                workers.emplace_back(work);
+            work();
+            for (auto &worker : workers)
+                worker.join();
+        }
+    }
+} // namespace
+
+#define TCG_THREAD_COUNTS 1, 2, 4, 8, 16, 32, 64
+
+TCG_BENCHMARK_ARGS(NodeChurn_NewDelete, TCG_THREAD_COUNTS)
+{
+    churn(
+        state, [](int value) { return new Node(value); }, [](Node *node) { delete node; });
+}
+
+TCG_BENCHMARK_ARGS(NodeChurn_SynchronizedPool, TCG_THREAD_COUNTS)
+{
+    std::pmr::synchronized_pool_resource resource;
+    churn(
+        state, [&](int value) { return ::new (resource.allocate(sizeof(Node), alignof(Node))) Node(value); },
+        [&](Node *node)
+        {
+            node->~Node();
+            resource.deallocate(node, sizeof(Node), alignof(Node));
+        });
+}
+
+TCG_BENCHMARK_ARGS(NodeChurn_ObjectPool, TCG_THREAD_COUNTS)
+{
+    DesignPattern::ObjectPool<Node> pool;
+    churn(
+        state, [&](int value) { return pool.create(value); }, [&](Node *node) { pool.destroy(node); });
+}
@@ -0,0 +1,170 @@
+#include "benchmark.h"
+#include "../cpp_features.h"
+#include "../array_expression.h"
+#include "../operation_vm.h"
+
+// Operation<op> on scalars and arrays , and the formula (a * b + c) / b known only at runtime
+namespace
+{
+    using namespace CppFeatures;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+
+    constexpr std::size_t arraySize = 1 << 16;
+
+    // Baseline interpreter: one switch per instruction
+    void executeSwitch(vm::Program const &program, double *registers)
+    {
+        for (auto const &each : program)
+        {
+            auto lhs = registers[each.lhs], rhs = registers[each.rhs];
+            switch (each.op)
+            {
+            case Operators::Add:
+                registers[each.dest] = lhs + rhs;
+                break;
+            case Operators::Sub:
+                registers[each.dest] = lhs - rhs;
+                break;
+            case Operators::Mut:
+                registers[each.dest] = lhs * rhs;
+                break;
+            case Operators::Div:
+                registers[each.dest] = lhs / rhs;
+                break;
+            }
+        }
+    }
+
+    vm::Program formula()
+    {
+        // r3 = (r0 * r1 + r2) / r1
+        return vm::Program({{Operators::Mut, 3, 0, 1}, {Operators::Add, 3, 3, 2}, {Operators::Div, 3, 3, 1}}, 4);
+    }
+
+    struct Columns
+    {
+        std::vector<double> a, b, c, result;
+
+        Columns() : a(arraySize), b(arraySize), c(arraySize), result(arraySize)
+        {
+            for (std::size_t i = 0; i < arraySize; ++i)
+            {
+                a[i] = static_cast<double>(i);
+                b[i] = 1.0 + i % 5;
+                c[i] = 0.5 * i;
+            }
+        }
+    };
+
+    // Memory traffic of one iteration , arrays of arraySize doubles read and written (b counted once per pass)
+    void setTraffic(TemplateCompleteGuide::benchmark::State &state, std::size_t arraysRead, std::size_t arraysWritten)
+    {
+        auto bytes = static_cast<double>(arraySize * sizeof(double));
+        state.setCounter("bytes_read", static_cast<double>(arraysRead) * bytes);
+        state.setCounter("bytes_written", static_cast<double>(arraysWritten) * bytes);
+        state.setBytesPerIteration(static_cast<double>(arraysRead + arraysWritten) * bytes);
+    }
+} // namespace
+
+TCG_BENCHMARK(Operation_Scalar)
+{
+    double lhs = 3, rhs = 2;
+    for (auto _ : state)
+    {
+        doNotOptimize(lhs);
+        auto result = Operation<Operators::Div>{}(Operation<Operators::Add>{}(Operation<Operators::Mut>{}(lhs, rhs), lhs), rhs);
+        doNotOptimize(result);
+    }
+}
+
+// Array expression: one fused loop against one loop and one temporary per operator
+TCG_BENCHMARK(ArrayExpression_Fused)
+{
+    Columns columns;
+    ArrayView<double> out(columns.result);
+    state.setItemsPerIteration(arraySize);
+    setTraffic(state, 3, 1); // a , b , c in one pass , result
+    for (auto _ : state)
+    {
+        out = (ArrayView(columns.a) * ArrayView(columns.b) + ArrayView(columns.c)) / ArrayView(columns.b);
+        doNotOptimize(columns.result.data());
+    }
+}
+
+TCG_BENCHMARK(ArrayExpression_Temporaries)
+{
+    Columns columns;
+    state.setItemsPerIteration(arraySize);
+    setTraffic(state, 6, 3); // a * b , then + c , then / b: two arrays in and one temporary out per operator
+    auto apply = [](std::vector<double> const &lhs, std::vector<double> const &rhs, auto op)
+    {
+        std::vector<double> result(lhs.size());
+        std::transform(lhs.begin(), lhs.end(), rhs.begin(), result.begin(), op);
+        return result;
+    };
+    for (auto _ : state)
+    {
+        columns.result = apply(apply(apply(columns.a, columns.b, std::multiplies<>()), columns.c, std::plus<>()), columns.b, std::divides<>());
+        doNotOptimize(columns.result.data());
+    }
+}
+
+// The same formula per row: compiled in , interpreted with a switch , with the VM , and by columns
+TCG_BENCHMARK(Formula_Native)
+{
+    Columns columns;
+    state.setItemsPerIteration(arraySize);
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < arraySize; ++i)
+            columns.result[i] = (columns.a[i] * columns.b[i] + columns.c[i]) / columns.b[i];
+        doNotOptimize(columns.result.data());
+    }
+}
+
+TCG_BENCHMARK(Formula_SwitchInterpreter)
+{
+    Columns columns;
+    auto program = formula();
+    state.setItemsPerIteration(arraySize);
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < arraySize; ++i)
+        {
+            double registers[4] = {columns.a[i], columns.b[i], columns.c[i], 0};
+            executeSwitch(program, registers);
+            columns.result[i] = registers[3];
+        }
+        doNotOptimize(columns.result.data());
+    }
+}
+
+TCG_BENCHMARK(Formula_VmScalar)
+{
+    Columns columns;
+    auto program = formula();
+    state.setItemsPerIteration(arraySize);
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < arraySize; ++i)
+        {
+            double registers[4] = {columns.a[i], columns.b[i], columns.c[i], 0};
+            vm::execute(program, registers);
+            columns.result[i] = registers[3];
+        }
+        doNotOptimize(columns.result.data());
+    }
+}
+
+TCG_BENCHMARK(Formula_VmColumns)
+{
+    Columns columns;
+    auto program = formula();
+    std::vector<double const *> inputs = {columns.a.data(), columns.b.data(), columns.c.data()};
+    state.setItemsPerIteration(arraySize);
+    for (auto _ : state)
+    {
+        vm::evaluateColumns<double>(program, inputs, columns.result.data(), arraySize, 3);
+        doNotOptimize(columns.result.data());
+    }
+}
@@ -0,0 +1,232 @@
+#include "benchmark.h"
+#include "../algorithm_in_cpp.h"
+#include <cmath>
+#include <random>
+#if defined(TCG_STD_PARALLEL)
+#include <execution>
+#endif
+
+/**
+ * The parallel algorithms against their sequential <algorithm> / <numeric> versions and std::execution::par
+ * (when the standard library has a backend , see CMakeLists.txt). Argument of the _Pool cases: number of workers ,
+ * run as given even past the hardware threads , the "hardware" counter tells how many the machine has.
+ */
+namespace
+{
+    using namespace AlgorithmInCpp;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+
+    constexpr std::size_t elementCount = 1 << 22;
+    constexpr std::size_t sortCount = 1 << 20;
+
+    std::vector<double> const &doubles()
+    {
+        static std::vector<double> values = []
+        {
+            std::vector<double> result(elementCount);
+            std::mt19937 random(7);
+            for (auto &each : result)
+                each = static_cast<double>(random() % 1000) * 0.25;
+            return result;
+        }();
+        return values;
+    }
+    std::vector<int> const &unsorted()
+    {
+        static std::vector<int> values = []
+        {
+            std::vector<int> result(sortCount);
+            std::mt19937 random(9);
+            for (auto &each : result)
+                each = static_cast<int>(random());
+            return result;
+        }();
+        return values;
+    }
+
+    // Enough work per element for the arithmetic , not the memory bus , to decide
+    double heavy(double value)
+    {
+        return std::sqrt(value) * std::log1p(value);
+    }
+
+    // Run body(policy) in the timed loop with a pool of state.arg() workers
+    template <typename Body>
+    void onPool(TemplateCompleteGuide::benchmark::State &state, Body body)
+    {
+        auto threads = static_cast<unsigned>(state.arg());
+        WorkStealingPool pool(threads);
+        parallel::Policy policy(pool);
+        state.setCounter("threads", threads);
+        state.setCounter("hardware", std::thread::hardware_concurrency());
+        for (auto _ : state)
+            body(policy);
+    }
+} // namespace
+
+#define TCG_THREAD_COUNTS 1, 2, 4, 8, 16, 32, 64
+
+TCG_BENCHMARK(ParallelForEach_Sequential)
+{
+    auto values = doubles();
+    state.setItemsPerIteration(elementCount);
+    for (auto _ : state)
+    {
+        std::for_each(values.begin(), values.end(), [](double &value) { value = heavy(value); });
+        doNotOptimize(values.data());
+    }
+}
+
+TCG_BENCHMARK_ARGS(ParallelForEach_Pool, TCG_THREAD_COUNTS)
+{
+    auto values = doubles();
+    state.setItemsPerIteration(elementCount);
+    onPool(state, [&](parallel::Policy const &policy)
+           {
+               parallel::forEach(policy, values, [](double &value) { value = heavy(value); });
+               doNotOptimize(values.data());
+           });
+}
+
+TCG_BENCHMARK(ParallelTransform_Sequential)
+{
+    auto const &values = doubles();
+    std::vector<double> out(elementCount);
+    state.setItemsPerIteration(elementCount);
+    for (auto _ : state)
+    {
+        std::transform(values.begin(), values.end(), out.begin(), [](double value) { return value * 2 + 1; });
+        doNotOptimize(out.data());
+    }
+}
+
+TCG_BENCHMARK_ARGS(ParallelTransform_Pool, TCG_THREAD_COUNTS)
+{
+    auto const &values = doubles();
+    std::vector<double> out(elementCount);
+    state.setItemsPerIteration(elementCount);
+    onPool(state, [&](parallel::Policy const &policy)
+           {
+               parallel::transform(policy, values.begin(), values.end(), out.begin(), [](double value) { return value * 2 + 1; });
+               doNotOptimize(out.data());
+           });
+}
+
+TCG_BENCHMARK(ParallelReduce_Sequential)
+{
+    auto const &values = doubles();
+    state.setItemsPerIteration(elementCount);
+    for (auto _ : state)
+        doNotOptimize(std::reduce(values.begin(), values.end(), 0.0));
+}
+
+TCG_BENCHMARK_ARGS(ParallelReduce_Pool, TCG_THREAD_COUNTS)
+{
+    auto const &values = doubles();
+    state.setItemsPerIteration(elementCount);
+    onPool(state, [&](parallel::Policy const &policy)
+           { doNotOptimize(parallel::reduce(policy, values, 0.0)); });
+}
+
+TCG_BENCHMARK(ParallelScan_Sequential)
+{
+    auto const &values = doubles();
+    std::vector<double> out(elementCount);
+    state.setItemsPerIteration(elementCount);
+    for (auto _ : state)
+    {
+        std::inclusive_scan(values.begin(), values.end(), out.begin());
+        doNotOptimize(out.data());
+    }
+}
+
+TCG_BENCHMARK_ARGS(ParallelScan_Pool, TCG_THREAD_COUNTS)
+{
+    auto const &values = doubles();
+    std::vector<double> out(elementCount);
+    state.setItemsPerIteration(elementCount);
+    onPool(state, [&](parallel::Policy const &policy)
+           {
+               parallel::inclusiveScan(policy, values.begin(), values.end(), out.begin());
+               doNotOptimize(out.data());
+           });
+}
+
+// Every iteration sorts a fresh copy , the copy is part of the time in all the sort cases
+TCG_BENCHMARK(ParallelSort_Sequential)
+{
+    state.setItemsPerIteration(sortCount);
+    for (auto _ : state)
+    {
+        auto values = unsorted();
+        std::sort(values.begin(), values.end());
+        doNotOptimize(values.data());
+    }
+}
+
+TCG_BENCHMARK_ARGS(ParallelSort_Pool, TCG_THREAD_COUNTS)
+{
+    state.setItemsPerIteration(sortCount);
+    onPool(state, [&](parallel::Policy const &policy)
+           {
+               auto values = unsorted();
+               parallel::sort(policy, values);
+               doNotOptimize(values.data());
+           });
+}
+
+#if defined(TCG_STD_PARALLEL)
+TCG_BENCHMARK(ParallelForEach_StdPar)
+{
+    auto values = doubles();
+    state.setItemsPerIteration(elementCount);
+    for (auto _ : state)
+    {
+        std::for_each(std::execution::par, values.begin(), values.end(), [](double &value) { value = heavy(value); });
+        doNotOptimize(values.data());
+    }
+}
+
+TCG_BENCHMARK(ParallelTransform_StdPar)
+{
+    auto const &values = doubles();
+    std::vector<double> out(elementCount);
+    state.setItemsPerIteration(elementCount);
+    for (auto _ : state)
+    {
+        std::transform(std::execution::par, values.begin(), values.end(), out.begin(), [](double value) { return value * 2 + 1; });
+        doNotOptimize(out.data());
+    }
+}
+
+TCG_BENCHMARK(ParallelReduce_StdPar)
+{
+    auto const &values = doubles();
+    state.setItemsPerIteration(elementCount);
+    for (auto _ : state)
+        doNotOptimize(std::reduce(std::execution::par, values.begin(), values.end(), 0.0));
+}
+
+TCG_BENCHMARK(ParallelScan_StdPar)
+{
+    auto const &values = doubles();
+    std::vector<double> out(elementCount);
+    state.setItemsPerIteration(elementCount);
+    for (auto _ : state)
+    {
+        std::inclusive_scan(std::execution::par, values.begin(), values.end(), out.begin());
+        doNotOptimize(out.data());
+    }
+}
+
+TCG_BENCHMARK(ParallelSort_StdPar)
+{
+    state.setItemsPerIteration(sortCount);
+    for (auto _ : state)
+    {
+        auto values = unsorted();
+        std::sort(std::execution::par, values.begin(), values.end());
+        doNotOptimize(values.data());
+    }
+}
+#endif
@@ -0,0 +1,114 @@
+#include "benchmark.h"
+#include "../template_complete_guide.h"
+#include "../buffered_print.h"
+#include <fcntl.h>
+#include <fstream>
+#if defined _WIN32
+#include <io.h>
+#endif
+
+// The variadic print variants , std::cout is a null buffer while benchmarking , the buffered one writes the null device
+namespace
+{
+    using namespace TemplateCompleteGuide::chapter4;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+
+    struct NullDevice
+    {
+#if defined _WIN32
+        int fd = ::_open(TemplateCompleteGuide::benchmark::nullDevice, _O_WRONLY);
+        ~NullDevice()
+        {
+            ::_close(fd);
+        }
+#else
+        int fd = ::open(TemplateCompleteGuide::benchmark::nullDevice, O_WRONLY);
+        ~NullDevice()
+        {
+            ::close(fd);
+        }
+#endif
+    };
+    int nullFd()
+    {
+        static NullDevice device;
+        return device.fd;
+    }
+} // namespace
+
+TCG_BENCHMARK(Print_Fold)
+{
+    int number = 42;
+    double real = 3.25;
+    std::string text = "World";
+    for (auto _ : state)
+    {
+        doNotOptimize(number);
+        print("Hello ", number, ' ', real, ' ', text);
+    }
+}
+
+TCG_BENCHMARK(Print_Overload)
+{
+    int number = 42;
+    double real = 3.25;
+    std::string text = "World";
+    for (auto _ : state)
+    {
+        doNotOptimize(number);
+        overload::print("Hello ", number, ' ', real, ' ', text);
+    }
+}
+
+TCG_BENCHMARK(Print_FoldWithSpace)
+{
+    int number = 42;
+    double real = 3.25;
+    std::string text = "World";
+    for (auto _ : state)
+    {
+        doNotOptimize(number);
+        application::printWithSpace("Hello", number, real, text);
+    }
+}
+
+TCG_BENCHMARK(Print_Helper)
+{
+    int number = 42;
+    double real = 3.25;
+    std::string text = "World";
+    for (auto _ : state)
+    {
+        doNotOptimize(number);
+        printHelper("Hello ", number, ' ', real, ' ', text, '\n');
+    }
+}
+
+TCG_BENCHMARK(Print_Buffered)
+{
+    int number = 42;
+    double real = 3.25;
+    std::string text = "World";
+    auto fd = nullFd();
+    for (auto _ : state)
+    {
+        doNotOptimize(number);
+        buffered::printTo(fd, "Hello ", number, ' ', real, ' ', text);
+    }
+}
+
+// Same line through std::cout on the null device , i.e. with a real write per flush like print does on a terminal
+TCG_BENCHMARK(Print_FoldToDevice)
+{
+    int number = 42;
+    double real = 3.25;
+    std::string text = "World";
+    std::ofstream device(TemplateCompleteGuide::benchmark::nullDevice);
+    auto previous = std::cout.rdbuf(device.rdbuf());
+    for (auto _ : state)
+    {
+        doNotOptimize(number);
+        print("Hello ", number, ' ', real, ' ', text);
+    }
+    std::cout.rdbuf(previous);
+}
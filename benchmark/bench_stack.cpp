@@ -0,0 +1,167 @@
+#include "benchmark.h"
+#include "../template_complete_guide.h"
+
+// Both Stack templates against std::vector , allocs/op shows what stays off the heap
+namespace
+{
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+
+    constexpr int depth = 16;
+
+    // A cache line per element
+    struct Payload64
+    {
+        std::uint64_t words[8];
+    };
+    static_assert(64 == sizeof(Payload64));
+} // namespace
+
+TCG_BENCHMARK(Stack_VectorBaseline)
+{
+    state.setItemsPerIteration(depth);
+    for (auto _ : state)
+    {
+        std::vector<int> stack;
+        for (int i = 0; i < depth; ++i)
+            stack.push_back(i);
+        while (!stack.empty())
+        {
+            doNotOptimize(stack.back());
+            stack.pop_back();
+        }
+    }
+}
+
+TCG_BENCHMARK(Stack_Chapter2Inline)
+{
+    state.setItemsPerIteration(depth);
+    for (auto _ : state)
+    {
+        TemplateCompleteGuide::chapter2::Stack<int> stack;
+        for (int i = 0; i < depth; ++i)
+            stack.push(i);
+        while (!stack.empty())
+        {
+            doNotOptimize(stack.top());
+            stack.pop();
+        }
+    }
+}
+
+// More elements than the inline capacity: the heap path
+TCG_BENCHMARK(Stack_Chapter2Spilled)
+{
+    state.setItemsPerIteration(depth);
+    for (auto _ : state)
+    {
+        TemplateCompleteGuide::chapter2::Stack<int, 4> stack;
+        for (int i = 0; i < depth; ++i)
+            stack.push(i);
+        while (!stack.empty())
+        {
+            doNotOptimize(stack.top());
+            stack.pop();
+        }
+    }
+}
+
+TCG_BENCHMARK(Stack_Chapter2String)
+{
+    std::string value = "vvvv";
+    state.setItemsPerIteration(depth);
+    for (auto _ : state)
+    {
+        TemplateCompleteGuide::chapter2::Stack<std::string> stack;
+        for (int i = 0; i < depth; ++i)
+            stack.push(value);
+        while (!stack.empty())
+        {
+            doNotOptimize(stack.top());
+            stack.pop();
+        }
+    }
+}
+
+TCG_BENCHMARK(Stack_VectorPayload64)
+{
+    Payload64 value = {{1, 2, 3, 4, 5, 6, 7, 8}};
+    state.setItemsPerIteration(depth);
+    for (auto _ : state)
+    {
+        std::vector<Payload64> stack;
+        for (int i = 0; i < depth; ++i)
+            stack.push_back(value);
+        while (!stack.empty())
+        {
+            doNotOptimize(stack.back());
+            stack.pop_back();
+        }
+    }
+}
+
+TCG_BENCHMARK(Stack_Chapter2Payload64)
+{
+    Payload64 value = {{1, 2, 3, 4, 5, 6, 7, 8}};
+    state.setItemsPerIteration(depth);
+    for (auto _ : state)
+    {
+        TemplateCompleteGuide::chapter2::Stack<Payload64> stack;
+        for (int i = 0; i < depth; ++i)
+            stack.push(value);
+        while (!stack.empty())
+        {
+            doNotOptimize(stack.top());
+            stack.pop();
+        }
+    }
+}
+
+TCG_BENCHMARK(Stack_Chapter3Bounded)
+{
+    state.setItemsPerIteration(depth);
+    for (auto _ : state)
+    {
+        TemplateCompleteGuide::chapter3::Stack<depth, int, TemplateCompleteGuide::chapter3::RejectOnOverflow> stack;
+        for (int i = 0; i < depth; ++i)
+            stack.push(i);
+        while (!stack.empty())
+        {
+            doNotOptimize(stack.top());
+            stack.pop();
+        }
+    }
+}
+
+TCG_BENCHMARK(Stack_Chapter3String)
+{
+    std::string value = "vvvv";
+    state.setItemsPerIteration(depth);
+    for (auto _ : state)
+    {
+        TemplateCompleteGuide::chapter3::Stack<depth, std::string> stack;
+        for (int i = 0; i < depth; ++i)
+            stack.push(value);
+        while (!stack.empty())
+        {
+            doNotOptimize(stack.top());
+            stack.pop();
+        }
+    }
+}
+
+TCG_BENCHMARK(Stack_Chapter3Payload64)
+{
+    Payload64 value = {{1, 2, 3, 4, 5, 6, 7, 8}};
+    state.setItemsPerIteration(depth);
+    for (auto _ : state)
+    {
+        TemplateCompleteGuide::chapter3::Stack<depth, Payload64> stack;
+        for (int i = 0; i < depth; ++i)
+            stack.push(value);
+        while (!stack.empty())
+        {
+            doNotOptimize(stack.top());
+            stack.pop();
+        }
+    }
+}
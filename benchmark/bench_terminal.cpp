@@ -0,0 +1,199 @@
+#include "benchmark.h"
+#include "../terminal.h"
+#include "../utils.h"
+#include <fcntl.h>
+#include <fstream>
+#include <poll.h>
+#include <termios.h>
+#include <thread>
+
+/**
+ * Frames per second (items/s) and bytes per frame of a live 80x24 dashboard: eight counters , two of them
+ * changing every frame , and a latency histogram fed every frame.
+ *  - ClearAndReprint        the former Clear() , system("clear") , and the whole frame printed again
+ *  - EscapeClearAndReprint  the current Clear() , an escape sequence , and the whole frame printed again
+ *  - Renderer               terminal::Dashboard , only the changed cells
+ * Everything goes to a pseudo-terminal whose master side is drained by a thread counting the bytes.
+ */
+namespace
+{
+    using namespace TemplateCompleteGuide::terminal;
+
+    constexpr Size screenSize{80, 24};
+
+    class Pty
+    {
+    public:
+        Pty()
+        {
+            master_ = ::posix_openpt(O_RDWR | O_NOCTTY);
+            if (master_ < 0 || ::grantpt(master_) != 0 || ::unlockpt(master_) != 0)
+                throw std::runtime_error("no pseudo-terminal");
+            slave_ = ::open(::ptsname(master_), O_RDWR | O_NOCTTY);
+            if (slave_ < 0)
+                throw std::runtime_error("no pseudo-terminal");
+            termios mode{};
+            ::tcgetattr(slave_, &mode);
+            ::cfmakeraw(&mode); // bytes as written , no newline translation
+            ::tcsetattr(slave_, TCSANOW, &mode);
+            winsize window{};
+            window.ws_col = static_cast<unsigned short>(screenSize.columns);
+            window.ws_row = static_cast<unsigned short>(screenSize.rows);
+            ::ioctl(master_, TIOCSWINSZ, &window);
+            drain_ = std::thread([this] { drain(); });
+        }
+        ~Pty()
+        {
+            stop_ = true;
+            drain_.join();
+            ::close(slave_);
+            ::close(master_);
+        }
+        int terminal() const noexcept
+        {
+            return slave_;
+        }
+        // Bytes received once the terminal has been quiet for a while
+        std::uint64_t settle()
+        {
+            for (auto last = received_.load();; )
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                auto now = received_.load();
+                if (now == last)
+                    return now;
+                last = now;
+            }
+        }
+
+    private:
+        void drain()
+        {
+            char buffer[1 << 16];
+            pollfd ready{master_, POLLIN, 0};
+            while (!stop_)
+                if (::poll(&ready, 1, 10) > 0)
+                    if (auto length = ::read(master_, buffer, sizeof(buffer)); length > 0)
+                        received_ += static_cast<std::uint64_t>(length);
+        }
+
+        int master_ = -1, slave_ = -1;
+        std::thread drain_;
+        std::atomic<bool> stop_{false};
+        std::atomic<std::uint64_t> received_{0};
+    };
+
+    // The numbers on screen , updated once per frame
+    struct Stats
+    {
+        std::uint64_t frame = 0;
+        double counters[8] = {1024, 3.5, 0, 17, 99.25, 2048, 7, 0.125};
+        char const *names[8] = {"connections", "load", "frame", "errors", "cpu %", "memory KiB", "threads", "ratio"};
+        LatencyHistogram latency;
+
+        void next()
+        {
+            ++frame;
+            counters[2] = static_cast<double>(frame);
+            counters[4] = 90 + static_cast<double>(frame % 100) / 10;
+            latency.record(200 + (frame * 7919) % 50000);
+        }
+    };
+
+    // The frame as plain lines , the way a Clear()-and-reprint display builds it
+    std::string plainFrame(Stats const &stats)
+    {
+        std::string text = " stats\n\n";
+        char line[128];
+        for (int i = 0; i < 8; ++i)
+        {
+            std::snprintf(line, sizeof(line), " %-20.20s %12.6g\n", stats.names[i], stats.counters[i]);
+            text += line;
+        }
+        std::snprintf(line, sizeof(line), "\n latency  count %llu  p50 %s  p99 %s\n", static_cast<unsigned long long>(stats.latency.count()),
+                      formatDuration(static_cast<double>(stats.latency.percentile(0.5))).c_str(),
+                      formatDuration(static_cast<double>(stats.latency.percentile(0.99))).c_str());
+        text += line;
+        for (int i = 0; i < LatencyHistogram::bucketCount; ++i)
+            if (auto count = stats.latency.bucket(i))
+            {
+                std::snprintf(line, sizeof(line), " <%-9s %-50.*s %10llu\n", formatDuration(static_cast<double>(LatencyHistogram::upperBound(i) + 1)).c_str(),
+                              static_cast<int>(std::min<std::uint64_t>(count * 50 / std::max<std::uint64_t>(stats.latency.count(), 1) + 1, 50)),
+                              "##################################################", static_cast<unsigned long long>(count));
+                text += line;
+            }
+        return text;
+    }
+
+    // Run frame() with the standard output on the pty , so that child processes write there too
+    template <typename Frame>
+    void onStandardOutput(TemplateCompleteGuide::benchmark::State &state, Pty &pty, Frame frame)
+    {
+        std::cout.flush();
+        auto saved = ::dup(1);
+        ::dup2(pty.terminal(), 1);
+        auto before = pty.settle();
+        for (auto _ : state)
+            frame();
+        std::cout.flush();
+        ::dup2(saved, 1);
+        ::close(saved);
+        state.setCounter("bytes_per_frame", static_cast<double>(pty.settle() - before) / static_cast<double>(state.iterations()));
+    }
+} // namespace
+
+TCG_BENCHMARK(TerminalFrame_ClearAndReprint)
+{
+    ::setenv("TERM", "xterm", 0);
+    Pty pty;
+    Stats stats;
+    state.setItemsPerIteration(1);
+    onStandardOutput(state, pty, [&]
+                     {
+                         stats.next();
+                         if (std::system("clear") != 0)
+                             throw std::runtime_error("clear failed");
+                         auto text = plainFrame(stats);
+                         TemplateCompleteGuide::chapter4::buffered::writeAll(1, text.data(), text.size());
+                     });
+}
+
+TCG_BENCHMARK(TerminalFrame_EscapeClearAndReprint)
+{
+    Pty pty;
+    Stats stats;
+    // Clear() goes through std::cout , which the driver sends to a null buffer while benchmarking
+    std::ofstream terminal;
+    state.setItemsPerIteration(1);
+    onStandardOutput(state, pty, [&]
+                     {
+                         stats.next();
+                         if (!terminal.is_open())
+                             terminal.open("/dev/fd/1"); // the pty , once it is the standard output
+                         auto previous = std::cout.rdbuf(terminal.rdbuf());
+                         Clear();
+                         std::cout.rdbuf(previous);
+                         auto text = plainFrame(stats);
+                         TemplateCompleteGuide::chapter4::buffered::writeAll(1, text.data(), text.size());
+                     });
+}
+
+TCG_BENCHMARK(TerminalFrame_Renderer)
+{
+    Pty pty;
+    Stats stats;
+    Renderer screen(pty.terminal());
+    Dashboard dashboard(screen, "stats");
+    auto &latency = dashboard.histogram("latency");
+    state.setItemsPerIteration(1);
+    auto before = screen.bytesWritten();
+    for (auto _ : state)
+    {
+        stats.next();
+        for (int i = 0; i < 8; ++i)
+            dashboard.counter(stats.names[i], stats.counters[i]);
+        latency.record(200 + (stats.frame * 7919) % 50000);
+        dashboard.render();
+    }
+    state.setCounter("bytes_per_frame", static_cast<double>(screen.bytesWritten() - before) / static_cast<double>(state.iterations()));
+}
@@ -0,0 +1,303 @@
+#include "benchmark.h"
+#include "../template_complete_guide.h"
+#include "../node_arena.h"
+#include "../batched_traverse.h"
+#include <random>
+
+/**
+ * traverse(root, left, right, left) over a forest , nodes scattered on the heap or laid out by NodeArena , and
+ * the life of one random tree of 1M nodes: build , full traversal and destruction , each timed on its own ,
+ * one new / delete per node against an arena released by reset().
+ */
+namespace
+{
+    using namespace TemplateCompleteGuide::chapter4::application;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+
+    constexpr std::size_t forestSize = 1 << 16;
+    constexpr std::size_t nodesPerTree = 4;
+
+    // Trees of the path left , right , left , whose nodes come from nodes in that order
+    std::vector<Node *> linkForest(std::vector<Node *> const &nodes)
+    {
+        std::vector<Node *> roots;
+        for (std::size_t i = 0; i + nodesPerTree <= nodes.size(); i += nodesPerTree)
+        {
+            auto root = nodes[i];
+            root->left = nodes[i + 1];
+            root->left->right = nodes[i + 2];
+            root->left->right->left = nodes[i + 3];
+            roots.push_back(root);
+        }
+        return roots;
+    }
+
+    // Nodes allocated one by one , then linked in random order as a long-lived heap ends up
+    struct ScatteredForest
+    {
+        std::vector<std::unique_ptr<Node>> storage;
+        std::vector<Node *> roots;
+
+        ScatteredForest()
+        {
+            std::vector<Node *> nodes;
+            for (std::size_t i = 0; i < forestSize * nodesPerTree; ++i)
+            {
+                storage.push_back(std::make_unique<Node>(static_cast<int>(i)));
+                nodes.push_back(storage.back().get());
+            }
+            std::shuffle(nodes.begin(), nodes.end(), std::mt19937(42));
+            roots = linkForest(nodes);
+        }
+    };
+
+    // Every tree in consecutive nodes of an arena
+    struct ArenaForest
+    {
+        NodeArena arena;
+        std::vector<Node *> roots;
+
+        ArenaForest()
+        {
+            std::vector<Node *> nodes;
+            for (std::size_t i = 0; i < forestSize * nodesPerTree; ++i)
+                nodes.push_back(arena.create(static_cast<int>(i)));
+            roots = linkForest(nodes);
+        }
+    };
+
+    template <typename Forest>
+    Forest const &forest()
+    {
+        static Forest instance;
+        return instance;
+    }
+
+    constexpr std::size_t randomTreeSize = 1 << 20;
+
+    // Preorder shape of the binary search tree of randomTreeSize shuffled keys , about 50 levels deep
+    std::vector<SerializedNode> const &randomShape()
+    {
+        static std::vector<SerializedNode> shape = []
+        {
+            std::vector<int> keys(randomTreeSize);
+            std::iota(keys.begin(), keys.end(), 0);
+            std::shuffle(keys.begin(), keys.end(), std::mt19937(11));
+            NodeArena arena;
+            Node *root = nullptr;
+            for (auto key : keys)
+            {
+                auto slot = &root;
+                while (*slot)
+                    slot = key < (*slot)->value ? &(*slot)->left : &(*slot)->right;
+                *slot = arena.create(key);
+            }
+            return serializeTree(root);
+        }();
+        return shape;
+    }
+
+    // buildTree with one new per node
+    Node *buildHeapTree(std::vector<SerializedNode> const &shape)
+    {
+        Node *root = nullptr;
+        std::vector<Node **> slots = {&root};
+        for (auto const &each : shape)
+        {
+            auto slot = slots.back();
+            slots.pop_back();
+            auto node = *slot = new Node(each.value);
+            if (each.children & SerializedNode::HasRight)
+                slots.push_back(&node->right);
+            if (each.children & SerializedNode::HasLeft)
+                slots.push_back(&node->left);
+        }
+        return root;
+    }
+    void destroyHeapTree(Node *node)
+    {
+        if (!node)
+            return;
+        destroyHeapTree(node->left);
+        destroyHeapTree(node->right);
+        delete node;
+    }
+
+    // Depth-first visit of every node
+    long long sumTree(Node const *root)
+    {
+        long long sum = 0;
+        std::vector<Node const *> pending = {root};
+        while (!pending.empty())
+        {
+            auto node = pending.back();
+            pending.pop_back();
+            sum += node->value;
+            if (node->right)
+                pending.push_back(node->right);
+            if (node->left)
+                pending.push_back(node->left);
+        }
+        return sum;
+    }
+} // namespace
+
+TCG_BENCHMARK(Traverse_Heap)
+{
+    auto const &roots = forest<ScatteredForest>().roots;
+    state.setItemsPerIteration(roots.size());
+    for (auto _ : state)
+        for (auto root : roots)
+            doNotOptimize(traverse(root, left, right, left));
+}
+
+TCG_BENCHMARK(Traverse_Arena)
+{
+    auto const &roots = forest<ArenaForest>().roots;
+    state.setItemsPerIteration(roots.size());
+    for (auto _ : state)
+        for (auto root : roots)
+            doNotOptimize(traverse(root, left, right, left));
+}
+
+TCG_BENCHMARK(TraverseBatch_Heap)
+{
+    auto const &roots = forest<ScatteredForest>().roots;
+    std::vector<Node *> found(roots.size());
+    state.setItemsPerIteration(roots.size());
+    for (auto _ : state)
+    {
+        traverseBatch(roots.begin(), roots.end(), found.begin(), left, right, left);
+        doNotOptimize(found.data());
+    }
+}
+
+TCG_BENCHMARK(TraverseBatch_Arena)
+{
+    auto const &roots = forest<ArenaForest>().roots;
+    std::vector<Node *> found(roots.size());
+    state.setItemsPerIteration(roots.size());
+    for (auto _ : state)
+    {
+        traverseBatch(roots.begin(), roots.end(), found.begin(), left, right, left);
+        doNotOptimize(found.data());
+    }
+}
+
+// Rebuilding a tree of 1023 nodes , one allocation per node against an arena reused across iterations
+TCG_BENCHMARK(BuildTree_New)
+{
+    std::vector<Node *> nodes(1023);
+    state.setItemsPerIteration(nodes.size());
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+            nodes[i] = new Node(static_cast<int>(i));
+        for (std::size_t i = 0; 2 * i + 2 < nodes.size(); ++i)
+        {
+            nodes[i]->left = nodes[2 * i + 1];
+            nodes[i]->right = nodes[2 * i + 2];
+        }
+        doNotOptimize(nodes[0]);
+        for (auto node : nodes)
+            delete node;
+    }
+}
+
+TCG_BENCHMARK(BuildTree_Arena)
+{
+    // Complete tree of 1023 nodes in preorder
+    std::vector<SerializedNode> shape;
+    auto describe = [&](auto &self, std::size_t index) -> void
+    {
+        if (index >= 1023)
+            return;
+        auto hasChildren = 2 * index + 2 < 1023;
+        shape.push_back({static_cast<int>(index), static_cast<std::uint8_t>(hasChildren ? SerializedNode::HasLeft | SerializedNode::HasRight : 0)});
+        self(self, 2 * index + 1);
+        self(self, 2 * index + 2);
+    };
+    describe(describe, 0);
+    NodeArena arena;
+    state.setItemsPerIteration(shape.size());
+    for (auto _ : state)
+    {
+        arena.reset();
+        doNotOptimize(buildTree(arena, shape.begin(), shape.end()));
+    }
+}
+
+TCG_BENCHMARK(RandomTreeBuild_Heap)
+{
+    auto const &shape = randomShape();
+    state.setItemsPerIteration(shape.size());
+    for (auto _ : state)
+    {
+        auto root = buildHeapTree(shape);
+        doNotOptimize(root);
+        state.pauseTiming();
+        destroyHeapTree(root);
+        state.resumeTiming();
+    }
+}
+
+TCG_BENCHMARK(RandomTreeBuild_Arena)
+{
+    auto const &shape = randomShape();
+    NodeArena arena;
+    state.setItemsPerIteration(shape.size());
+    for (auto _ : state)
+    {
+        doNotOptimize(buildTree(arena, shape.begin(), shape.end()));
+        state.pauseTiming();
+        arena.reset();
+        state.resumeTiming();
+    }
+}
+
+TCG_BENCHMARK(RandomTreeTraverse_Heap)
+{
+    auto const &shape = randomShape();
+    auto root = buildHeapTree(shape);
+    state.setItemsPerIteration(shape.size());
+    for (auto _ : state)
+        doNotOptimize(sumTree(root));
+    destroyHeapTree(root);
+}
+
+TCG_BENCHMARK(RandomTreeTraverse_Arena)
+{
+    auto const &shape = randomShape();
+    NodeArena arena;
+    auto root = buildTree(arena, shape.begin(), shape.end());
+    state.setItemsPerIteration(shape.size());
+    for (auto _ : state)
+        doNotOptimize(sumTree(root));
+}
+
+TCG_BENCHMARK(RandomTreeDestroy_Heap)
+{
+    auto const &shape = randomShape();
+    state.setItemsPerIteration(shape.size());
+    for (auto _ : state)
+    {
+        state.pauseTiming();
+        auto root = buildHeapTree(shape);
+        state.resumeTiming();
+        destroyHeapTree(root);
+    }
+}
+
+TCG_BENCHMARK(RandomTreeDestroy_Arena)
+{
+    auto const &shape = randomShape();
+    NodeArena arena;
+    state.setItemsPerIteration(shape.size());
+    for (auto _ : state)
+    {
+        state.pauseTiming();
+        doNotOptimize(buildTree(arena, shape.begin(), shape.end()));
+        state.resumeTiming();
+        arena.reset();
+    }
+}
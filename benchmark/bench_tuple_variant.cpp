@@ -0,0 +1,259 @@
+#include "benchmark.h"
+#include "../tuple_variant.h"
+#include <random>
+
+/**
+ * Tuple and Variant against std::tuple and std::variant: scan , visit , assignment , and copy / move construction
+ * of a whole vector , with a std::string among the fields or alternatives and without (_Trivial).
+ * NOTICE a std::variant of trivially copyable alternatives is itself trivially copyable , copied as plain bytes ,
+ * while Variant always jumps through its copy or move table
+ */
+namespace
+{
+    using namespace TemplateCompleteGuide::chapter4::variadicClassTemplates;
+    using TemplateCompleteGuide::benchmark::doNotOptimize;
+
+    constexpr std::size_t recordCount = 1 << 20;
+    constexpr std::size_t variantCount = 1 << 14;
+
+    // Records whose layout in declaration order wastes a third of their size in padding
+    template <typename Record>
+    void scanRecords(TemplateCompleteGuide::benchmark::State &state)
+    {
+        std::vector<Record> records(recordCount);
+        for (std::size_t i = 0; i < recordCount; ++i)
+            records[i] = Record(static_cast<char>(i), static_cast<double>(i), static_cast<char>(i >> 8));
+        state.setItemsPerIteration(recordCount);
+        state.setCounter("record_bytes", sizeof(Record));
+        for (auto _ : state)
+        {
+            double sum = 0;
+            for (auto const &record : records)
+            {
+                using std::get;
+                sum += get<1>(record) + get<0>(record) + get<2>(record);
+            }
+            doNotOptimize(sum);
+        }
+    }
+
+    struct Area
+    {
+        double operator()(int side) const
+        {
+            return static_cast<double>(side) * side;
+        }
+        double operator()(double radius) const
+        {
+            return 3.14159 * radius * radius;
+        }
+        double operator()(std::string const &name) const
+        {
+            return static_cast<double>(name.size());
+        }
+    };
+
+    // The third alternative is a std::string , or a float for the trivially copyable alternative sets
+    template <typename V>
+    std::vector<V> randomVariants()
+    {
+        std::mt19937 random(3);
+        std::vector<V> variants;
+        for (std::size_t i = 0; i < variantCount; ++i)
+        {
+            switch (random() % 3)
+            {
+            case 0:
+                variants.emplace_back(static_cast<int>(i));
+                break;
+            case 1:
+                variants.emplace_back(static_cast<double>(i));
+                break;
+            default:
+                if constexpr (std::is_constructible_v<V, std::string>)
+                    variants.emplace_back(std::string("shape"));
+                else
+                    variants.emplace_back(static_cast<float>(i));
+                break;
+            }
+        }
+        return variants;
+    }
+
+    template <typename Record>
+    std::vector<Record> someRecords()
+    {
+        std::vector<Record> records;
+        for (std::size_t i = 0; i < variantCount; ++i)
+        {
+            if constexpr (std::is_constructible_v<Record, char, std::string, double>)
+                records.emplace_back(static_cast<char>(i), std::string("shape"), static_cast<double>(i));
+            else
+                records.emplace_back(static_cast<char>(i), static_cast<double>(i), static_cast<char>(i >> 8));
+        }
+        return records;
+    }
+
+    // Copy-construct every element into a new vector
+    template <typename T>
+    void copyAll(TemplateCompleteGuide::benchmark::State &state, std::vector<T> const &source)
+    {
+        state.setItemsPerIteration(static_cast<double>(source.size()));
+        for (auto _ : state)
+        {
+            std::vector<T> copy(source.begin(), source.end());
+            doNotOptimize(copy.data());
+        }
+    }
+    // Move-construct every element into a new vector , back and forth between two vectors
+    template <typename T>
+    void moveAll(TemplateCompleteGuide::benchmark::State &state, std::vector<T> source)
+    {
+        state.setItemsPerIteration(static_cast<double>(source.size()));
+        for (auto _ : state)
+        {
+            std::vector<T> moved(std::make_move_iterator(source.begin()), std::make_move_iterator(source.end()));
+            doNotOptimize(moved.data());
+            source.swap(moved);
+        }
+    }
+
+    using StdVariant = std::variant<int, double, std::string>;
+    using TableVariant = Variant<int, double, std::string>;
+    using TrivialStdVariant = std::variant<int, double, float>;
+    using TrivialTableVariant = Variant<int, double, float>;
+} // namespace
+
+TCG_BENCHMARK(TupleScan_Std)
+{
+    scanRecords<std::tuple<char, double, char>>(state);
+}
+
+TCG_BENCHMARK(TupleScan_Packed)
+{
+    scanRecords<Tuple<char, double, char>>(state);
+}
+
+TCG_BENCHMARK(VariantVisit_Std)
+{
+    auto variants = randomVariants<std::variant<int, double, std::string>>();
+    state.setItemsPerIteration(variantCount);
+    state.setCounter("variant_bytes", sizeof(std::variant<int, double, std::string>));
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (auto const &each : variants)
+            sum += std::visit(Area{}, each);
+        doNotOptimize(sum);
+    }
+}
+
+TCG_BENCHMARK(VariantVisit_Table)
+{
+    auto variants = randomVariants<Variant<int, double, std::string>>();
+    state.setItemsPerIteration(variantCount);
+    state.setCounter("variant_bytes", sizeof(Variant<int, double, std::string>));
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (auto const &each : variants)
+            sum += visit(Area{}, each);
+        doNotOptimize(sum);
+    }
+}
+
+TCG_BENCHMARK(VariantAssign_Std)
+{
+    std::variant<int, double, std::string> value;
+    std::string text = "a string long enough to live on the heap";
+    for (auto _ : state)
+    {
+        value = 1;
+        value = text;
+        value = 2.5;
+        doNotOptimize(value);
+    }
+}
+
+TCG_BENCHMARK(VariantAssign_Table)
+{
+    Variant<int, double, std::string> value;
+    std::string text = "a string long enough to live on the heap";
+    for (auto _ : state)
+    {
+        value = 1;
+        value = text;
+        value = 2.5;
+        doNotOptimize(value);
+    }
+}
+
+TCG_BENCHMARK(TupleCopy_Std)
+{
+    copyAll(state, someRecords<std::tuple<char, std::string, double>>());
+}
+
+TCG_BENCHMARK(TupleCopy_Packed)
+{
+    copyAll(state, someRecords<Tuple<char, std::string, double>>());
+}
+
+TCG_BENCHMARK(TupleMove_Std)
+{
+    moveAll(state, someRecords<std::tuple<char, std::string, double>>());
+}
+
+TCG_BENCHMARK(TupleMove_Packed)
+{
+    moveAll(state, someRecords<Tuple<char, std::string, double>>());
+}
+
+TCG_BENCHMARK(TupleCopyTrivial_Std)
+{
+    copyAll(state, someRecords<std::tuple<char, double, char>>());
+}
+
+TCG_BENCHMARK(TupleCopyTrivial_Packed)
+{
+    copyAll(state, someRecords<Tuple<char, double, char>>());
+}
+
+TCG_BENCHMARK(VariantCopy_Std)
+{
+    copyAll(state, randomVariants<StdVariant>());
+}
+
+TCG_BENCHMARK(VariantCopy_Table)
+{
+    copyAll(state, randomVariants<TableVariant>());
+}
+
+TCG_BENCHMARK(VariantMove_Std)
+{
+    moveAll(state, randomVariants<StdVariant>());
+}
+
+TCG_BENCHMARK(VariantMove_Table)
+{
+    moveAll(state, randomVariants<TableVariant>());
+}
+
+TCG_BENCHMARK(VariantCopyTrivial_Std)
+{
+    copyAll(state, randomVariants<TrivialStdVariant>());
+}
+
+TCG_BENCHMARK(VariantCopyTrivial_Table)
+{
+    copyAll(state, randomVariants<TrivialTableVariant>());
+}
+
+TCG_BENCHMARK(VariantMoveTrivial_Std)
+{
+    moveAll(state, randomVariants<TrivialStdVariant>());
+}
+
+TCG_BENCHMARK(VariantMoveTrivial_Table)
+{
+    moveAll(state, randomVariants<TrivialTableVariant>());
+}
@@ -0,0 +1,418 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#pragma once
+
+#include "../std.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <numeric>
+
+/**
+ * Minimal self-contained microbenchmark harness
+ *
+ *  TCG_BENCHMARK(Stack_PushPop)
+ *  {
+ *      Stack<int> stack;              // setup , not timed
+ *      for (auto _ : state)           // timed loop , state.iterations() times
+ *      {
+ *          stack.push(1);
+ *          stack.pop();
+ *      }
+ *  }
+ *  TCG_BENCHMARK_ARGS(Reduce_Level, 0, 1, 2) { ... state.arg() ... } // registered as Reduce_Level/0 , /1 , /2
+ *
+ * state.pauseTiming() / state.resumeTiming() leave a part of the iteration out of the time and the allocations ,
+ * e.g. the destruction of what the iteration built.
+ *
+ * The iteration count of a sample is calibrated so that a sample lasts at least minSampleTime , the benchmark
+ * is warmed up , then timed over several samples , reported as median , p99 , mean and standard deviation
+ * of the time per iteration. Heap allocations made inside the timed loop are counted too (allocs/op).
+ */
+namespace TemplateCompleteGuide
+{
+    namespace benchmark
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Incremented by the replaced global operator new of the benchmark driver
+        inline std::atomic<std::uint64_t> allocationCounter{0};
+
+        // Discards what is written to it , for the benchmarks writing to a real device
+#if defined _WIN32
+        constexpr char const *nullDevice = "NUL";
+#else
+        constexpr char const *nullDevice = "/dev/null";
+#endif
+
+        // NOTE 1. Optimization barriers: the compiler shall assume value is read (and written) by unknown code
+        template <typename T>
+        inline void doNotOptimize(T const &value)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void *))
+                asm volatile("" : : "r,m"(value) : "memory");
+            else
+                asm volatile("" : : "m"(value) : "memory");
+#else
+            auto volatile sink = reinterpret_cast<char const volatile *>(&value);
+            (void)sink;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+        }
+        template <typename T>
+        inline void doNotOptimize(T &value)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void *))
+                asm volatile("" : "+m,r"(value) : : "memory");
+            else
+                asm volatile("" : "+m"(value) : : "memory");
+#else
+            doNotOptimize(static_cast<T const &>(value));
+#endif
+        }
+        // Every pending write to memory shall be performed
+        inline void clobberMemory()
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            asm volatile("" : : : "memory");
+#else
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+        }
+
+        // NOTE 2. State of one run: the timed loop , its argument and what it reports
+        class State
+        {
+        public:
+            // The _ of for (auto _ : state) , never read: no unused variable warning for it
+            struct [[maybe_unused]] Ignored
+            {
+            };
+            class Iterator
+            {
+            public:
+                Iterator(State *state, std::uint64_t remaining) noexcept : state_(state), remaining_(remaining)
+                {
+                }
+                Ignored operator*() const noexcept
+                {
+                    return {};
+                }
+                Iterator &operator++() noexcept
+                {
+                    --remaining_;
+                    return *this;
+                }
+                // The loop ends here , so this is where the clock stops
+                bool operator!=(Iterator const &) noexcept
+                {
+                    if (remaining_ != 0)
+                        return true;
+                    state_->stop();
+                    return false;
+                }
+
+            private:
+                State *state_;
+                std::uint64_t remaining_;
+            };
+
+            State(std::uint64_t iterations, std::int64_t arg) noexcept : iterations_(iterations), arg_(arg)
+            {
+            }
+
+            Iterator begin() noexcept
+            {
+                resumeTiming();
+                return {this, iterations_};
+            }
+            Iterator end() noexcept
+            {
+                return {this, 0};
+            }
+
+            std::uint64_t iterations() const noexcept
+            {
+                return iterations_;
+            }
+            std::int64_t arg() const noexcept
+            {
+                return arg_;
+            }
+            // Items (elements , rows , bytes...) handled by one iteration , reported as items per second
+            void setItemsPerIteration(double items) noexcept
+            {
+                itemsPerIteration_ = items;
+            }
+            // Bytes read and written by one iteration , reported as bytes per second
+            void setBytesPerIteration(double bytes) noexcept
+            {
+                bytesPerIteration_ = bytes;
+            }
+            // Any other figure worth keeping next to the timings , averaged over the samples
+            void setCounter(std::string const &name, double value)
+            {
+                counters_[name] = value;
+            }
+
+            void pauseTiming() noexcept
+            {
+                elapsed_ += Clock::now() - start_;
+                allocations_ += allocationCounter.load(std::memory_order_relaxed) - allocationsStart_;
+            }
+            void resumeTiming() noexcept
+            {
+                allocationsStart_ = allocationCounter.load(std::memory_order_relaxed);
+                start_ = Clock::now();
+            }
+
+            std::chrono::nanoseconds elapsed() const noexcept
+            {
+                return elapsed_;
+            }
+            std::uint64_t allocations() const noexcept
+            {
+                return allocations_;
+            }
+            double itemsPerIteration() const noexcept
+            {
+                return itemsPerIteration_;
+            }
+            double bytesPerIteration() const noexcept
+            {
+                return bytesPerIteration_;
+            }
+            std::map<std::string, double> const &counters() const noexcept
+            {
+                return counters_;
+            }
+
+        private:
+            void stop() noexcept
+            {
+                pauseTiming();
+            }
+
+            std::uint64_t iterations_;
+            std::int64_t arg_;
+            Clock::time_point start_;
+            std::chrono::nanoseconds elapsed_{0};
+            std::uint64_t allocations_ = 0;
+            std::uint64_t allocationsStart_ = 0;
+            double itemsPerIteration_ = 0;
+            double bytesPerIteration_ = 0;
+            std::map<std::string, double> counters_;
+        };
+
+        // NOTE 3. Registry filled by the TCG_BENCHMARK macros before main
+        struct Benchmark
+        {
+            std::string name;
+            void (*function)(State &);
+            std::int64_t arg;
+        };
+        inline std::vector<Benchmark> &registry()
+        {
+            static std::vector<Benchmark> benchmarks;
+            return benchmarks;
+        }
+        struct Registrar
+        {
+            Registrar(char const *name, void (*function)(State &))
+            {
+                registry().push_back({name, function, 0});
+            }
+            Registrar(char const *name, void (*function)(State &), std::initializer_list<std::int64_t> args)
+            {
+                for (auto arg : args)
+                    registry().push_back({std::string(name) + "/" + std::to_string(arg), function, arg});
+            }
+        };
+
+#define TCG_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define TCG_BENCHMARK_CONCAT(a, b) TCG_BENCHMARK_CONCAT_IMPL(a, b)
+#define TCG_BENCHMARK(function)                                                                                                              \
+    static void function(::TemplateCompleteGuide::benchmark::State &);                                                                       \
+    static ::TemplateCompleteGuide::benchmark::Registrar TCG_BENCHMARK_CONCAT(benchmarkRegistrar, __LINE__)(#function, function); \
+    static void function([[maybe_unused]] ::TemplateCompleteGuide::benchmark::State &state)
+#define TCG_BENCHMARK_ARGS(function, ...)                                                                                                    \
+    static void function(::TemplateCompleteGuide::benchmark::State &);                                                                       \
+    static ::TemplateCompleteGuide::benchmark::Registrar TCG_BENCHMARK_CONCAT(benchmarkRegistrar, __LINE__)(#function, function, {__VA_ARGS__}); \
+    static void function([[maybe_unused]] ::TemplateCompleteGuide::benchmark::State &state)
+
+        // NOTE 4. Running and reporting
+        struct Settings
+        {
+            std::chrono::nanoseconds minSampleTime = std::chrono::milliseconds(10);
+            std::chrono::nanoseconds warmupTime = std::chrono::milliseconds(50);
+            std::size_t samples = 25;
+        };
+
+        struct Result
+        {
+            std::string name;
+            std::uint64_t iterations = 0; // per sample
+            std::size_t samples = 0;
+            double medianNs = 0, p99Ns = 0, meanNs = 0, stddevNs = 0, minNs = 0; // per iteration
+            double allocationsPerIteration = 0;
+            double itemsPerSecond = 0;
+            double bytesPerSecond = 0;
+            std::map<std::string, double> counters;
+        };
+
+        inline State runOnce(Benchmark const &benchmark, std::uint64_t iterations)
+        {
+            State state(iterations, benchmark.arg);
+            benchmark.function(state);
+            return state;
+        }
+
+        inline Result run(Benchmark const &benchmark, Settings const &settings)
+        {
+            // Calibration: grow the iteration count until a sample lasts minSampleTime , or until it takes ten times
+            // that in wall time , when most of the iteration is paused
+            std::uint64_t iterations = 1;
+            for (;;)
+            {
+                auto wallStart = Clock::now();
+                auto elapsed = runOnce(benchmark, iterations).elapsed();
+                if (elapsed >= settings.minSampleTime || Clock::now() - wallStart >= 10 * settings.minSampleTime ||
+                    iterations >= (std::uint64_t(1) << 40))
+                    break;
+                auto ratio = elapsed.count() > 0 ? 1.4 * settings.minSampleTime.count() / elapsed.count() : 10.0;
+                iterations = static_cast<std::uint64_t>(iterations * std::clamp(ratio, 1.5, 10.0)) + 1;
+            }
+            for (auto start = Clock::now(); Clock::now() - start < settings.warmupTime;)
+                runOnce(benchmark, iterations);
+
+            Result result;
+            result.name = benchmark.name;
+            result.iterations = iterations;
+            result.samples = std::max<std::size_t>(settings.samples, 1);
+            std::vector<double> perIteration;
+            std::uint64_t allocations = 0;
+            double items = 0, bytes = 0, seconds = 0;
+            for (std::size_t i = 0; i < result.samples; ++i)
+            {
+                auto state = runOnce(benchmark, iterations);
+                auto ns = static_cast<double>(state.elapsed().count());
+                perIteration.push_back(ns / iterations);
+                allocations += state.allocations();
+                items += state.itemsPerIteration() * iterations;
+                bytes += state.bytesPerIteration() * iterations;
+                seconds += ns * 1e-9;
+                for (auto const &[name, value] : state.counters())
+                    result.counters[name] += value / result.samples;
+            }
+
+            std::sort(perIteration.begin(), perIteration.end());
+            auto n = perIteration.size();
+            result.medianNs = n % 2 ? perIteration[n / 2] : (perIteration[n / 2 - 1] + perIteration[n / 2]) / 2;
+            result.p99Ns = perIteration[static_cast<std::size_t>(std::ceil(0.99 * n)) - 1]; // nearest rank
+            result.minNs = perIteration.front();
+            result.meanNs = std::accumulate(perIteration.begin(), perIteration.end(), 0.0) / n;
+            double squares = 0;
+            for (auto each : perIteration)
+                squares += (each - result.meanNs) * (each - result.meanNs);
+            result.stddevNs = n > 1 ? std::sqrt(squares / (n - 1)) : 0;
+            result.allocationsPerIteration = static_cast<double>(allocations) / (static_cast<double>(iterations) * n);
+            result.itemsPerSecond = seconds > 0 ? items / seconds : 0;
+            result.bytesPerSecond = seconds > 0 ? bytes / seconds : 0;
+            return result;
+        }
+
+        inline std::string jsonEscape(std::string const &text)
+        {
+            std::string escaped;
+            for (auto c : text)
+            {
+                if (c == '"' || c == '\\')
+                    escaped += '\\';
+                escaped += c;
+            }
+            return escaped;
+        }
+
+        inline void writeJson(std::ostream &os, std::vector<Result> const &results, std::map<std::string, std::string> const &context)
+        {
+            os << "{\n  \"context\": {";
+            char const *separator = "";
+            for (auto const &[key, value] : context)
+            {
+                os << separator << "\n    \"" << jsonEscape(key) << "\": \"" << jsonEscape(value) << '"';
+                separator = ",";
+            }
+            os << "\n  },\n  \"benchmarks\": [";
+            separator = "";
+            for (auto const &each : results)
+            {
+                os << separator << "\n    {\"name\": \"" << jsonEscape(each.name) << "\", \"iterations\": " << each.iterations
+                   << ", \"samples\": " << each.samples << ", \"median_ns\": " << each.medianNs << ", \"p99_ns\": " << each.p99Ns
+                   << ", \"mean_ns\": " << each.meanNs << ", \"stddev_ns\": " << each.stddevNs << ", \"min_ns\": " << each.minNs
+                   << ", \"allocs_per_op\": " << each.allocationsPerIteration << ", \"items_per_second\": " << each.itemsPerSecond
+                   << ", \"bytes_per_second\": " << each.bytesPerSecond;
+                for (auto const &[name, value] : each.counters)
+                    os << ", \"" << jsonEscape(name) << "\": " << value;
+                os << '}';
+                separator = ",";
+            }
+            os << "\n  ]\n}\n";
+        }
+
+        // Counters are written as name=value pairs in the last column , so that every row has the same columns
+        inline void writeCsv(std::ostream &os, std::vector<Result> const &results)
+        {
+            os << "name,iterations,samples,median_ns,p99_ns,mean_ns,stddev_ns,min_ns,allocs_per_op,items_per_second,bytes_per_second,counters\n";
+            for (auto const &each : results)
+            {
+                os << '"' << each.name << "\"," << each.iterations << ',' << each.samples << ',' << each.medianNs << ',' << each.p99Ns << ','
+                   << each.meanNs << ',' << each.stddevNs << ',' << each.minNs << ',' << each.allocationsPerIteration << ','
+                   << each.itemsPerSecond << ',' << each.bytesPerSecond << ",\"";
+                char const *separator = "";
+                for (auto const &[name, value] : each.counters)
+                {
+                    os << separator << name << '=' << value;
+                    separator = ";";
+                }
+                os << "\"\n";
+            }
+        }
+
+        inline void writeConsole(std::ostream &os, Result const &result)
+        {
+            char line[256];
+            std::snprintf(line, sizeof(line), "%-48s %12.2f %12.2f %10.2f %10.3f", result.name.c_str(), result.medianNs, result.p99Ns,
+                          result.stddevNs, result.allocationsPerIteration);
+            os << line;
+            if (result.itemsPerSecond > 0)
+            {
+                std::snprintf(line, sizeof(line), " %10.1fM items/s", result.itemsPerSecond * 1e-6);
+                os << line;
+            }
+            if (result.bytesPerSecond > 0)
+            {
+                std::snprintf(line, sizeof(line), " %8.2f GB/s", result.bytesPerSecond * 1e-9);
+                os << line;
+            }
+            for (auto const &[name, value] : result.counters)
+                os << ' ' << name << '=' << value;
+            os << std::endl;
+        }
+        inline void writeConsoleHeader(std::ostream &os)
+        {
+            char line[256];
+            std::snprintf(line, sizeof(line), "%-48s %12s %12s %10s %10s", "benchmark", "median ns", "p99 ns", "stddev", "allocs/op");
+            os << line << '\n'
+               << std::string(96, '-') << std::endl;
+        }
+
+    } // namespace benchmark
+
+} // namespace TemplateCompleteGuide
+
+#endif
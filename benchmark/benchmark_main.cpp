@@ -0,0 +1,243 @@
+#include "benchmark.h"
+#include "../platform.h"
+#include <fstream>
+#include <regex>
+
+/**
+ * Driver of the benchmarks registered by the other translation units
+ *
+ *  benchmarks [--filter=<regex>] [--format=console|json|csv] [--out=<file>]
+ *             [--samples=<n>] [--min-sample-ms=<ms>] [--warmup-ms=<ms>] [--list]
+ *
+ * std::cout is redirected to a null buffer while the benchmarks run , so that the print variants measure
+ * formatting and not the terminal. The report is written to the real standard output or to --out.
+ */
+
+#if defined _WIN32
+#include <malloc.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TCG_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define TCG_NOINLINE __declspec(noinline)
+#else
+#define TCG_NOINLINE
+#endif
+
+namespace
+{
+    // std::aligned_alloc is missing from MSVC , whose aligned blocks are freed by _aligned_free
+    void *alignedAllocate(std::size_t align, std::size_t size) noexcept
+    {
+#if defined _WIN32
+        return _aligned_malloc(size, align);
+#else
+        return std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+    }
+    /**
+     * NOTICE the blocks are freed out of line: once free is inlined into operator delete , GCC 12 pairs it with
+     * the new expressions of the standard library and reports -Wmismatched-new-delete
+     */
+    TCG_NOINLINE void plainFree(void *memory) noexcept
+    {
+        std::free(memory);
+    }
+    TCG_NOINLINE void alignedFree(void *memory) noexcept
+    {
+#if defined _WIN32
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+} // namespace
+
+// Count every heap allocation , reported as allocs/op
+void *operator new(std::size_t size)
+{
+    TemplateCompleteGuide::benchmark::allocationCounter.fetch_add(1, std::memory_order_relaxed);
+    if (auto memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    TemplateCompleteGuide::benchmark::allocationCounter.fetch_add(1, std::memory_order_relaxed);
+    auto align = static_cast<std::size_t>(alignment);
+    if (auto memory = alignedAllocate(align, size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return ::operator new(size, alignment);
+}
+void operator delete(void *memory, std::align_val_t) noexcept
+{
+    alignedFree(memory);
+}
+void operator delete(void *memory) noexcept
+{
+    plainFree(memory);
+}
+// The other forms forward to the two above , which alone pair malloc with free for the compiler
+void operator delete[](void *memory, std::align_val_t alignment) noexcept
+{
+    ::operator delete(memory, alignment);
+}
+void operator delete(void *memory, std::size_t, std::align_val_t alignment) noexcept
+{
+    ::operator delete(memory, alignment);
+}
+void operator delete[](void *memory, std::size_t, std::align_val_t alignment) noexcept
+{
+    ::operator delete(memory, alignment);
+}
+void operator delete[](void *memory) noexcept
+{
+    ::operator delete(memory);
+}
+void operator delete(void *memory, std::size_t) noexcept
+{
+    ::operator delete(memory);
+}
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    ::operator delete(memory);
+}
+
+namespace
+{
+    using namespace TemplateCompleteGuide::benchmark;
+
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override
+        {
+            return traits_type::not_eof(c);
+        }
+        std::streamsize xsputn(char const *, std::streamsize count) override
+        {
+            return count;
+        }
+    };
+
+    char const *simdLevelName(TemplateCompleteGuide::platform::SimdLevel level)
+    {
+        switch (level)
+        {
+        case TemplateCompleteGuide::platform::SimdLevel::AVX512:
+            return "avx512";
+        case TemplateCompleteGuide::platform::SimdLevel::AVX2:
+            return "avx2";
+        case TemplateCompleteGuide::platform::SimdLevel::SSE2:
+            return "sse2";
+        default:
+            return "scalar";
+        }
+    }
+
+    bool option(std::string const &argument, char const *name, std::string &value)
+    {
+        auto prefix = std::string("--") + name + "=";
+        if (argument.compare(0, prefix.size(), prefix) != 0)
+            return false;
+        value = argument.substr(prefix.size());
+        return true;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Settings settings;
+    std::string filter = ".*", format = "console", out, value;
+    bool list = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (option(argument, "filter", value))
+            filter = value;
+        else if (option(argument, "format", value))
+            format = value;
+        else if (option(argument, "out", value))
+            out = value;
+        else if (option(argument, "samples", value))
+            settings.samples = std::stoul(value);
+        else if (option(argument, "min-sample-ms", value))
+            settings.minSampleTime = std::chrono::microseconds(static_cast<std::int64_t>(std::stod(value) * 1000));
+        else if (option(argument, "warmup-ms", value))
+            settings.warmupTime = std::chrono::microseconds(static_cast<std::int64_t>(std::stod(value) * 1000));
+        else if (argument == "--list")
+            list = true;
+        else
+        {
+            std::cerr << "unknown argument " << argument << "\nusage: " << argv[0]
+                      << " [--filter=<regex>] [--format=console|json|csv] [--out=<file>] [--samples=<n>]"
+                         " [--min-sample-ms=<ms>] [--warmup-ms=<ms>] [--list]\n";
+            return 2;
+        }
+    }
+    if (format != "console" && format != "json" && format != "csv")
+    {
+        std::cerr << "unknown format " << format << '\n';
+        return 2;
+    }
+
+    std::regex pattern(filter);
+    std::vector<Benchmark const *> selected;
+    for (auto const &benchmark : registry())
+        if (std::regex_search(benchmark.name, pattern))
+            selected.push_back(&benchmark);
+    std::sort(selected.begin(), selected.end(), [](auto lhs, auto rhs) { return lhs->name < rhs->name; });
+
+    std::ofstream file;
+    if (!out.empty())
+    {
+        file.open(out);
+        if (!file)
+        {
+            std::cerr << "cannot open " << out << '\n';
+            return 1;
+        }
+    }
+    std::ostream report(out.empty() ? std::cout.rdbuf() : file.rdbuf());
+    if (list)
+    {
+        for (auto each : selected)
+            report << each->name << '\n';
+        return 0;
+    }
+
+    NullBuffer null;
+    auto console = std::cout.rdbuf(&null);
+    std::vector<Result> results;
+    if (format == "console")
+        writeConsoleHeader(report);
+    for (auto each : selected)
+    {
+        results.push_back(run(*each, settings));
+        if (format == "console")
+            writeConsole(report, results.back());
+    }
+    std::cout.rdbuf(console);
+
+    if (format == "json")
+        writeJson(report, results, {{"simd_level", simdLevelName(TemplateCompleteGuide::platform::simdLevel())},
+                                    {"samples", std::to_string(settings.samples)},
+#if defined(NDEBUG)
+                                    {"assertions", "off"}
+#else
+                                    {"assertions", "on"}
+#endif
+                                   });
+    else if (format == "csv")
+        writeCsv(report, results);
+    return 0;
+}
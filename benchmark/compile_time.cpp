@@ -0,0 +1,489 @@
+#include "benchmark.h"
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <regex>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * Compile-time benchmarks of the variadic templates
+ *
+ *  compile_benchmarks [--filter=<regex>] [--format=console|json|csv] [--out=<file>] [--work-dir=<dir>]
+ *                     [--sizes=10,100,500] [--flags="<compiler flags>"]
+ *
+ * Every case is a generated translation unit calling one variadic function template of the header with a
+ * pack of N arguments , written in one of three forms:
+ *  - recursive       the former header implementation , one instantiation per suffix of the pack
+ *  - fold            the current header implementation , a fold expression
+ *  - index_sequence  the arguments forwarded as a tuple and expanded by std::get<I>
+ * plus Tuple / Variant of N distinct types against std::tuple / std::variant , and chapter3::greeting<msg , times>
+ * for large times: the static buffer of the header against the former loop.
+ *
+ * Each unit is compiled in a child process , reported with its wall time , the CPU time and the peak memory
+ * of the compiler (from wait4) , the number of symbols defined by the object file (nm) , which the
+ * instantiations dominate , and the size of its sections (size: text + data + bss). The "header" cases measure the include alone , the offset of every other case.
+ * With Clang , -ftime-trace is added and the InstantiateFunction / InstantiateClass events are counted too.
+ * A unit that does not compile (the index_sequence form of 500 exceeds the template depth of GCC in the
+ * constraints of std::tuple) is reported as failed , the diagnostics are left in <work-dir>/<case>.log.
+ */
+namespace
+{
+    using TemplateCompleteGuide::benchmark::jsonEscape;
+
+    struct Case
+    {
+        std::string name; // e.g. print/fold/100
+        std::string source;
+    };
+
+    struct Measure
+    {
+        std::string name;
+        bool compiled = false;
+        double wallSeconds = 0, cpuSeconds = 0;
+        long peakKiB = 0;
+        long symbols = -1;        // symbols defined by the object file
+        long bytes = -1;          // text + data + bss of the object file
+        long instantiations = -1; // from the Clang time trace , -1 without one
+    };
+
+    // Arguments of the generated calls: int , double , std::string and string literal in turn
+    std::string arguments(std::size_t count)
+    {
+        std::ostringstream os;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (i)
+                os << ", ";
+            switch (i % 4)
+            {
+            case 0:
+                os << i;
+                break;
+            case 1:
+                os << i << ".5";
+                break;
+            case 2:
+                os << "std::string(\"s" << i << "\")";
+                break;
+            default:
+                os << "\"c" << i << "\"";
+                break;
+            }
+        }
+        return os.str();
+    }
+
+    // The recursive forms as they were in template_complete_guide.h , and the index_sequence forms
+    char const *referenceForms = R"(namespace reference
+{
+    namespace recursive
+    {
+        inline void print()
+        {
+            std::cout << std::endl;
+        }
+        template <typename T, typename... Types>
+        void print(T firstArg, Types... args)
+        {
+            std::cout << firstArg;
+            print(args...);
+        }
+        inline auto printHelper()
+        {
+        }
+        template <typename T, typename... Ts>
+        auto printHelper(const T &arg0, const Ts &...args)
+        {
+            std::cout << arg0;
+            printHelper(args...);
+        }
+        inline auto detailedPrint()
+        {
+        }
+        template <typename T, typename... Ts>
+        auto detailedPrint(T const &arg, Ts const &...args)
+        {
+            std::cout << "Calling generic printer:" << "\n\btype:" << typeid(arg).name() << "\n\bvalue:" << arg << std::endl;
+            detailedPrint(args...);
+        }
+        template <typename... T>
+        auto detailedPrint(int arg, T const &...args)
+        {
+            std::cout << "Calling int printer: " << arg << std::endl;
+            detailedPrint(args...);
+        }
+        template <typename... T>
+        auto detailedPrint(double arg, T const &...args)
+        {
+            std::cout << "Calling double printer: " << arg << std::endl;
+            detailedPrint(args...);
+        }
+        template <typename... T>
+        auto detailedPrint(const std::string &arg, T const &...args)
+        {
+            std::cout << "Calling string printer: " << arg << std::endl;
+            detailedPrint(args...);
+        }
+    }
+    namespace loop
+    {
+        template <auto Msg, int times>
+        void greeting()
+        {
+            for (auto i = 0; i < times; i++)
+                std::cout << " Hello " << Msg << std::endl;
+        }
+    }
+    namespace index_sequence
+    {
+        template <typename Tuple, std::size_t... I>
+        void printIndexed(Tuple const &args, std::index_sequence<I...>)
+        {
+            (std::cout << ... << std::get<I>(args)) << std::endl;
+        }
+        template <typename... Ts>
+        void print(Ts const &...args)
+        {
+            printIndexed(std::forward_as_tuple(args...), std::index_sequence_for<Ts...>());
+        }
+        template <typename Tuple, std::size_t... I>
+        void printHelperIndexed(Tuple const &args, std::index_sequence<I...>)
+        {
+            (std::cout << ... << std::get<I>(args));
+        }
+        template <typename... Ts>
+        void printHelper(Ts const &...args)
+        {
+            printHelperIndexed(std::forward_as_tuple(args...), std::index_sequence_for<Ts...>());
+        }
+        template <typename Tuple, std::size_t... I>
+        void detailedPrintIndexed(Tuple const &args, std::index_sequence<I...>)
+        {
+            using TemplateCompleteGuide::chapter4::overload::preferred::detailedPrintArg;
+            (detailedPrintArg(std::get<I>(args)), ...);
+        }
+        template <typename... Ts>
+        void detailedPrint(Ts const &...args)
+        {
+            detailedPrintIndexed(std::forward_as_tuple(args...), std::index_sequence_for<Ts...>());
+        }
+    }
+}
+)";
+
+    std::vector<Case> printCases(std::vector<std::size_t> const &sizes)
+    {
+        struct Function
+        {
+            char const *name;
+            char const *header; // qualified name of the header version
+        };
+        Function const functions[] = {{"print", "TemplateCompleteGuide::chapter4::print"},
+                                      {"printHelper", "TemplateCompleteGuide::chapter4::printHelper"},
+                                      {"detailedPrint", "TemplateCompleteGuide::chapter4::overload::preferred::detailedPrint"}};
+        std::vector<Case> cases;
+        for (auto const &function : functions)
+        {
+            for (auto size : sizes)
+            {
+                for (std::string form : {"recursive", "fold", "index_sequence"})
+                {
+                    std::ostringstream source;
+                    source << "#include \"template_complete_guide.h\"\n\n"
+                           << referenceForms << "\nint main()\n{\n    "
+                           << (form == "fold" ? std::string(function.header) : "reference::" + form + "::" + function.name) << '('
+                           << arguments(size) << ");\n}\n";
+                    cases.push_back({std::string(function.name) + "/" + form + "/" + std::to_string(size), source.str()});
+                }
+            }
+        }
+        return cases;
+    }
+
+    // Tuple / Variant of count distinct field types , every element accessed or visited
+    std::vector<Case> tupleVariantCases(std::vector<std::size_t> const &counts)
+    {
+        std::vector<Case> cases;
+        for (auto count : counts)
+        {
+            std::ostringstream types, gets;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                types << (i ? ", " : "") << "Field<" << i << '>';
+                gets << "    sum += get<" << i << ">(tuple).value;\n";
+            }
+            struct Form
+            {
+                char const *name, *tuple, *variant, *visit;
+            };
+            for (Form form : {Form{"Tuple", "Tuple", "Variant", "visit"}, Form{"std::tuple", "std::tuple", "std::variant", "std::visit"}})
+            {
+                std::ostringstream source;
+                source << "#include \"tuple_variant.h\"\n\n"
+                       << "template <int k>\nstruct Field\n{\n    int value = k;\n};\n\n"
+                       << "int main()\n{\n    using namespace TemplateCompleteGuide::chapter4::variadicClassTemplates;\n"
+                       << "    using std::get;\n"
+                       << "    " << form.tuple << '<' << types.str() << "> tuple;\n"
+                       << "    " << form.variant << '<' << types.str() << "> variant;\n"
+                       << "    int sum = " << form.visit << "([](auto const &field) { return field.value; }, variant);\n"
+                       << gets.str() << "    return sum;\n}\n";
+                cases.push_back({std::string(form.name) + "+" + form.variant + "/" + std::to_string(count), source.str()});
+            }
+        }
+        return cases;
+    }
+
+    // greeting<msg , times> , the former loop against the static buffer of the header
+    std::vector<Case> greetingCases(std::vector<int> const &counts)
+    {
+        std::vector<Case> cases;
+        for (auto times : counts)
+        {
+            for (std::string form : {"loop", "static"})
+            {
+                std::ostringstream source;
+                source << "#include \"template_complete_guide.h\"\n\n"
+                       << referenceForms << "\nstatic constexpr char msg[] = \"World\";\n\nint main()\n{\n    "
+                       << (form == "static" ? "TemplateCompleteGuide::chapter3::greeting" : "reference::loop::greeting") << "<msg, "
+                       << times << ">();\n}\n";
+                cases.push_back({"greeting/" + form + "/" + std::to_string(times), source.str()});
+            }
+        }
+        return cases;
+    }
+
+    std::vector<Case> headerCases()
+    {
+        return {{"header/template_complete_guide.h", "#include \"template_complete_guide.h\"\n\nint main()\n{\n}\n"},
+                {"header/tuple_variant.h", "#include \"tuple_variant.h\"\n\nint main()\n{\n}\n"}};
+    }
+
+    std::vector<std::string> split(std::string const &text)
+    {
+        std::istringstream is(text);
+        std::vector<std::string> words;
+        for (std::string word; is >> word;)
+            words.push_back(word);
+        return words;
+    }
+
+    // Run a command , return its exit status and fill the resources it used
+    int run(std::vector<std::string> const &command, rusage &usage, std::string const &outputFile = "", std::string const &errorFile = "")
+    {
+        std::vector<char *> argv;
+        for (auto const &each : command)
+            argv.push_back(const_cast<char *>(each.c_str()));
+        argv.push_back(nullptr);
+        auto pid = ::fork();
+        if (pid < 0)
+            return -1;
+        if (pid == 0)
+        {
+            if (!outputFile.empty())
+                if (!std::freopen(outputFile.c_str(), "w", stdout))
+                    ::_exit(127);
+            if (!errorFile.empty())
+                if (!std::freopen(errorFile.c_str(), "w", stderr))
+                    ::_exit(127);
+            ::execvp(argv[0], argv.data());
+            ::_exit(127);
+        }
+        int status = 0;
+        if (::wait4(pid, &status, 0, &usage) < 0)
+            return -1;
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+
+    // Every function template instantiated by the unit is emitted at -O0 , so this counts the instantiations
+    long countSymbols(std::string const &object, std::string const &workDir)
+    {
+        rusage usage{};
+        auto listing = workDir + "/symbols.txt";
+        if (run({"nm", "--defined-only", object}, usage, listing) != 0)
+            return -1;
+        std::ifstream is(listing);
+        long count = 0;
+        for (std::string line; std::getline(is, line);)
+            ++count;
+        return count;
+    }
+
+    // Berkeley format of size: text data bss dec hex filename , dec is the sum
+    long countBytes(std::string const &object, std::string const &workDir)
+    {
+        rusage usage{};
+        auto listing = workDir + "/size.txt";
+        if (run({"size", object}, usage, listing) != 0)
+            return -1;
+        std::ifstream is(listing);
+        std::string header, text, data, bss, dec;
+        if (!std::getline(is, header) || !(is >> text >> data >> bss >> dec))
+            return -1;
+        return std::stol(dec);
+    }
+
+    long countTraceInstantiations(std::string const &trace)
+    {
+        std::ifstream is(trace);
+        if (!is)
+            return -1;
+        std::string text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+        long count = 0;
+        for (auto event : {"\"name\":\"InstantiateFunction\"", "\"name\":\"InstantiateClass\""})
+            for (auto at = text.find(event); at != std::string::npos; at = text.find(event, at + 1))
+                ++count;
+        return count;
+    }
+
+    Measure compile(Case const &each, std::string const &workDir, std::vector<std::string> const &flags, bool clang)
+    {
+        auto stem = std::regex_replace(each.name, std::regex("[^A-Za-z0-9_]+"), "_");
+        auto source = workDir + "/" + stem + ".cpp", object = workDir + "/" + stem + ".o";
+        std::ofstream(source) << each.source;
+
+        std::vector<std::string> command = {TCG_CXX_COMPILER};
+        command.insert(command.end(), flags.begin(), flags.end());
+        command.insert(command.end(), {"-I", TCG_SOURCE_DIR, "-c", source, "-o", object});
+        if (clang)
+            command.push_back("-ftime-trace");
+
+        Measure measure;
+        measure.name = each.name;
+        rusage usage{};
+        auto start = std::chrono::steady_clock::now();
+        measure.compiled = run(command, usage, "", workDir + "/" + stem + ".log") == 0;
+        measure.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        measure.cpuSeconds = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+        measure.peakKiB = usage.ru_maxrss; // KiB on Linux , bytes on macOS
+        if (measure.compiled)
+        {
+            measure.symbols = countSymbols(object, workDir);
+            measure.bytes = countBytes(object, workDir);
+            if (clang)
+                measure.instantiations = countTraceInstantiations(workDir + "/" + stem + ".json");
+        }
+        return measure;
+    }
+
+    bool option(std::string const &argument, char const *name, std::string &value)
+    {
+        auto prefix = std::string("--") + name + "=";
+        if (argument.compare(0, prefix.size(), prefix) != 0)
+            return false;
+        value = argument.substr(prefix.size());
+        return true;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string filter = ".*", format = "console", out, workDir = "compile_time", flags = TCG_CXX_FLAGS, value;
+    std::vector<std::size_t> sizes = {10, 100, 500};
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (option(argument, "filter", value))
+            filter = value;
+        else if (option(argument, "format", value))
+            format = value;
+        else if (option(argument, "out", value))
+            out = value;
+        else if (option(argument, "work-dir", value))
+            workDir = value;
+        else if (option(argument, "flags", value))
+            flags = value;
+        else if (option(argument, "sizes", value))
+        {
+            sizes.clear();
+            for (auto &each : split(std::regex_replace(value, std::regex(","), " ")))
+                sizes.push_back(std::stoul(each));
+        }
+        else
+        {
+            std::cerr << "unknown argument " << argument << "\nusage: " << argv[0]
+                      << " [--filter=<regex>] [--format=console|json|csv] [--out=<file>] [--work-dir=<dir>]"
+                         " [--sizes=10,100,500] [--flags=\"<compiler flags>\"]\n";
+            return 2;
+        }
+    }
+    if (format != "console" && format != "json" && format != "csv")
+    {
+        std::cerr << "unknown format " << format << '\n';
+        return 2;
+    }
+    rusage ignored{};
+    if (run({"mkdir", "-p", workDir}, ignored) != 0)
+    {
+        std::cerr << "cannot create " << workDir << '\n';
+        return 1;
+    }
+
+    bool clang = std::string(TCG_CXX_COMPILER_ID).find("Clang") != std::string::npos;
+    auto cases = headerCases();
+    for (auto &each : printCases(sizes))
+        cases.push_back(std::move(each));
+    std::vector<std::size_t> typeCounts = {10, 64}; // std::variant of hundreds of types takes minutes
+    for (auto &each : tupleVariantCases(typeCounts))
+        cases.push_back(std::move(each));
+    for (auto &each : greetingCases({10, 1000, 10000}))
+        cases.push_back(std::move(each));
+
+    std::ofstream file;
+    if (!out.empty())
+        file.open(out);
+    std::ostream &report = out.empty() ? std::cout : file;
+    std::regex pattern(filter);
+    std::vector<Measure> measures;
+    char line[256];
+    if (format == "console")
+    {
+        std::snprintf(line, sizeof(line), "%-44s %9s %9s %11s %9s %9s %10s", "case", "wall s", "cpu s", "peak KiB", "symbols", "inst.",
+                      "bytes");
+        report << line << '\n'
+               << std::string(107, '-') << std::endl;
+    }
+    for (auto const &each : cases)
+    {
+        if (!std::regex_search(each.name, pattern))
+            continue;
+        measures.push_back(compile(each, workDir, split(flags), clang));
+        auto const &measure = measures.back();
+        if (format == "console")
+        {
+            if (!measure.compiled)
+                std::snprintf(line, sizeof(line), "%-44s failed to compile , see %s/*.log", measure.name.c_str(), workDir.c_str());
+            else
+                std::snprintf(line, sizeof(line), "%-44s %9.3f %9.3f %11ld %9ld %9ld %10ld", measure.name.c_str(), measure.wallSeconds,
+                              measure.cpuSeconds, measure.peakKiB, measure.symbols, measure.instantiations, measure.bytes);
+            report << line << std::endl;
+        }
+    }
+
+    if (format == "json")
+    {
+        report << "{\n  \"context\": {\"compiler\": \"" << jsonEscape(TCG_CXX_COMPILER) << "\", \"flags\": \"" << jsonEscape(flags)
+               << "\"},\n  \"cases\": [";
+        char const *separator = "";
+        for (auto const &each : measures)
+        {
+            report << separator << "\n    {\"name\": \"" << jsonEscape(each.name) << "\", \"compiled\": " << (each.compiled ? "true" : "false")
+                   << ", \"wall_s\": " << each.wallSeconds << ", \"cpu_s\": " << each.cpuSeconds << ", \"peak_kib\": " << each.peakKiB
+                   << ", \"symbols\": " << each.symbols << ", \"instantiations\": " << each.instantiations << ", \"bytes\": " << each.bytes
+                   << '}';
+            separator = ",";
+        }
+        report << "\n  ]\n}\n";
+    }
+    else if (format == "csv")
+    {
+        report << "name,compiled,wall_s,cpu_s,peak_kib,symbols,instantiations,bytes\n";
+        for (auto const &each : measures)
+            report << '"' << each.name << "\"," << each.compiled << ',' << each.wallSeconds << ',' << each.cpuSeconds << ','
+                   << each.peakKiB << ',' << each.symbols << ',' << each.instantiations << ',' << each.bytes << '\n';
+    }
+    return std::all_of(measures.begin(), measures.end(), [](auto const &each) { return each.compiled; }) ? 0 : 1;
+}
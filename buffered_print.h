@@ -0,0 +1,211 @@
+#ifndef BUFFERED_PRINT_H
+#define BUFFERED_PRINT_H
+
+#pragma once
+
+#include "std.h"
+#include "instrumentation.h"
+#include <cerrno>
+#include <charconv>
+#include <limits>
+#include <sstream>
+#include <string_view>
+
+#if defined _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter4
+    {
+        /**
+         * NOTE 10. Buffered variadic printing
+         * Same call shape as chapter4::print , but every argument is formatted into one buffer and the whole line
+         * is handed to the OS with a single write , instead of one stream insertion per argument plus a flush.
+         *
+         * NOTICE The output bypasses the buffer of std::cout , flush it before mixing both
+         */
+        namespace buffered
+        {
+            constexpr std::size_t dynamicSize = std::numeric_limits<std::size_t>::max();
+
+            // NOTE 10.1 Upper bound of the characters a value of type T is formatted to , known at compile time
+            template <typename T, typename = void>
+            struct FormattedSize
+            {
+                static constexpr std::size_t value = dynamicSize; // strings and streamable types , measured at runtime
+            };
+            template <>
+            struct FormattedSize<bool>
+            {
+                static constexpr std::size_t value = 1; // formatted as 0/1 , like std::cout does
+            };
+            template <typename T>
+            constexpr bool isCharacter = std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>;
+
+            template <typename T>
+            struct FormattedSize<T, std::enable_if_t<isCharacter<T>>>
+            {
+                static constexpr std::size_t value = 1; // streamed as a character , not as a number
+            };
+            template <typename T>
+            struct FormattedSize<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && !isCharacter<T>>>
+            {
+                static constexpr std::size_t value = std::numeric_limits<T>::digits10 + 2; // sign and last digit
+            };
+
+            constexpr std::size_t digitCount(int value)
+            {
+                return value < 10 ? 1 : 1 + digitCount(value / 10);
+            }
+            template <typename T>
+            struct FormattedSize<T, std::enable_if_t<std::is_floating_point_v<T>>>
+            {
+                // e.g. -1.23457e+308 : sign , 6 significant digits , point , "e+" and the exponent
+                static constexpr std::size_t value = 1 + 6 + 1 + 2 + digitCount(std::numeric_limits<T>::max_exponent10);
+            };
+
+            // Characters needed by all the arguments whose size is known at compile time , plus the newline
+            template <typename... Ts>
+            constexpr std::size_t staticBound()
+            {
+                return (std::size_t{1} + ... + (FormattedSize<Ts>::value == dynamicSize ? 0 : FormattedSize<Ts>::value));
+            }
+
+            // NOTE 10.2 Every argument is first turned into a piece whose length can be measured cheaply
+            inline std::string_view piece(char const *arg)
+            {
+                return arg;
+            }
+            inline std::string_view piece(std::string const &arg)
+            {
+                return arg;
+            }
+            inline std::string_view piece(std::string_view arg)
+            {
+                return arg;
+            }
+            template <typename T>
+            decltype(auto) piece(T const &arg)
+            {
+                if constexpr (FormattedSize<T>::value != dynamicSize)
+                    return arg;
+                else
+                {
+                    std::ostringstream os; // slow path for any other streamable type
+                    os << arg;
+                    return std::move(os).str();
+                }
+            }
+
+            template <typename T>
+            std::size_t runtimeSize(T const &piece)
+            {
+                if constexpr (FormattedSize<T>::value == dynamicSize)
+                    return std::string_view(piece).size();
+                else
+                    return 0;
+            }
+
+            // NOTE 10.3 Formatting of one piece , the buffer is guaranteed to be large enough
+            template <typename T>
+            char *formatPiece(char *out, T const &piece)
+            {
+                if constexpr (std::is_same_v<T, bool>)
+                    *out++ = piece ? '1' : '0';
+                else if constexpr (isCharacter<T>)
+                    *out++ = static_cast<char>(piece);
+                else if constexpr (std::is_integral_v<T>)
+                    out = std::to_chars(out, out + FormattedSize<T>::value, piece).ptr;
+                else if constexpr (std::is_floating_point_v<T>)
+                    // Same as the default formatting of std::cout , i.e. %g with a precision of 6
+                    out = std::to_chars(out, out + FormattedSize<T>::value, piece, std::chars_format::general, 6).ptr;
+                else
+                {
+                    auto text = std::string_view(piece);
+                    std::memcpy(out, text.data(), text.size());
+                    out += text.size();
+                }
+                return out;
+            }
+
+            // Format all the pieces followed by a newline , returns the end of the output
+            template <typename... Ts>
+            char *formatLine(char *out, Ts const &...pieces)
+            {
+                ((out = formatPiece(out, pieces)), ...);
+                *out++ = '\n';
+                return out;
+            }
+
+            // Hand the whole buffer to the OS , retrying on partial writes and interrupts
+            inline bool writeAll(int fd, char const *data, std::size_t size)
+            {
+                while (size)
+                {
+#if defined _WIN32
+                    auto written = ::_write(fd, data, static_cast<unsigned>(size));
+#else
+                    auto written = ::write(fd, data, size);
+#endif
+                    if (written < 0)
+                    {
+                        if (EINTR == errno)
+                            continue;
+                        return false;
+                    }
+                    data += written;
+                    size -= static_cast<std::size_t>(written);
+                }
+                return true;
+            }
+
+            constexpr std::size_t lineBufferSize = 4096;
+
+            // One line buffer per thread , shared by every instantiation of printPieces
+            inline char *lineBuffer()
+            {
+                thread_local char line[lineBufferSize];
+                return line;
+            }
+
+            template <typename... Ts>
+            bool printPieces(int fd, Ts const &...pieces)
+            {
+                constexpr auto bound = staticBound<Ts...>();
+                auto size = (bound + ... + runtimeSize(pieces));
+                if (size <= lineBufferSize)
+                {
+                    auto line = lineBuffer();
+                    auto end = formatLine(line, pieces...);
+                    return writeAll(fd, line, static_cast<std::size_t>(end - line));
+                }
+                auto line = std::make_unique<char[]>(size); // only for very long lines
+                auto end = formatLine(line.get(), pieces...);
+                return writeAll(fd, line.get(), static_cast<std::size_t>(end - line.get()));
+            }
+
+            // Print all the arguments followed by a newline to a file descriptor with a single write
+            template <typename... Ts>
+            bool printTo(int fd, Ts const &...args)
+            {
+                TCG_SCOPED_TIMER("chapter4.buffered.printTo");
+                return printPieces(fd, piece(args)...);
+            }
+
+            template <typename... Ts>
+            bool print(Ts const &...args)
+            {
+                return printTo(1, args...);
+            }
+
+        } // namespace buffered
+
+    } // namespace chapter4
+
+} // namespace TemplateCompleteGuide
+
+#endif
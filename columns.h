@@ -0,0 +1,302 @@
+#ifndef COLUMNS_H
+#define COLUMNS_H
+
+#pragma once
+
+#include "tuple_variant.h"
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter4
+    {
+        namespace variadicClassTemplates
+        {
+            template <typename... T>
+            class Columns;
+
+            // Proxy of one row , its fields are references into the columns: auto [age, name] = columns[i];
+            template <typename Owner, typename... T>
+            class Row
+            {
+            public:
+                Row(Owner &owner, std::size_t row) noexcept : owner_(&owner), row_(row)
+                {
+                }
+
+                template <std::size_t I>
+                decltype(auto) get() const noexcept
+                {
+                    return owner_->template column<I>()[row_];
+                }
+                std::size_t index() const noexcept
+                {
+                    return row_;
+                }
+                // Copy of the row as a record
+                std::tuple<T...> toTuple() const
+                {
+                    return toTuple(std::index_sequence_for<T...>());
+                }
+
+            private:
+                template <std::size_t... I>
+                std::tuple<T...> toTuple(std::index_sequence<I...>) const
+                {
+                    return {get<I>()...};
+                }
+
+                Owner *owner_;
+                std::size_t row_;
+            };
+
+            template <std::size_t I, typename Owner, typename... T>
+            decltype(auto) get(Row<Owner, T...> const &row) noexcept
+            {
+                return row.template get<I>();
+            }
+
+            /**
+             * NOTE 9.3.5 Columnar container
+             * Records of fields T... stored as one contiguous array per field (structure of arrays) instead of one
+             * array of records. A scan reading a few fields only touches the memory of those fields , e.g.
+             * forEach<0, 3>(fn) calls fn(field0, field3) for every row and never loads fields 1 and 2.
+             * Fields are picked by compile-time index , the same Indices used by printByIndex.
+             * NOTICE append and load add whole records or none: if a field throws , the columns already extended
+             * are cut back , so that every column keeps the same length
+             */
+            template <typename... T>
+            class Columns
+            {
+                static_assert(sizeof...(T) > 0, "Columns needs at least one field");
+                static_assert(!(std::is_same_v<T, bool> || ...), "std::vector<bool> is not contiguous , store flags as std::uint8_t");
+
+            public:
+                using RowRef = Row<Columns, T...>;
+                using ConstRowRef = Row<Columns const, T...>;
+
+                template <bool isConst>
+                class Iterator
+                {
+                    using Owner = std::conditional_t<isConst, Columns const, Columns>;
+
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = Row<Owner, T...>;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = void;
+                    using reference = value_type;
+
+                    Iterator(Owner &owner, std::size_t row) noexcept : owner_(&owner), row_(row)
+                    {
+                    }
+                    reference operator*() const noexcept
+                    {
+                        return {*owner_, row_};
+                    }
+                    Iterator &operator++() noexcept
+                    {
+                        ++row_;
+                        return *this;
+                    }
+                    Iterator operator++(int) noexcept
+                    {
+                        auto old = *this;
+                        ++row_;
+                        return old;
+                    }
+                    bool operator==(Iterator const &other) const noexcept
+                    {
+                        return row_ == other.row_;
+                    }
+                    bool operator!=(Iterator const &other) const noexcept
+                    {
+                        return row_ != other.row_;
+                    }
+
+                private:
+                    Owner *owner_;
+                    std::size_t row_;
+                };
+                using iterator = Iterator<false>;
+                using const_iterator = Iterator<true>;
+
+                std::size_t size() const noexcept
+                {
+                    return std::get<0>(columns_).size();
+                }
+                bool empty() const noexcept
+                {
+                    return 0 == size();
+                }
+                void reserve(std::size_t rows)
+                {
+                    std::apply([rows](auto &...column)
+                               { (column.reserve(rows), ...); },
+                               columns_);
+                }
+                void clear() noexcept
+                {
+                    std::apply([](auto &...column)
+                               { (column.clear(), ...); },
+                               columns_);
+                }
+
+                // Append one record , field by field
+                template <typename... Args, typename = std::enable_if_t<sizeof...(Args) == sizeof...(T)>>
+                void append(Args &&...fields)
+                {
+                    appendImpl(std::index_sequence_for<T...>(), std::forward<Args>(fields)...);
+                }
+                /**
+                 * Bulk load from an array of structs , one member pointer per field
+                 * e.g. people.load(persons.begin(), persons.end(), &Person::age, &Person::name);
+                 */
+                template <typename InputIt, typename... Members, typename = std::enable_if_t<sizeof...(Members) == sizeof...(T)>>
+                void load(InputIt first, InputIt last, Members... members)
+                {
+                    auto rows = size();
+                    try
+                    {
+                        if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>)
+                        {
+                            reserve(rows + static_cast<std::size_t>(std::distance(first, last)));
+                            loadImpl(std::index_sequence_for<T...>(), first, last, members...);
+                        }
+                        else // the range can be read once only: record by record
+                            for (; first != last; ++first)
+                                loadRecord(std::index_sequence_for<T...>(), *first, members...);
+                    }
+                    catch (...)
+                    {
+                        truncate(rows);
+                        throw;
+                    }
+                }
+
+                template <std::size_t I>
+                std::vector<TypeAt<I, T...>> const &column() const noexcept
+                {
+                    return std::get<I>(columns_);
+                }
+                // Elements of a column may be modified in place , but not added or removed
+                template <std::size_t I>
+                TypeAt<I, T...> *column() noexcept
+                {
+                    return std::get<I>(columns_).data();
+                }
+
+                RowRef operator[](std::size_t row) noexcept
+                {
+                    return {*this, row};
+                }
+                ConstRowRef operator[](std::size_t row) const noexcept
+                {
+                    return {*this, row};
+                }
+                iterator begin() noexcept
+                {
+                    return {*this, 0};
+                }
+                iterator end() noexcept
+                {
+                    return {*this, size()};
+                }
+                const_iterator begin() const noexcept
+                {
+                    return {*this, 0};
+                }
+                const_iterator end() const noexcept
+                {
+                    return {*this, size()};
+                }
+
+                // Call fn with the fields idx... of every row , all of them if idx is empty
+                template <int... idx, typename Fn>
+                void forEach(Fn &&fn)
+                {
+                    scan(*this, fn, Indices<idx...>());
+                }
+                template <int... idx, typename Fn>
+                void forEach(Fn &&fn) const
+                {
+                    scan(*this, fn, Indices<idx...>());
+                }
+
+            private:
+                template <std::size_t... I, typename... Args>
+                void appendImpl(std::index_sequence<I...>, Args &&...fields)
+                {
+                    auto rows = size();
+                    try
+                    {
+                        (std::get<I>(columns_).emplace_back(std::forward<Args>(fields)), ...);
+                    }
+                    catch (...)
+                    {
+                        truncate(rows);
+                        throw;
+                    }
+                }
+                template <std::size_t... I, typename InputIt, typename... Members>
+                void loadImpl(std::index_sequence<I...>, InputIt first, InputIt last, Members... members)
+                {
+                    // One pass per column , every column is written sequentially; forward iterators only
+                    (std::for_each(first, last, [&](auto const &record)
+                                   { std::get<I>(columns_).push_back(record.*members); }),
+                     ...);
+                }
+                template <std::size_t... I, typename Record, typename... Members>
+                void loadRecord(std::index_sequence<I...>, Record const &record, Members... members)
+                {
+                    (std::get<I>(columns_).push_back(record.*members), ...);
+                }
+                // Drop the rows past rows from every column , pop_back asks nothing more of T than destruction
+                void truncate(std::size_t rows) noexcept
+                {
+                    auto cut = [rows](auto &column)
+                    {
+                        while (column.size() > rows)
+                            column.pop_back();
+                    };
+                    std::apply([&](auto &...column)
+                               { (cut(column), ...); },
+                               columns_);
+                }
+                template <typename Self, typename Fn>
+                static void scan(Self &self, Fn &fn, Indices<>)
+                {
+                    scan(self, fn, MakeIndices<sizeof...(T)>());
+                }
+                template <typename Self, typename Fn, int first, int... idx>
+                static void scan(Self &self, Fn &fn, Indices<first, idx...>)
+                {
+                    // Raw pointers , so that the loop does not reload the vectors and can be vectorized
+                    auto size = self.size();
+                    auto data = std::make_tuple(std::get<first>(self.columns_).data(), std::get<idx>(self.columns_).data()...);
+                    for (std::size_t row = 0; row < size; ++row)
+                        std::apply([&](auto... column)
+                                   { fn(column[row]...); },
+                                   data);
+                }
+
+                std::tuple<std::vector<T>...> columns_;
+            };
+
+        } // namespace variadicClassTemplates
+
+    } // namespace chapter4
+
+} // namespace TemplateCompleteGuide
+
+template <typename Owner, typename... T>
+struct std::tuple_size<TemplateCompleteGuide::chapter4::variadicClassTemplates::Row<Owner, T...>> : std::integral_constant<std::size_t, sizeof...(T)>
+{
+};
+template <std::size_t I, typename Owner, typename... T>
+struct std::tuple_element<I, TemplateCompleteGuide::chapter4::variadicClassTemplates::Row<Owner, T...>>
+{
+    using type = std::conditional_t<std::is_const_v<Owner>, TemplateCompleteGuide::chapter4::variadicClassTemplates::TypeAt<I, T...> const &,
+                                    TemplateCompleteGuide::chapter4::variadicClassTemplates::TypeAt<I, T...> &>;
+};
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef CONCURRENT_HASH_SET_H
+#define CONCURRENT_HASH_SET_H
+
+#pragma once
+
+#include "flat_hash_set.h"
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter4
+    {
+        namespace variadicBaseClassAndUsing
+        {
+            /**
+             * Hash set shared by many threads , split into independent shards by the high bits of the hash
+             * Every shard is a FlatHashSet guarded by its own reader/writer lock , on its own cache lines , so threads
+             * working on different shards never touch the same line , and lookups of the same shard only share its
+             * lock word. Hash and Eq are the same functors as for FlatHashSet , e.g. Overloader<CustomerHash, CustomerEq>.
+             *
+             * NOTICE size() and snapshots lock every shard , the other operations one shard
+             */
+            template <typename T, typename Hash = std::hash<T>, typename Eq = std::equal_to<T>>
+            class ConcurrentHashSet
+            {
+                struct alignas(64) Shard
+                {
+                    mutable std::shared_mutex mutex;
+                    FlatHashSet<T, Hash, Eq> set;
+
+                    Shard(Hash const &hash, Eq const &eq) : set(hash, eq)
+                    {
+                    }
+                };
+
+            public:
+                // shardCount is rounded up to a power of two , a few times the number of threads is a good start
+                explicit ConcurrentHashSet(std::size_t shardCount = 64, Hash hash = Hash(), Eq eq = Eq()) : hash_(std::move(hash))
+                {
+                    while ((std::size_t(1) << shardBits_) < shardCount)
+                        ++shardBits_;
+                    shards_.reserve(std::size_t(1) << shardBits_);
+                    for (std::size_t i = 0; i < (std::size_t(1) << shardBits_); ++i)
+                        shards_.push_back(std::make_unique<Shard>(hash_, eq));
+                }
+
+                template <typename V>
+                bool insert(V &&value)
+                {
+                    auto &shard = shardOf(value);
+                    std::unique_lock lock(shard.mutex);
+                    return shard.set.insert(std::forward<V>(value)).second;
+                }
+                template <typename... Args>
+                bool emplace(Args &&...args)
+                {
+                    return insert(T(std::forward<Args>(args)...));
+                }
+                template <typename K>
+                bool contains(K const &key) const
+                {
+                    auto &shard = shardOf(key);
+                    std::shared_lock lock(shard.mutex);
+                    return shard.set.contains(key);
+                }
+                // Copy of the element equal to key , if any
+                template <typename K>
+                std::optional<T> find(K const &key) const
+                {
+                    auto &shard = shardOf(key);
+                    std::shared_lock lock(shard.mutex);
+                    auto found = shard.set.find(key);
+                    if (found == shard.set.end())
+                        return std::nullopt;
+                    return *found;
+                }
+                template <typename K>
+                bool erase(K const &key)
+                {
+                    auto &shard = shardOf(key);
+                    std::unique_lock lock(shard.mutex);
+                    return shard.set.erase(key) != 0;
+                }
+
+                // Group the values by shard first , then lock every shard once for all its values
+                template <typename Iterator>
+                std::size_t bulkInsert(Iterator first, Iterator last)
+                {
+                    std::vector<std::vector<Iterator>> byShard(shards_.size());
+                    for (; first != last; ++first)
+                        byShard[shardIndex(hash_(*first))].push_back(first);
+                    std::size_t inserted = 0;
+                    for (std::size_t i = 0; i < shards_.size(); ++i)
+                    {
+                        if (byShard[i].empty())
+                            continue;
+                        std::unique_lock lock(shards_[i]->mutex);
+                        shards_[i]->set.reserve(shards_[i]->set.size() + byShard[i].size());
+                        for (auto each : byShard[i])
+                            inserted += shards_[i]->set.insert(*each).second;
+                    }
+                    return inserted;
+                }
+
+                /**
+                 * Call fn on every element of a consistent snapshot: all the shards are read-locked , in order ,
+                 * during the whole iteration , so no insertion or erasure is seen half way
+                 */
+                template <typename Fn>
+                void forEach(Fn &&fn) const
+                {
+                    forEachShardLocked([&](Shard const &shard)
+                                       {
+                                           for (auto const &each : shard.set)
+                                               fn(each);
+                                       });
+                }
+                std::vector<T> snapshot() const
+                {
+                    std::vector<T> elements;
+                    forEach([&](T const &each)
+                            { elements.push_back(each); });
+                    return elements;
+                }
+                std::size_t size() const
+                {
+                    std::size_t size = 0;
+                    forEachShardLocked([&](Shard const &shard)
+                                       { size += shard.set.size(); });
+                    return size;
+                }
+                std::size_t shardCount() const
+                {
+                    return shards_.size();
+                }
+
+            private:
+                // The high bits pick the shard , the set inside uses the low ones
+                std::size_t shardIndex(std::size_t hash) const
+                {
+                    if (!shardBits_)
+                        return 0;
+                    auto mixed = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+                    return static_cast<std::size_t>(mixed >> (64 - shardBits_));
+                }
+                template <typename K>
+                Shard &shardOf(K const &key) const
+                {
+                    return *shards_[shardIndex(hash_(key))];
+                }
+                template <typename Fn>
+                void forEachShardLocked(Fn &&fn) const
+                {
+                    std::vector<std::shared_lock<std::shared_mutex>> locks;
+                    locks.reserve(shards_.size());
+                    for (auto const &shard : shards_)
+                        locks.emplace_back(shard->mutex);
+                    for (auto const &shard : shards_)
+                        fn(*shard);
+                }
+
+                Hash hash_;
+                unsigned shardBits_ = 0;
+                std::vector<std::unique_ptr<Shard>> shards_;
+            };
+
+        } // namespace variadicBaseClassAndUsing
+
+    } // namespace chapter4
+
+} // namespace TemplateCompleteGuide
+
+#endif
@@ -0,0 +1,423 @@
+#ifndef CONCURRENT_STACK_H
+#define CONCURRENT_STACK_H
+
+#pragma once
+
+#include "std.h"
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter2
+    {
+        /**
+         * NOTE 1.1 Hazard pointers , the memory reclamation of ConcurrentStack
+         * Before dereferencing a node it may lose to another thread , a thread publishes its address in one of
+         * its hazard slots and checks the node is still reachable. Removed nodes are retired instead of deleted ,
+         * and every so often the retired nodes no slot points to are deleted. One domain serves the whole process;
+         * a thread takes a record of slots on first use and gives it back when it exits.
+         */
+        class HazardPointers
+        {
+        public:
+            static constexpr std::size_t slotsPerThread = 2;
+
+            static HazardPointers &instance()
+            {
+                static HazardPointers domain;
+                return domain;
+            }
+            HazardPointers(HazardPointers const &) = delete;
+            HazardPointers &operator=(HazardPointers const &) = delete;
+
+            // Load source until slot i of this thread holds the value it has , so that it stays valid
+            template <typename P>
+            P *protect(std::atomic<P *> const &source, std::size_t i)
+            {
+                auto &slot = threadState().record->slots[i];
+                auto pointer = source.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    slot.store(pointer, std::memory_order_seq_cst);
+                    auto again = source.load(std::memory_order_seq_cst);
+                    if (again == pointer)
+                        return pointer;
+                    pointer = again;
+                }
+            }
+            // Publish a pointer the caller validates itself
+            void set(void const *pointer, std::size_t i)
+            {
+                threadState().record->slots[i].store(pointer, std::memory_order_seq_cst);
+            }
+            void clear(std::size_t i)
+            {
+                threadState().record->slots[i].store(nullptr, std::memory_order_release);
+            }
+
+            // pointer is unreachable for new readers , delete it once no slot holds it
+            template <typename P>
+            void retire(P *pointer)
+            {
+                auto &state = threadState();
+                state.retired.push_back({pointer, [](void *each) { delete static_cast<P *>(each); }});
+                if (state.retired.size() >= scanThreshold())
+                    scan(state.retired);
+            }
+
+        private:
+            struct Record
+            {
+                std::atomic<void const *> slots[slotsPerThread] = {};
+                std::atomic<bool> active{true};
+                Record *next = nullptr;
+            };
+            struct Retired
+            {
+                void *pointer;
+                void (*deleter)(void *);
+            };
+            struct ThreadState
+            {
+                Record *record;
+                std::vector<Retired> retired;
+
+                ThreadState() : record(instance().acquireRecord())
+                {
+                }
+                // What other threads still protect goes to the orphans , adopted by the next scan
+                ~ThreadState()
+                {
+                    auto &domain = instance();
+                    for (auto &slot : record->slots)
+                        slot.store(nullptr, std::memory_order_release);
+                    record->active.store(false, std::memory_order_release);
+                    domain.scan(retired);
+                    if (!retired.empty())
+                    {
+                        std::lock_guard lock(domain.orphansMutex_);
+                        domain.orphans_.insert(domain.orphans_.end(), retired.begin(), retired.end());
+                    }
+                }
+            };
+
+            HazardPointers() = default;
+            ~HazardPointers()
+            {
+                for (auto &each : orphans_)
+                    each.deleter(each.pointer);
+                for (auto record = records_.load(); record;)
+                    delete std::exchange(record, record->next);
+            }
+
+            static ThreadState &threadState()
+            {
+                static thread_local ThreadState state;
+                return state;
+            }
+            Record *acquireRecord()
+            {
+                for (auto record = records_.load(std::memory_order_acquire); record; record = record->next)
+                {
+                    bool inactive = false;
+                    if (!record->active.load(std::memory_order_relaxed) && record->active.compare_exchange_strong(inactive, true))
+                        return record;
+                }
+                auto record = new Record;
+                auto head = records_.load(std::memory_order_relaxed);
+                do
+                    record->next = head;
+                while (!records_.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+                recordCount_.fetch_add(1, std::memory_order_relaxed);
+                return record;
+            }
+            // Scanning costs O(slots) , so retire that many nodes between scans to keep it O(1) per node
+            std::size_t scanThreshold() const
+            {
+                return std::max<std::size_t>(64, 2 * slotsPerThread * recordCount_.load(std::memory_order_relaxed));
+            }
+            void scan(std::vector<Retired> &retired)
+            {
+                {
+                    std::lock_guard lock(orphansMutex_);
+                    retired.insert(retired.end(), orphans_.begin(), orphans_.end());
+                    orphans_.clear();
+                }
+                std::vector<void const *> hazards;
+                for (auto record = records_.load(std::memory_order_acquire); record; record = record->next)
+                    for (auto &slot : record->slots)
+                        if (auto pointer = slot.load(std::memory_order_seq_cst))
+                            hazards.push_back(pointer);
+                std::sort(hazards.begin(), hazards.end());
+                auto kept = std::partition(retired.begin(), retired.end(), [&](Retired const &each)
+                                           { return std::binary_search(hazards.begin(), hazards.end(), each.pointer); });
+                for (auto each = kept; each != retired.end(); ++each)
+                    each->deleter(each->pointer);
+                retired.erase(kept, retired.end());
+            }
+
+            std::atomic<Record *> records_{nullptr};
+            std::atomic<std::size_t> recordCount_{0};
+            std::mutex orphansMutex_;
+            std::vector<Retired> orphans_;
+        };
+
+        /**
+         * NOTE 1.2 Lock-free multi-producer / multi-consumer stack , the concurrent counterpart of Stack
+         * A Treiber stack: a list of nodes whose head is swapped by compare-and-swap. Popped nodes are reclaimed
+         * through HazardPointers , which also rules out ABA on the head: a node cannot be freed and reallocated
+         * at the same address while a thread holds it.
+         * Under contention , a push whose compare-and-swap failed offers its node in a slot of a small
+         * elimination array for a while , and a pop whose compare-and-swap failed looks for such an offer: a
+         * push and a pop meeting there cancel out without touching the head.
+         *
+         * NOTICE as with every concurrent container , size() and empty() are snapshots
+         */
+        template <typename T>
+        class ConcurrentStack
+        {
+            struct Node
+            {
+                T value;
+                Node *next;
+            };
+
+            // Slots where a pushing thread offers its node to a popping one
+            class EliminationArray
+            {
+            public:
+                // Offer node for a while; true when a pop took it , false when it is still the caller's
+                bool give(Node *node)
+                {
+                    auto &slot = slots_[pick()].node;
+                    Node *empty = nullptr;
+                    if (!slot.compare_exchange_strong(empty, node, std::memory_order_release, std::memory_order_relaxed))
+                        return false;
+                    for (int spin = 0; spin < offerSpins; ++spin)
+                        if (slot.load(std::memory_order_relaxed) != node)
+                            return true;
+                    auto offered = node;
+                    // Withdrawing fails when a pop took the node meanwhile
+                    return !slot.compare_exchange_strong(offered, nullptr, std::memory_order_relaxed, std::memory_order_relaxed);
+                }
+                Node *take()
+                {
+                    auto &slot = slots_[pick()].node;
+                    auto node = slot.load(std::memory_order_acquire);
+                    if (node && slot.compare_exchange_strong(node, nullptr, std::memory_order_acquire, std::memory_order_relaxed))
+                        return node;
+                    return nullptr;
+                }
+
+            private:
+                static constexpr std::size_t width = 8;
+                static constexpr int offerSpins = 256;
+
+                static std::size_t pick()
+                {
+                    thread_local std::uint32_t seed = static_cast<std::uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+                    seed ^= seed << 13;
+                    seed ^= seed >> 17;
+                    seed ^= seed << 5;
+                    return seed % width;
+                }
+
+                struct alignas(64) Slot
+                {
+                    std::atomic<Node *> node{nullptr};
+                };
+                Slot slots_[width];
+            };
+
+        public:
+            using value_type = T;
+            using size_type = std::size_t;
+
+            ConcurrentStack() = default;
+            ConcurrentStack(T elem) // initialize stack with one element by value
+            {
+                push(std::move(elem));
+            }
+            ConcurrentStack(ConcurrentStack const &) = delete;
+            ConcurrentStack &operator=(ConcurrentStack const &) = delete;
+            // No other thread may use the stack any more
+            ~ConcurrentStack()
+            {
+                for (auto node = head_.load(std::memory_order_acquire); node;)
+                    delete std::exchange(node, node->next);
+            }
+
+            void push(T const &elem)
+            {
+                emplace(elem);
+            }
+            void push(T &&elem)
+            {
+                emplace(std::move(elem));
+            }
+            template <typename... Args>
+            void emplace(Args &&...args)
+            {
+                pushNode(new Node{T(std::forward<Args>(args)...), nullptr});
+            }
+            // Push the elements of [first , last) with a single compare-and-swap , the last one ends on top
+            template <typename Iterator>
+            void push_batch(Iterator first, Iterator last)
+            {
+                if (first == last)
+                    return;
+                Node *top = nullptr, *bottom = nullptr;
+                try
+                {
+                    for (; first != last; ++first)
+                    {
+                        top = new Node{T(*first), top};
+                        if (!bottom)
+                            bottom = top;
+                    }
+                }
+                catch (...)
+                {
+                    while (top)
+                        delete std::exchange(top, top->next);
+                    throw;
+                }
+                auto head = head_.load(std::memory_order_relaxed);
+                do
+                    bottom->next = head;
+                while (!head_.compare_exchange_weak(head, top, std::memory_order_release, std::memory_order_relaxed));
+                size_.fetch_add(static_cast<std::ptrdiff_t>(countFrom(top, bottom)), std::memory_order_relaxed);
+            }
+
+            std::optional<T> try_pop()
+            {
+                auto &hazards = HazardPointers::instance();
+                for (;;)
+                {
+                    auto head = hazards.protect(head_, 0);
+                    if (!head)
+                        return std::nullopt;
+                    if (head_.compare_exchange_strong(head, head->next, std::memory_order_acquire, std::memory_order_relaxed))
+                    {
+                        hazards.clear(0);
+                        size_.fetch_sub(1, std::memory_order_relaxed);
+                        std::optional<T> value(std::move(head->value));
+                        hazards.retire(head);
+                        return value;
+                    }
+                    hazards.clear(0);
+                    if (auto node = elimination_.take())
+                    {
+                        // Never reachable from the head , so nobody else can hold it; pushNode counted it
+                        size_.fetch_sub(1, std::memory_order_relaxed);
+                        std::optional<T> value(std::move(node->value));
+                        delete node;
+                        return value;
+                    }
+                }
+            }
+            /**
+             * Pop up to max elements with a single compare-and-swap , writing them from the top to out , and
+             * return how many. The nodes below the head stay in place as long as the head does , so walking them
+             * is safe after checking , for every node , that the head has not moved.
+             */
+            template <typename OutputIterator>
+            size_type try_pop_batch(OutputIterator out, size_type max)
+            {
+                if (!max)
+                    return 0;
+                auto &hazards = HazardPointers::instance();
+                for (;;)
+                {
+                    auto head = hazards.protect(head_, 0);
+                    if (!head)
+                        return 0;
+                    auto last = head;
+                    size_type count = 1;
+                    bool moved = false;
+                    while (count < max)
+                    {
+                        auto next = last->next;
+                        if (!next)
+                            break;
+                        hazards.set(next, 1);
+                        if (head_.load(std::memory_order_seq_cst) != head)
+                        {
+                            moved = true;
+                            break;
+                        }
+                        last = next;
+                        ++count;
+                    }
+                    if (!moved && head_.compare_exchange_strong(head, last->next, std::memory_order_acquire, std::memory_order_relaxed))
+                    {
+                        hazards.clear(0);
+                        hazards.clear(1);
+                        size_.fetch_sub(static_cast<std::ptrdiff_t>(count), std::memory_order_relaxed);
+                        for (auto node = head, end = last->next; node != end;)
+                        {
+                            auto next = node->next;
+                            *out++ = std::move(node->value);
+                            hazards.retire(node);
+                            node = next;
+                        }
+                        return count;
+                    }
+                    hazards.clear(1);
+                }
+            }
+
+            bool empty() const noexcept
+            {
+                return head_.load(std::memory_order_relaxed) == nullptr;
+            }
+            size_type size() const noexcept
+            {
+                return static_cast<size_type>(std::max<std::ptrdiff_t>(size_.load(std::memory_order_relaxed), 0));
+            }
+
+            auto showElementType()
+            {
+                std::cout << typeid(T).name() << std::endl;
+                std::cout << "The elements count is " << size() << std::endl;
+            }
+
+        private:
+            static size_type countFrom(Node const *top, Node const *bottom)
+            {
+                size_type count = 1;
+                for (; top != bottom; top = top->next)
+                    ++count;
+                return count;
+            }
+
+            void pushNode(Node *node)
+            {
+                size_.fetch_add(1, std::memory_order_relaxed);
+                auto head = head_.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    node->next = head;
+                    if (head_.compare_exchange_strong(head, node, std::memory_order_release, std::memory_order_relaxed))
+                        return;
+                    if (elimination_.give(node))
+                        return;
+                    head = head_.load(std::memory_order_relaxed);
+                }
+            }
+
+            alignas(64) std::atomic<Node *> head_{nullptr};
+            alignas(64) std::atomic<std::ptrdiff_t> size_{0}; // may dip below zero between a pop and its push
+            EliminationArray elimination_;
+        };
+        // NOTE 1. Deduction guide , the same as for Stack
+        ConcurrentStack(char const *)->ConcurrentStack<std::string>;
+
+    } // namespace chapter2
+
+} // namespace TemplateCompleteGuide
+
+#endif
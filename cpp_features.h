@@ -23,6 +23,17 @@ namespace CppFeatures
         Mut,
         Div
     };
+    constexpr std::size_t operatorCount = 4; // number of enumerators above
+
+    // Array operands make Operation build a lazy expression instead , see array_expression.h
+    template <typename T>
+    struct IsArrayOperand : std::false_type
+    {
+    };
+    template <typename T>
+    constexpr bool isArrayOperand = IsArrayOperand<std::decay_t<T>>::value;
+    template <Operators op, typename L, typename R>
+    struct ArrayExpression;
 
     /**
      * NOTE 2. Compiling time if
@@ -31,9 +42,11 @@ namespace CppFeatures
     struct Operation
     {
         template <typename L, typename R = L>
-        auto operator()(L lhs, R rhs)
+        constexpr auto operator()(L lhs, R rhs) const
         {
-            if constexpr (Operators::Add == op)
+            if constexpr (isArrayOperand<L> || isArrayOperand<R>)
+                return ArrayExpression<op, L, R>{lhs, rhs};
+            else if constexpr (Operators::Add == op)
                 return lhs + rhs;
             else if constexpr (Operators::Sub == op)
                 return lhs - rhs;
@@ -3,10 +3,429 @@
 
 #pragma once
 
+#include "std.h"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+// Fill the objects returned to an ObjectPool with a pattern and check it when they are handed out again ,
+// on by default in debug builds only
+#if !defined(TCG_POOL_POISON)
+#if defined(NDEBUG)
+#define TCG_POOL_POISON 0
+#else
+#define TCG_POOL_POISON 1
+#endif
+#endif
+
 namespace DesignPattern
 {
-    
-} // namespace DesignPattern
+    /**
+     * NOTE 1. Object pool
+     * Fixed-size slots for objects of one type , for the short-lived objects allocated and freed in great
+     * numbers , e.g. application::Node or one Animal subclass. Slots are carved out of chunks owned by the pool
+     * and move around in batches of BatchSize:
+     *  - every thread keeps a cache of up to two batches per pool , allocating and freeing there without any
+     *    synchronization
+     *  - a full batch of freed slots goes to a global lock-free stack , an empty cache takes a batch from it ,
+     *    and only when the stack is empty does the pool lock to carve a new chunk
+     * The stack head is a tagged pointer: a 16-bit counter packed above the 48 address bits , bumped by every
+     * push and pop , so that a head popped and pushed back between the read and the compare-and-swap of another
+     * thread (ABA) fails the compare-and-swap. Chunks are only released with the pool , so a stale head is
+     * always readable memory.
+     * When a thread exits , its caches go back to the pools still alive.
+     *
+     * NOTICE objects must be destroyed before their pool , and the 48-bit layout holds on x86-64 and AArch64
+     * user space
+     */
+    template <typename T, std::size_t BatchSize = 64>
+    class ObjectPool
+    {
+        static_assert(BatchSize > 0, "batches hold at least one slot");
+
+        union Slot;
+        struct FreeLink
+        {
+            Slot *next;                    // within a batch
+            std::atomic<Slot *> nextBatch; // on the global stack , read by threads racing for the head
+        };
+        union Slot
+        {
+            FreeLink link;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+        struct Cache
+        {
+            Slot *allocating = nullptr; // handed out first
+            Slot *freed = nullptr;      // becomes a batch for the global stack when BatchSize long
+            std::size_t freedCount = 0;
+        };
+        // The caches of one thread , for every pool of this type it used
+        struct ThreadCaches
+        {
+            struct Entry
+            {
+                ObjectPool *pool;
+                std::uint64_t id;
+                Cache cache;
+            };
+            std::vector<Entry> entries;
+
+            ~ThreadCaches()
+            {
+                std::lock_guard lock(registryMutex());
+                for (auto &entry : entries)
+                    if (isAlive(entry.id))
+                        entry.pool->returnCache(entry.cache);
+            }
+        };
+
+    public:
+        struct Deleter
+        {
+            ObjectPool *pool;
+
+            void operator()(T *object) const noexcept
+            {
+                pool->destroy(object);
+            }
+        };
+        // Owning handle: the object goes back to the pool when the handle dies
+        using Handle = std::unique_ptr<T, Deleter>;
+
+        ObjectPool() : id_(nextId().fetch_add(1) + 1)
+        {
+            std::lock_guard lock(registryMutex());
+            alive().push_back(id_);
+        }
+        ObjectPool(ObjectPool const &) = delete;
+        ObjectPool &operator=(ObjectPool const &) = delete;
+        // From here on , the thread caches of this pool are dropped instead of returned
+        ~ObjectPool()
+        {
+            std::lock_guard lock(registryMutex());
+            auto &ids = alive();
+            ids.erase(std::find(ids.begin(), ids.end(), id_));
+        }
+
+        template <typename... Args>
+        T *create(Args &&...args)
+        {
+            auto slot = allocate();
+            try
+            {
+                return ::new (slot) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                deallocate(slot);
+                throw;
+            }
+        }
+        void destroy(T *object) noexcept
+        {
+            if (!object)
+                return;
+            object->~T();
+            deallocate(object);
+        }
+        template <typename... Args>
+        Handle make(Args &&...args)
+        {
+            return Handle(create(std::forward<Args>(args)...), Deleter{this});
+        }
+
+        // Raw slots of sizeof(T) bytes , aligned for T
+        void *allocate()
+        {
+            auto &cache = threadCache();
+            if (!cache.allocating)
+            {
+                if (cache.freed)
+                {
+                    cache.allocating = std::exchange(cache.freed, nullptr);
+                    cache.freedCount = 0;
+                }
+                else
+                    cache.allocating = popBatch();
+            }
+            auto slot = cache.allocating;
+            cache.allocating = slot->link.next;
+#if TCG_POOL_POISON
+            for (auto i = sizeof(FreeLink); i < sizeof(Slot); ++i)
+                assert(slot->storage[i] == poison && "object written after it went back to the pool");
+#endif
+            return slot;
+        }
+        void deallocate(void *pointer) noexcept
+        {
+            auto slot = static_cast<Slot *>(pointer);
+#if TCG_POOL_POISON
+            std::memset(static_cast<void *>(slot), poison, sizeof(Slot));
+#endif
+            auto &cache = threadCache();
+            slot->link.next = cache.freed;
+            cache.freed = slot;
+            if (++cache.freedCount == BatchSize)
+            {
+                pushBatch(std::exchange(cache.freed, nullptr));
+                cache.freedCount = 0;
+            }
+        }
+
+        // Slots carved so far , in use or not
+        std::size_t capacity() const
+        {
+            std::lock_guard lock(chunksMutex_);
+            return capacity_;
+        }
+
+    private:
+        static constexpr unsigned char poison = 0xDD;
+        static constexpr int tagShift = 48;
+        static constexpr std::uint64_t addressMask = (std::uint64_t(1) << tagShift) - 1;
+        static_assert(sizeof(Slot *) <= sizeof(std::uint64_t), "the tagged pointer packs an address into 64 bits");
+
+        static Slot *addressOf(std::uint64_t head) noexcept
+        {
+            if constexpr (sizeof(Slot *) == sizeof(std::uint64_t))
+                return reinterpret_cast<Slot *>(static_cast<std::uintptr_t>(head & addressMask));
+            else
+                return reinterpret_cast<Slot *>(static_cast<std::uintptr_t>(head & 0xFFFFFFFFu));
+        }
+        // The counter of the previous head plus one , above the address
+        static std::uint64_t tagged(Slot *batch, std::uint64_t previous) noexcept
+        {
+            auto address = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(batch));
+            if constexpr (sizeof(Slot *) == sizeof(std::uint64_t))
+                return address | (((previous >> tagShift) + 1) << tagShift);
+            else
+                return address | (((previous >> 32) + 1) << 32);
+        }
+
+        void pushBatch(Slot *batch) noexcept
+        {
+            auto head = head_.load(std::memory_order_relaxed);
+            do
+                batch->link.nextBatch.store(addressOf(head), std::memory_order_relaxed);
+            while (!head_.compare_exchange_weak(head, tagged(batch, head), std::memory_order_release, std::memory_order_relaxed));
+        }
+        Slot *popBatch()
+        {
+            auto head = head_.load(std::memory_order_acquire);
+            while (auto batch = addressOf(head))
+            {
+                // batch may be popped and reused meanwhile , then the tag has moved and the exchange fails
+                auto next = batch->link.nextBatch.load(std::memory_order_relaxed);
+                if (head_.compare_exchange_weak(head, tagged(next, head), std::memory_order_acquire, std::memory_order_acquire))
+                    return batch;
+            }
+            return carveChunk();
+        }
+
+        // A new chunk , twice as large as the previous one: keep one batch , push the others
+        Slot *carveChunk()
+        {
+            std::lock_guard lock(chunksMutex_);
+            auto batches = chunks_.empty() ? std::size_t(4) : std::min<std::size_t>(chunkBatches_ * 2, 1024);
+            chunkBatches_ = batches;
+            auto count = batches * BatchSize;
+            chunks_.push_back(std::make_unique<Slot[]>(count));
+            capacity_ += count;
+            auto slots = chunks_.back().get();
+#if TCG_POOL_POISON
+            std::memset(static_cast<void *>(slots), poison, count * sizeof(Slot));
+#endif
+            for (std::size_t batch = 0; batch < batches; ++batch)
+            {
+                auto first = slots + batch * BatchSize;
+                for (std::size_t i = 0; i + 1 < BatchSize; ++i)
+                    first[i].link.next = first + i + 1;
+                first[BatchSize - 1].link.next = nullptr;
+                if (batch)
+                    pushBatch(first);
+            }
+            return slots;
+        }
+
+        // Partial batches are fine on the stack: a batch is a list , only the caches count
+        void returnCache(Cache &cache) noexcept
+        {
+            if (cache.allocating)
+                pushBatch(std::exchange(cache.allocating, nullptr));
+            if (cache.freed)
+                pushBatch(std::exchange(cache.freed, nullptr));
+            cache.freedCount = 0;
+        }
 
+        Cache &threadCache()
+        {
+            for (auto &entry : threadCaches_.entries)
+                if (entry.id == id_)
+                    return entry.cache;
+            // First use of this pool on this thread , forget the pools destroyed meanwhile
+            std::lock_guard lock(registryMutex());
+            auto &entries = threadCaches_.entries;
+            entries.erase(std::remove_if(entries.begin(), entries.end(), [](auto const &entry) { return !isAlive(entry.id); }), entries.end());
+            entries.push_back({this, id_, {}});
+            return entries.back().cache;
+        }
+
+        // Ids of the live pools: unlike addresses , ids are never reused
+        static std::atomic<std::uint64_t> &nextId()
+        {
+            static std::atomic<std::uint64_t> id{0};
+            return id;
+        }
+        static std::mutex &registryMutex()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+        static std::vector<std::uint64_t> &alive()
+        {
+            static std::vector<std::uint64_t> ids;
+            return ids;
+        }
+        static bool isAlive(std::uint64_t id)
+        {
+            auto const &ids = alive();
+            return std::find(ids.begin(), ids.end(), id) != ids.end();
+        }
+
+        static inline thread_local ThreadCaches threadCaches_;
+
+        std::uint64_t id_;
+        alignas(64) std::atomic<std::uint64_t> head_{0};
+        alignas(64) mutable std::mutex chunksMutex_;
+        std::vector<std::unique_ptr<Slot[]>> chunks_;
+        std::size_t chunkBatches_ = 0;
+        std::size_t capacity_ = 0;
+    };
+
+    /**
+     * NOTE 2. Flyweight
+     * Equal immutable values are stored once , in an ObjectPool , and shared through Flyweight handles , which
+     * compare and hash by address. Lookups of values already interned take a shared lock only.
+     * Values live as long as the factory.
+     */
+    template <typename T, typename Hash = std::hash<T>, typename Eq = std::equal_to<T>>
+    class FlyweightFactory
+    {
+        struct ValueHash
+        {
+            Hash hash;
+
+            std::size_t operator()(T const *value) const
+            {
+                return hash(*value);
+            }
+        };
+        struct ValueEq
+        {
+            Eq eq;
+
+            bool operator()(T const *lhs, T const *rhs) const
+            {
+                return eq(*lhs, *rhs);
+            }
+        };
+
+    public:
+        class Flyweight
+        {
+        public:
+            T const &operator*() const noexcept
+            {
+                return *value_;
+            }
+            T const *operator->() const noexcept
+            {
+                return value_;
+            }
+            T const *get() const noexcept
+            {
+                return value_;
+            }
+            // Equal values share one address
+            friend bool operator==(Flyweight lhs, Flyweight rhs) noexcept
+            {
+                return lhs.value_ == rhs.value_;
+            }
+            friend bool operator!=(Flyweight lhs, Flyweight rhs) noexcept
+            {
+                return lhs.value_ != rhs.value_;
+            }
+            // For unordered containers of flyweights: hashing the address is enough
+            struct AddressHash
+            {
+                std::size_t operator()(Flyweight flyweight) const noexcept
+                {
+                    return std::hash<T const *>()(flyweight.value_);
+                }
+            };
+
+        private:
+            friend class FlyweightFactory;
+            explicit Flyweight(T const *value) noexcept : value_(value)
+            {
+            }
+
+            T const *value_;
+        };
+
+        FlyweightFactory() = default;
+        FlyweightFactory(FlyweightFactory const &) = delete;
+        FlyweightFactory &operator=(FlyweightFactory const &) = delete;
+        ~FlyweightFactory()
+        {
+            for (auto each : values_)
+                pool_.destroy(const_cast<T *>(each));
+        }
+
+        template <typename V, typename = std::enable_if_t<std::is_same_v<std::decay_t<V>, T>>>
+        Flyweight intern(V &&value)
+        {
+            {
+                std::shared_lock lock(mutex_);
+                auto found = values_.find(&value);
+                if (found != values_.end())
+                    return Flyweight(*found);
+            }
+            std::unique_lock lock(mutex_);
+            auto found = values_.find(&value);
+            if (found != values_.end())
+                return Flyweight(*found);
+            auto stored = pool_.create(std::forward<V>(value));
+            try
+            {
+                values_.insert(stored);
+            }
+            catch (...)
+            {
+                pool_.destroy(stored);
+                throw;
+            }
+            return Flyweight(stored);
+        }
+        template <typename... Args>
+        Flyweight emplace(Args &&...args)
+        {
+            return intern(T(std::forward<Args>(args)...));
+        }
+
+        std::size_t size() const
+        {
+            std::shared_lock lock(mutex_);
+            return values_.size();
+        }
+
+    private:
+        ObjectPool<T> pool_;
+        mutable std::shared_mutex mutex_;
+        std::unordered_set<T const *, ValueHash, ValueEq> values_;
+    };
+
+} // namespace DesignPattern
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,208 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#pragma once
+
+#include "std.h"
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter3
+    {
+        /**
+         * NOTE 2.1 Strings built at compile time
+         * FixedString<N> holds up to N characters in place and every operation on it is constexpr , so text
+         * fully determined by template arguments can be put together by the compiler and stored as one static
+         * read-only buffer , e.g.
+         *
+         *  static constexpr auto line = FixedString(" Hello ") + toFixedString<42>() + "\n";
+         *  static constexpr auto lines = repeat<3>(line); // " Hello 42\n Hello 42\n Hello 42\n"
+         *
+         * The capacity of a result is the sum (or product) of the capacities , known from the types alone.
+         */
+        template <std::size_t N>
+        class FixedString
+        {
+        public:
+            constexpr FixedString() = default;
+            constexpr FixedString(char const (&text)[N + 1]) // from a literal , without its terminator
+            {
+                append(text, N);
+            }
+            constexpr FixedString(std::string_view text)
+            {
+                append(text.data(), text.size());
+            }
+
+            constexpr void append(char const *text, std::size_t count)
+            {
+                if (size_ + count > N)
+                    throw std::length_error("FixedString capacity exceeded"); // ill-formed when constant evaluated
+                for (std::size_t i = 0; i < count; ++i)
+                    data_[size_++] = text[i];
+                data_[size_] = '\0';
+            }
+            template <std::size_t M>
+            constexpr void append(FixedString<M> const &other)
+            {
+                append(other.data(), other.size());
+            }
+
+            static constexpr std::size_t capacity() noexcept
+            {
+                return N;
+            }
+            constexpr std::size_t size() const noexcept
+            {
+                return size_;
+            }
+            constexpr char const *data() const noexcept
+            {
+                return data_;
+            }
+            constexpr char const *c_str() const noexcept
+            {
+                return data_;
+            }
+            constexpr std::string_view view() const noexcept
+            {
+                return {data_, size_};
+            }
+            constexpr operator std::string_view() const noexcept
+            {
+                return view();
+            }
+            constexpr char operator[](std::size_t i) const noexcept
+            {
+                return data_[i];
+            }
+
+            template <std::size_t M>
+            constexpr FixedString<N + M> operator+(FixedString<M> const &rhs) const
+            {
+                FixedString<N + M> result;
+                result.append(data_, size_);
+                result.append(rhs);
+                return result;
+            }
+            template <std::size_t M>
+            constexpr FixedString<N + M - 1> operator+(char const (&rhs)[M]) const
+            {
+                return *this + FixedString<M - 1>(rhs);
+            }
+            template <std::size_t M>
+            friend constexpr FixedString<M - 1 + N> operator+(char const (&lhs)[M], FixedString const &rhs)
+            {
+                return FixedString<M - 1>(lhs) + rhs;
+            }
+
+            template <std::size_t M>
+            constexpr bool operator==(FixedString<M> const &rhs) const noexcept
+            {
+                return view() == rhs.view();
+            }
+            template <std::size_t M>
+            constexpr bool operator!=(FixedString<M> const &rhs) const noexcept
+            {
+                return view() != rhs.view();
+            }
+
+            friend std::ostream &operator<<(std::ostream &os, FixedString const &text)
+            {
+                return os.write(text.data_, static_cast<std::streamsize>(text.size_));
+            }
+
+        private:
+            char data_[N + 1] = {};
+            std::size_t size_ = 0;
+        };
+        template <std::size_t M>
+        FixedString(char const (&)[M]) -> FixedString<M - 1>;
+
+        // times copies of text one after the other
+        template <std::size_t times, std::size_t N>
+        constexpr FixedString<N * times> repeat(FixedString<N> const &text)
+        {
+            FixedString<N * times> result;
+            for (std::size_t i = 0; i < times; ++i)
+                result.append(text);
+            return result;
+        }
+
+        // NOTE 2.2 Integer to text , in exactly as many characters as the value needs
+        template <typename T>
+        constexpr std::size_t decimalLength(T value)
+        {
+            std::size_t length = value < 0 ? 2 : 1;
+            for (; value / 10 != 0; value /= 10)
+                ++length;
+            return length;
+        }
+        template <auto value>
+        constexpr auto toFixedString()
+        {
+            static_assert(std::is_integral_v<decltype(value)>, "Only integers are converted at compile time");
+            FixedString<decimalLength(value)> result;
+            if constexpr (std::is_same_v<decltype(value), bool>)
+                result.append(value ? "1" : "0", 1); // as std::cout streams it
+            else
+            {
+                char digits[decimalLength(value)] = {};
+                auto remaining = value;
+                auto at = decimalLength(value);
+                do
+                {
+                    auto digit = remaining % 10;
+                    digits[--at] = static_cast<char>('0' + (digit < 0 ? -digit : digit));
+                    remaining /= 10;
+                } while (remaining != 0);
+                if (value < 0)
+                    digits[0] = '-';
+                result.append(digits, sizeof(digits));
+            }
+            return result;
+        }
+
+        // NOTE 2.3 The text of a pointer to a constant null-terminated array , e.g. a static const char[]
+        template <auto text>
+        constexpr std::size_t constantLength()
+        {
+            std::size_t length = 0;
+            while (text[length] != '\0')
+                ++length;
+            return length;
+        }
+
+        // Whether Value can be turned into text by the compiler: an integer , or characters it can read
+        template <auto Value, typename = void>
+        struct IsConstantText : std::is_integral<decltype(Value)>
+        {
+        };
+        template <auto Value>
+        struct IsConstantText<Value, std::enable_if_t<std::is_convertible_v<decltype(Value), char const *> && (Value[0] == Value[0])>>
+            : std::true_type
+        {
+        };
+        template <auto Value>
+        constexpr bool isConstantText = IsConstantText<Value>::value;
+
+        template <auto Value>
+        constexpr auto constantText()
+        {
+            using T = decltype(Value);
+            if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>)
+            {
+                char const character[] = {static_cast<char>(Value)}; // streamed as a character , not as a number
+                return FixedString<1>(std::string_view(character, 1));
+            }
+            else if constexpr (std::is_integral_v<T>)
+                return toFixedString<Value>();
+            else
+                return FixedString<constantLength<Value>()>(std::string_view(Value, constantLength<Value>()));
+        }
+
+    } // namespace chapter3
+
+} // namespace TemplateCompleteGuide
+
+#endif
@@ -0,0 +1,444 @@
+#ifndef FLAT_HASH_SET_H
+#define FLAT_HASH_SET_H
+
+#pragma once
+
+#include "template_complete_guide.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TCG_FLAT_HASH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter4
+    {
+        namespace variadicBaseClassAndUsing
+        {
+            /**
+             * Flat , open-addressing hash set in the style of SwissTable
+             * The elements live in one array of slots , next to an array of control bytes: one per slot , holding
+             * either "empty" , "deleted" or the low 7 bits of the hash of the element (its fingerprint).
+             * A lookup compares the fingerprint against a whole group of 16 control bytes at once (SSE2) and only
+             * looks at the slots whose fingerprint matches , then at the full hash which is cached per slot , and
+             * only then calls the equality. Rehashing reuses the cached hashes.
+             *
+             * Hash and Eq may be separate functors or one Overloader<Hash, Eq>. Lookups accept any key the functors
+             * accept , e.g. std::string_view for Customer , so that no element has to be built to find one.
+             */
+            template <typename T, typename Hash = std::hash<T>, typename Eq = std::equal_to<T>>
+            class FlatHashSet
+            {
+                using Control = std::int8_t;
+                static constexpr Control emptyControl = -128;  // 0b10000000
+                static constexpr Control deletedControl = -2;  // 0b11111110
+                static constexpr std::size_t groupWidth = 16;
+
+                // Bit i is set if control byte i of the group matches
+                struct Group
+                {
+#if defined(TCG_FLAT_HASH_SSE2)
+                    __m128i controls;
+                    explicit Group(Control const *position) : controls(_mm_loadu_si128(reinterpret_cast<__m128i const *>(position)))
+                    {
+                    }
+                    unsigned match(Control fingerprint) const
+                    {
+                        return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(controls, _mm_set1_epi8(fingerprint))));
+                    }
+                    unsigned matchEmpty() const
+                    {
+                        return match(emptyControl);
+                    }
+                    unsigned matchEmptyOrDeleted() const
+                    {
+                        // Full slots have the high bit clear
+                        return static_cast<unsigned>(_mm_movemask_epi8(controls));
+                    }
+#else
+                    Control controls[groupWidth];
+                    explicit Group(Control const *position)
+                    {
+                        std::memcpy(controls, position, groupWidth);
+                    }
+                    unsigned match(Control fingerprint) const
+                    {
+                        unsigned mask = 0;
+                        for (std::size_t i = 0; i < groupWidth; ++i)
+                            mask |= unsigned(controls[i] == fingerprint) << i;
+                        return mask;
+                    }
+                    unsigned matchEmpty() const
+                    {
+                        return match(emptyControl);
+                    }
+                    unsigned matchEmptyOrDeleted() const
+                    {
+                        unsigned mask = 0;
+                        for (std::size_t i = 0; i < groupWidth; ++i)
+                            mask |= unsigned(controls[i] < 0) << i;
+                        return mask;
+                    }
+#endif
+                };
+
+                static unsigned lowestBit(unsigned mask)
+                {
+#if defined(__GNUC__) || defined(__clang__)
+                    return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+                    unsigned index = 0;
+                    while (!(mask & 1u))
+                        mask >>= 1, ++index;
+                    return index;
+#endif
+                }
+
+            public:
+                using value_type = T;
+                using size_type = std::size_t;
+
+                class const_iterator
+                {
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = T;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = T const *;
+                    using reference = T const &;
+
+                    const_iterator() = default;
+                    reference operator*() const
+                    {
+                        return set_->slots_[index_];
+                    }
+                    pointer operator->() const
+                    {
+                        return set_->slots_ + index_;
+                    }
+                    const_iterator &operator++()
+                    {
+                        index_ = set_->nextFull(index_ + 1);
+                        return *this;
+                    }
+                    const_iterator operator++(int)
+                    {
+                        auto copy = *this;
+                        ++*this;
+                        return copy;
+                    }
+                    bool operator==(const_iterator const &other) const
+                    {
+                        return index_ == other.index_;
+                    }
+                    bool operator!=(const_iterator const &other) const
+                    {
+                        return index_ != other.index_;
+                    }
+
+                private:
+                    friend class FlatHashSet;
+                    const_iterator(FlatHashSet const *set, std::size_t index) : set_(set), index_(index)
+                    {
+                    }
+                    FlatHashSet const *set_ = nullptr;
+                    std::size_t index_ = 0;
+                };
+                using iterator = const_iterator; // elements are immutable , their hash is cached
+
+                explicit FlatHashSet(Hash hash = Hash(), Eq eq = Eq()) : hash_(std::move(hash)), eq_(std::move(eq))
+                {
+                }
+                FlatHashSet(FlatHashSet const &other) : hash_(other.hash_), eq_(other.eq_)
+                {
+                    reserve(other.size_);
+                    for (auto const &each : other)
+                        insertUnique(each, other.hashes_[&each - other.slots_]);
+                }
+                FlatHashSet(FlatHashSet &&other) noexcept : hash_(std::move(other.hash_)), eq_(std::move(other.eq_))
+                {
+                    swapStorage(other);
+                }
+                FlatHashSet &operator=(FlatHashSet other) noexcept
+                {
+                    std::swap(hash_, other.hash_);
+                    std::swap(eq_, other.eq_);
+                    swapStorage(other);
+                    return *this;
+                }
+                ~FlatHashSet()
+                {
+                    destroyStorage();
+                }
+
+                const_iterator begin() const
+                {
+                    return {this, nextFull(0)};
+                }
+                const_iterator end() const
+                {
+                    return {this, capacity_};
+                }
+                size_type size() const noexcept
+                {
+                    return size_;
+                }
+                bool empty() const noexcept
+                {
+                    return 0 == size_;
+                }
+                size_type capacity() const noexcept
+                {
+                    return capacity_;
+                }
+
+                template <typename... Args>
+                std::pair<const_iterator, bool> emplace(Args &&...args)
+                {
+                    T value(std::forward<Args>(args)...);
+                    return insert(std::move(value));
+                }
+                std::pair<const_iterator, bool> insert(T const &value)
+                {
+                    return insertImpl(value);
+                }
+                std::pair<const_iterator, bool> insert(T &&value)
+                {
+                    return insertImpl(std::move(value));
+                }
+
+                // Heterogeneous lookup: K is anything Hash and Eq accept , e.g. std::string_view for Customer
+                template <typename K>
+                const_iterator find(K const &key) const
+                {
+                    return {this, findIndex(key, mix(hash_(key)))};
+                }
+                template <typename K>
+                bool contains(K const &key) const
+                {
+                    return findIndex(key, mix(hash_(key))) != capacity_;
+                }
+                template <typename K>
+                size_type erase(K const &key)
+                {
+                    auto index = findIndex(key, mix(hash_(key)));
+                    if (index == capacity_)
+                        return 0;
+                    slots_[index].~T();
+                    // If no window of groupWidth slots around index was ever full , no probe went past this slot ,
+                    // so it can become empty again instead of a tombstone
+                    auto before = Group(controls_ + ((index - groupWidth) & mask())).matchEmpty();
+                    auto after = Group(controls_ + index).matchEmpty();
+                    auto wasNeverFull = before && after && lowestBit(after) + (groupWidth - 1 - highestBit(before)) < groupWidth;
+                    setControl(index, wasNeverFull ? emptyControl : deletedControl);
+                    if (wasNeverFull)
+                        ++growthLeft_;
+                    --size_;
+                    return 1;
+                }
+
+                void clear() noexcept
+                {
+                    destroyStorage();
+                    capacity_ = size_ = growthLeft_ = 0;
+                    controls_ = emptyGroup();
+                    slots_ = nullptr;
+                    hashes_ = nullptr;
+                }
+                // Make room for count elements without rehashing
+                void reserve(size_type count)
+                {
+                    if (count > capacity_ - capacity_ / 8)
+                    {
+                        size_type capacity = groupWidth;
+                        while (count > capacity - capacity / 8)
+                            capacity *= 2;
+                        if (capacity > capacity_)
+                            rehash(capacity);
+                    }
+                }
+
+            private:
+                static unsigned highestBit(unsigned mask)
+                {
+                    unsigned index = 0;
+                    while (mask >>= 1)
+                        ++index;
+                    return index;
+                }
+                // Spread the entropy of weak hashes (e.g. std::hash<int> is the identity) over all the bits
+                static std::size_t mix(std::size_t hash)
+                {
+                    auto mixed = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+                    return static_cast<std::size_t>(mixed ^ (mixed >> 32));
+                }
+                static Control fingerprint(std::size_t hash)
+                {
+                    return static_cast<Control>(hash & 0x7F);
+                }
+                static Control *emptyGroup()
+                {
+                    alignas(16) static Control const group[groupWidth] = {emptyControl, emptyControl, emptyControl, emptyControl, emptyControl, emptyControl,
+                                                                          emptyControl, emptyControl, emptyControl, emptyControl, emptyControl, emptyControl,
+                                                                          emptyControl, emptyControl, emptyControl, emptyControl};
+                    return const_cast<Control *>(group); // never written , capacity is 0
+                }
+                std::size_t mask() const
+                {
+                    return capacity_ - 1;
+                }
+                // The first groupWidth control bytes are mirrored after the last one , so any group load is in bounds
+                void setControl(std::size_t index, Control control)
+                {
+                    controls_[index] = control;
+                    if (index < groupWidth)
+                        controls_[capacity_ + index] = control;
+                }
+                std::size_t nextFull(std::size_t index) const
+                {
+                    while (index < capacity_ && controls_[index] < 0)
+                        ++index;
+                    return index;
+                }
+
+                template <typename K>
+                std::size_t findIndex(K const &key, std::size_t hash) const
+                {
+                    if (!capacity_)
+                        return capacity_;
+                    auto print = fingerprint(hash);
+                    auto position = (hash >> 7) & mask();
+                    for (std::size_t step = groupWidth;; step += groupWidth)
+                    {
+                        Group group(controls_ + position);
+                        for (auto matches = group.match(print); matches; matches &= matches - 1)
+                        {
+                            auto index = (position + lowestBit(matches)) & mask();
+                            if (hashes_[index] == hash && eq_(slots_[index], key))
+                                return index;
+                        }
+                        if (group.matchEmpty())
+                            return capacity_;
+                        position = (position + step) & mask(); // triangular probing visits every group once
+                    }
+                }
+                // First empty or deleted slot on the probe sequence of hash
+                std::size_t findFree(std::size_t hash) const
+                {
+                    auto position = (hash >> 7) & mask();
+                    for (std::size_t step = groupWidth;; step += groupWidth)
+                    {
+                        if (auto free = Group(controls_ + position).matchEmptyOrDeleted())
+                            return (position + lowestBit(free)) & mask();
+                        position = (position + step) & mask();
+                    }
+                }
+
+                template <typename V>
+                std::pair<const_iterator, bool> insertImpl(V &&value)
+                {
+                    auto hash = mix(hash_(value));
+                    auto index = findIndex(value, hash);
+                    if (index != capacity_)
+                        return {{this, index}, false};
+                    return {{this, insertUnique(std::forward<V>(value), hash)}, true};
+                }
+                template <typename V>
+                std::size_t insertUnique(V &&value, std::size_t hash)
+                {
+                    if (!growthLeft_)
+                        rehash(capacity_ && size_ < capacity_ / 2 ? capacity_ : std::max(capacity_ * 2, groupWidth)); // drop tombstones or grow
+                    return placeUnique(std::forward<V>(value), hash);
+                }
+                // Needs growthLeft_ > 0 , the set is unchanged if the constructor of T throws
+                template <typename V>
+                std::size_t placeUnique(V &&value, std::size_t hash)
+                {
+                    auto index = findFree(hash);
+                    ::new (static_cast<void *>(slots_ + index)) T(std::forward<V>(value));
+                    if (controls_[index] == emptyControl)
+                        --growthLeft_;
+                    hashes_[index] = hash;
+                    setControl(index, fingerprint(hash));
+                    ++size_;
+                    return index;
+                }
+
+                /**
+                 * NOTE strong guarantee: the new table is built aside and only swapped in once it is complete ,
+                 * a throwing allocation or copy leaves *this as it was (move_if_noexcept only moves when moving
+                 * cannot throw)
+                 */
+                void rehash(std::size_t capacity)
+                {
+                    FlatHashSet fresh(hash_, eq_);
+                    fresh.allocateStorage(capacity);
+                    for (auto index = nextFull(0); index < capacity_; index = nextFull(index + 1))
+                        fresh.placeUnique(std::move_if_noexcept(slots_[index]), hashes_[index]);
+                    swapStorage(fresh);
+                }
+                // All three arrays or none , on an empty set
+                void allocateStorage(std::size_t capacity)
+                {
+                    auto controls = static_cast<Control *>(::operator new(capacity + groupWidth));
+                    T *slots = nullptr;
+                    std::size_t *hashes = nullptr;
+                    try
+                    {
+                        slots = static_cast<T *>(::operator new(capacity * sizeof(T), std::align_val_t(alignof(T))));
+                        hashes = static_cast<std::size_t *>(::operator new(capacity * sizeof(std::size_t)));
+                    }
+                    catch (...)
+                    {
+                        if (slots)
+                            ::operator delete(slots, std::align_val_t(alignof(T)));
+                        ::operator delete(controls);
+                        throw;
+                    }
+                    std::memset(controls, static_cast<unsigned char>(emptyControl), capacity + groupWidth);
+                    controls_ = controls;
+                    slots_ = slots;
+                    hashes_ = hashes;
+                    capacity_ = capacity;
+                    growthLeft_ = capacity - capacity / 8; // maximum load factor of 7/8
+                }
+
+                void swapStorage(FlatHashSet &other) noexcept
+                {
+                    std::swap(controls_, other.controls_);
+                    std::swap(slots_, other.slots_);
+                    std::swap(hashes_, other.hashes_);
+                    std::swap(capacity_, other.capacity_);
+                    std::swap(size_, other.size_);
+                    std::swap(growthLeft_, other.growthLeft_);
+                }
+                void destroyStorage() noexcept
+                {
+                    if (!capacity_)
+                        return;
+                    if constexpr (!std::is_trivially_destructible_v<T>)
+                        for (auto index = nextFull(0); index < capacity_; index = nextFull(index + 1))
+                            slots_[index].~T();
+                    ::operator delete(controls_);
+                    ::operator delete(slots_, std::align_val_t(alignof(T)));
+                    ::operator delete(hashes_);
+                }
+
+                Hash hash_;
+                Eq eq_;
+                Control *controls_ = emptyGroup();
+                T *slots_ = nullptr;
+                std::size_t *hashes_ = nullptr;
+                std::size_t capacity_ = 0;
+                std::size_t size_ = 0;
+                std::size_t growthLeft_ = 0;
+            };
+
+        } // namespace variadicBaseClassAndUsing
+
+    } // namespace chapter4
+
+} // namespace TemplateCompleteGuide
+
+#endif
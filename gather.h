@@ -0,0 +1,274 @@
+#ifndef GATHER_H
+#define GATHER_H
+
+#pragma once
+
+#include "platform.h"
+#include "std.h"
+#include <iterator>
+
+// Validate the indices of gather / scatter , on by default in debug builds only
+#if !defined(TCG_GATHER_BOUNDS_CHECK)
+#if defined(NDEBUG)
+#define TCG_GATHER_BOUNDS_CHECK 0
+#else
+#define TCG_GATHER_BOUNDS_CHECK 1
+#endif
+#endif
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter4
+    {
+        namespace variadicIndices
+        {
+            /**
+             * NOTE 9.2.2 printElements and printIndex at scale: gather and scatter
+             *  - gather(source, indices, out)        out[i] = source[indices[i]]
+             *  - scatter(values, indices, dest)      dest[indices[i]] = values[i] , the last one wins on duplicates
+             *  - gatherIndex<idx...>(container)      fixed indices , fully unrolled
+             * With int indices over int , float or double the runtime versions use the AVX2 / AVX-512 gather
+             * (and AVX-512 scatter) instructions of the running CPU , any other combination a scalar loop which
+             * prefetches the elements a few iterations ahead.
+             *
+             * NOTICE Indices are validated only when TCG_GATHER_BOUNDS_CHECK is 1 , the default without NDEBUG ,
+             * in which case an out of range index throws std::out_of_range before anything is written
+             */
+            namespace gatherKernels
+            {
+                template <typename T, typename Index>
+                constexpr bool isVectorizable = std::is_same_v<Index, int> && (std::is_same_v<T, int> || std::is_same_v<T, float> || std::is_same_v<T, double>);
+
+                // How many indices ahead the scalar loops prefetch , far enough to cover a cache miss
+                constexpr std::size_t prefetchDistance = 16;
+
+                template <typename Index>
+                constexpr bool isNegative(Index index)
+                {
+                    if constexpr (std::is_signed_v<Index>)
+                        return index < 0;
+                    else
+                        return false;
+                }
+                template <typename Index>
+                void checkBounds(Index const *indices, std::size_t count, std::size_t size)
+                {
+                    for (std::size_t i = 0; i < count; ++i)
+                        if (isNegative(indices[i]) || static_cast<std::size_t>(indices[i]) >= size)
+                            throw std::out_of_range("gather/scatter index " + std::to_string(indices[i]) + " out of range " + std::to_string(size));
+                }
+
+                template <typename T, typename Index>
+                void gatherScalar(T const *source, Index const *indices, std::size_t count, T *out)
+                {
+                    std::size_t i = 0;
+                    for (; i + prefetchDistance < count; ++i)
+                    {
+                        platform::prefetch(source + indices[i + prefetchDistance]);
+                        out[i] = source[indices[i]];
+                    }
+                    for (; i < count; ++i)
+                        out[i] = source[indices[i]];
+                }
+                template <typename T, typename Index>
+                void scatterScalar(T const *values, Index const *indices, std::size_t count, T *dest)
+                {
+                    std::size_t i = 0;
+                    for (; i + prefetchDistance < count; ++i)
+                    {
+                        platform::prefetch(dest + indices[i + prefetchDistance]);
+                        dest[indices[i]] = values[i];
+                    }
+                    for (; i < count; ++i)
+                        dest[indices[i]] = values[i];
+                }
+
+#if defined(TCG_SIMD_X86)
+                struct Avx2
+                {
+                    static constexpr std::size_t width = 32; // bytes per vector
+
+                    TCG_TARGET_AVX2 static void gather(int const *source, int const *indices, int *out)
+                    {
+                        auto index = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(indices));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_i32gather_epi32(source, index, 4));
+                    }
+                    TCG_TARGET_AVX2 static void gather(float const *source, int const *indices, float *out)
+                    {
+                        auto index = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(indices));
+                        _mm256_storeu_ps(out, _mm256_i32gather_ps(source, index, 4));
+                    }
+                    TCG_TARGET_AVX2 static void gather(double const *source, int const *indices, double *out)
+                    {
+                        // The masked form with a zero source: the unmasked one leaves GCC a "may be used uninitialized" source
+                        auto index = _mm_loadu_si128(reinterpret_cast<__m128i const *>(indices));
+                        auto all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+                        _mm256_storeu_pd(out, _mm256_mask_i32gather_pd(_mm256_setzero_pd(), source, index, all, 8));
+                    }
+                };
+                struct Avx512
+                {
+                    static constexpr std::size_t width = 64; // bytes per vector
+
+                    TCG_TARGET_AVX512 static void gather(int const *source, int const *indices, int *out)
+                    {
+                        _mm512_storeu_si512(out, _mm512_i32gather_epi32(_mm512_loadu_si512(indices), source, 4));
+                    }
+                    TCG_TARGET_AVX512 static void gather(float const *source, int const *indices, float *out)
+                    {
+                        _mm512_storeu_ps(out, _mm512_i32gather_ps(_mm512_loadu_si512(indices), source, 4));
+                    }
+                    TCG_TARGET_AVX512 static void gather(double const *source, int const *indices, double *out)
+                    {
+                        auto index = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(indices));
+                        _mm512_storeu_pd(out, _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, index, source, 8)); // see Avx2
+                    }
+                    // Lanes with the same index are written in lane order , so the last one wins like the scalar loop
+                    TCG_TARGET_AVX512 static void scatter(int const *values, int const *indices, int *dest)
+                    {
+                        _mm512_i32scatter_epi32(dest, _mm512_loadu_si512(indices), _mm512_loadu_si512(values), 4);
+                    }
+                    TCG_TARGET_AVX512 static void scatter(float const *values, int const *indices, float *dest)
+                    {
+                        _mm512_i32scatter_ps(dest, _mm512_loadu_si512(indices), _mm512_loadu_ps(values), 4);
+                    }
+                    TCG_TARGET_AVX512 static void scatter(double const *values, int const *indices, double *dest)
+                    {
+                        auto index = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(indices));
+                        _mm512_i32scatter_pd(dest, index, _mm512_loadu_pd(values), 8);
+                    }
+                };
+
+                template <typename T>
+                TCG_TARGET_AVX2 void gatherAvx2(T const *source, int const *indices, std::size_t count, T *out)
+                {
+                    constexpr std::size_t lanes = Avx2::width / sizeof(T);
+                    std::size_t i = 0;
+                    for (; i + lanes <= count; i += lanes)
+                        Avx2::gather(source, indices + i, out + i);
+                    gatherScalar(source, indices + i, count - i, out + i);
+                }
+                template <typename T>
+                TCG_TARGET_AVX512 void gatherAvx512(T const *source, int const *indices, std::size_t count, T *out)
+                {
+                    constexpr std::size_t lanes = Avx512::width / sizeof(T);
+                    std::size_t i = 0;
+                    for (; i + lanes <= count; i += lanes)
+                        Avx512::gather(source, indices + i, out + i);
+                    gatherScalar(source, indices + i, count - i, out + i);
+                }
+                template <typename T>
+                TCG_TARGET_AVX512 void scatterAvx512(T const *values, int const *indices, std::size_t count, T *dest)
+                {
+                    constexpr std::size_t lanes = Avx512::width / sizeof(T);
+                    std::size_t i = 0;
+                    for (; i + lanes <= count; i += lanes)
+                        Avx512::scatter(values + i, indices + i, dest);
+                    scatterScalar(values + i, indices + i, count - i, dest);
+                }
+#endif // TCG_SIMD_X86
+
+            } // namespace gatherKernels
+
+            // out[i] = source[indices[i]] for i in [0 , count) , source holding size elements
+            template <typename T, typename Index>
+            void gather(T const *source, std::size_t size, Index const *indices, std::size_t count, T *out,
+                        platform::SimdLevel level = platform::simdLevel())
+            {
+                static_assert(std::is_integral_v<Index>, "Indices must be integers");
+#if TCG_GATHER_BOUNDS_CHECK
+                gatherKernels::checkBounds(indices, count, size);
+#else
+                (void)size;
+#endif
+                level = std::min(level, platform::simdLevel());
+#if defined(TCG_SIMD_X86)
+                if constexpr (gatherKernels::isVectorizable<T, Index>)
+                {
+                    if (level == platform::SimdLevel::AVX512)
+                        return gatherKernels::gatherAvx512(source, indices, count, out);
+                    if (level == platform::SimdLevel::AVX2)
+                        return gatherKernels::gatherAvx2(source, indices, count, out);
+                }
+#endif
+                (void)level;
+                gatherKernels::gatherScalar(source, indices, count, out);
+            }
+
+            // dest[indices[i]] = values[i] for i in [0 , count) , dest holding size elements
+            template <typename T, typename Index>
+            void scatter(T const *values, Index const *indices, std::size_t count, T *dest, std::size_t size,
+                         platform::SimdLevel level = platform::simdLevel())
+            {
+                static_assert(std::is_integral_v<Index>, "Indices must be integers");
+#if TCG_GATHER_BOUNDS_CHECK
+                gatherKernels::checkBounds(indices, count, size);
+#else
+                (void)size;
+#endif
+                level = std::min(level, platform::simdLevel());
+#if defined(TCG_SIMD_X86)
+                if constexpr (gatherKernels::isVectorizable<T, Index>)
+                {
+                    // AVX2 has no scatter instruction
+                    if (level == platform::SimdLevel::AVX512)
+                        return gatherKernels::scatterAvx512(values, indices, count, dest);
+                }
+#endif
+                (void)level;
+                gatherKernels::scatterScalar(values, indices, count, dest);
+            }
+
+            // Contiguous ranges , e.g. std::vector or std::array: out must hold std::size(indices) elements
+            template <typename Source, typename IndexRange, typename Out>
+            void gather(Source const &source, IndexRange const &indices, Out &out)
+            {
+                assert(std::size(out) >= std::size(indices));
+                gather(std::data(source), std::size(source), std::data(indices), std::size(indices), std::data(out));
+            }
+            template <typename Source, typename IndexRange>
+            auto gather(Source const &source, IndexRange const &indices)
+            {
+                std::vector<std::remove_const_t<std::remove_reference_t<decltype(*std::data(source))>>> out(std::size(indices));
+                gather(source, indices, out);
+                return out;
+            }
+            template <typename Values, typename IndexRange, typename Dest>
+            void scatter(Values const &values, IndexRange const &indices, Dest &dest)
+            {
+                assert(std::size(values) >= std::size(indices));
+                scatter(std::data(values), std::data(indices), std::size(indices), std::data(dest), std::size(dest));
+            }
+
+            // Same as printIndex<idx...> , but collects the elements: one load per index , no loop
+            template <int... idx, typename Container>
+            auto gatherIndex(Container const &container)
+            {
+                using T = std::remove_const_t<std::remove_reference_t<decltype(container[0])>>;
+#if TCG_GATHER_BOUNDS_CHECK
+                if (((idx < 0 || static_cast<std::size_t>(idx) >= std::size(container)) || ...))
+                    throw std::out_of_range("gatherIndex index out of range");
+#endif
+                return std::array<T, sizeof...(idx)>{container[idx]...};
+            }
+            // Indices into a C array or a std::array are checked at compile time
+            template <int... idx, typename T, std::size_t N>
+            std::array<T, sizeof...(idx)> gatherIndex(T const (&container)[N])
+            {
+                static_assert(((idx >= 0 && static_cast<std::size_t>(idx) < N) && ...), "gatherIndex index out of range");
+                return {container[idx]...};
+            }
+            template <int... idx, typename T, std::size_t N>
+            std::array<T, sizeof...(idx)> gatherIndex(std::array<T, N> const &container)
+            {
+                static_assert(((idx >= 0 && static_cast<std::size_t>(idx) < N) && ...), "gatherIndex index out of range");
+                return {container[idx]...};
+            }
+
+        } // namespace variadicIndices
+
+    } // namespace chapter4
+
+} // namespace TemplateCompleteGuide
+
+#endif
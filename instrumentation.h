@@ -0,0 +1,487 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#pragma once
+
+#include "std.h"
+#include "platform.h"
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+// Record the TCG_SCOPED_TIMER , TCG_COUNTER_* and TCG_HISTOGRAM_RECORD of the hot constructs , off by default:
+// disabled , the macros expand to nothing. cmake -DTCG_INSTRUMENT=ON turns them on for the whole build
+#if !defined(TCG_INSTRUMENT)
+#define TCG_INSTRUMENT 0
+#endif
+
+// Lets a constexpr function skip its instrumentation while evaluated by the compiler
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define TCG_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define TCG_CONSTANT_EVALUATED() false // instrumented constexpr functions are then runtime only
+#endif
+
+namespace TemplateCompleteGuide
+{
+    namespace instrumentation
+    {
+        /**
+         * NOTE 1. Hot-path instrumentation
+         * Counters and latency histograms identified by name , registered once per call site and then updated
+         * through a dense id:
+         *  - every thread updates shards of its own , without any lock or read-modify-write instruction
+         *  - reading merges the shards of the live threads with the totals left by the threads that exited
+         * Timers count ticks of platform::ticks() , converted to nanoseconds on read only , against
+         * steady_clock: the hot path pays two tick reads and a few stores per event.
+         *
+         *  void handle()
+         *  {
+         *      TCG_SCOPED_TIMER("server.handle");   // latency histogram of the enclosing scope
+         *      TCG_COUNTER_INC("server.requests");
+         *  }
+         *  instrumentation::writeFile("metrics.prom", instrumentation::writePrometheus);
+         */
+        using MetricId = std::uint32_t;
+
+        enum class Unit : std::uint8_t
+        {
+            None,  // recorded values are reported as they are
+            Ticks, // recorded values are platform::ticks() , reported as durations
+        };
+
+        /**
+         * NOTE 1.1 Log-linear buckets , as in HdrHistogram
+         * Every power of two is split into 16 equal buckets , so that a bucket is at most 1/16 wide relative to its
+         * values: values below 32 have a bucket each , 1000 falls in [992 , 1023] , 1000000 in [983040 , 1048575].
+         * Larger values than maxValue are counted in the last bucket.
+         */
+        struct LogLinearBuckets
+        {
+            static constexpr int subBits = 4;
+            static constexpr std::uint64_t subCount = std::uint64_t(1) << subBits;
+            static constexpr int maxWidth = 44; // about 4.9 hours of nanoseconds
+            static constexpr std::uint64_t maxValue = (std::uint64_t(1) << maxWidth) - 1;
+            static constexpr std::size_t count = (maxWidth - subBits) * subCount + subCount;
+
+            static std::size_t of(std::uint64_t value) noexcept
+            {
+                value = std::min(value, maxValue);
+                auto shift = std::max(platform::bitWidth(value) - subBits - 1, 0);
+                return static_cast<std::size_t>(shift) * subCount + static_cast<std::size_t>(value >> shift);
+            }
+            static constexpr std::uint64_t lowerBound(std::size_t i) noexcept
+            {
+                auto shift = i < 2 * subCount ? 0 : i / subCount - 1;
+                return (i - shift * subCount) << shift;
+            }
+            static constexpr std::uint64_t upperBound(std::size_t i) noexcept
+            {
+                auto shift = i < 2 * subCount ? 0 : i / subCount - 1;
+                return lowerBound(i) + (std::uint64_t(1) << shift) - 1;
+            }
+        };
+
+        // Merged values of one histogram , in nanoseconds for Unit::Ticks
+        struct HistogramSnapshot
+        {
+            std::string name;
+            Unit unit = Unit::None;
+            double scale = 1; // reported units per recorded unit
+            std::uint64_t count = 0, sum = 0, min = ~std::uint64_t(0), max = 0;
+            std::vector<std::uint64_t> buckets = std::vector<std::uint64_t>(LogLinearBuckets::count);
+
+            // Highest value of the bucket holding the value of rank p * count , within [min , max]
+            double percentile(double p) const
+            {
+                if (0 == count)
+                    return 0;
+                auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(p * static_cast<double>(count))));
+                std::uint64_t seen = 0;
+                for (std::size_t i = 0; i < buckets.size(); ++i)
+                    if ((seen += buckets[i]) >= rank)
+                        return scale * static_cast<double>(std::clamp(LogLinearBuckets::upperBound(i), min, max));
+                return scale * static_cast<double>(max);
+            }
+            double mean() const
+            {
+                return count ? scale * static_cast<double>(sum) / static_cast<double>(count) : 0;
+            }
+            double minimum() const
+            {
+                return count ? scale * static_cast<double>(min) : 0;
+            }
+            double maximum() const
+            {
+                return scale * static_cast<double>(max);
+            }
+        };
+
+        struct Snapshot
+        {
+            double nanosecondsPerTick = 1;
+            std::vector<std::pair<std::string, std::uint64_t>> counters;
+            std::vector<HistogramSnapshot> histograms;
+        };
+
+        // NOTE 1.2 The registry of the process: names , per-thread shards and the totals of exited threads
+        class Registry
+        {
+        public:
+            static constexpr std::size_t maxCounters = 256, maxHistograms = 64;
+
+            static Registry &instance()
+            {
+                static Registry registry;
+                return registry;
+            }
+            Registry(Registry const &) = delete;
+            Registry &operator=(Registry const &) = delete;
+
+            // Id of the metric called name , registered on first use; a name keeps the unit it was registered with
+            MetricId counter(std::string_view name)
+            {
+                return define(counters_, maxCounters, name, Unit::None);
+            }
+            MetricId histogram(std::string_view name, Unit unit = Unit::None)
+            {
+                return define(histograms_, maxHistograms, name, unit);
+            }
+
+            static void add(MetricId counter, std::uint64_t value) noexcept
+            {
+                bump(shard().counters[counter], value);
+            }
+            static void record(MetricId histogram, std::uint64_t value)
+            {
+                auto &slot = shard().histograms[histogram];
+                auto mine = slot.load(std::memory_order_relaxed);
+                if (!mine) // first value of this histogram in this thread
+                {
+                    mine = new HistogramShard;
+                    slot.store(mine, std::memory_order_release);
+                }
+                bump(mine->buckets[LogLinearBuckets::of(value)], 1);
+                bump(mine->sum, value);
+                if (value > mine->max.load(std::memory_order_relaxed))
+                    mine->max.store(value, std::memory_order_relaxed);
+                if (value < mine->min.load(std::memory_order_relaxed))
+                    mine->min.store(value, std::memory_order_relaxed);
+            }
+
+            // Ticks against steady_clock since the registry was created , over at least 10ms
+            double nanosecondsPerTick() const
+            {
+                using namespace std::chrono;
+                auto elapsed = steady_clock::now() - startTime_;
+                if (elapsed < milliseconds(10))
+                    std::this_thread::sleep_for(milliseconds(10) - elapsed);
+                auto ticks = platform::ticks();
+                elapsed = steady_clock::now() - startTime_;
+                return ticks > startTicks_ ? static_cast<double>(duration_cast<nanoseconds>(elapsed).count()) / static_cast<double>(ticks - startTicks_) : 1.0;
+            }
+
+            Snapshot snapshot()
+            {
+                Snapshot result;
+                result.nanosecondsPerTick = nanosecondsPerTick();
+                std::lock_guard lock(mutex_);
+                for (std::size_t i = 0; i < counters_.size(); ++i)
+                {
+                    auto total = retired_.counters[i].load(std::memory_order_relaxed);
+                    for (auto each : live_)
+                        total += each->counters[i].load(std::memory_order_relaxed);
+                    result.counters.emplace_back(counters_[i].name, total);
+                }
+                for (std::size_t i = 0; i < histograms_.size(); ++i)
+                {
+                    HistogramSnapshot histogram;
+                    histogram.name = histograms_[i].name;
+                    histogram.unit = histograms_[i].unit;
+                    histogram.scale = Unit::Ticks == histogram.unit ? result.nanosecondsPerTick : 1.0;
+                    merge(retired_.histograms[i].load(std::memory_order_acquire), histogram);
+                    for (auto each : live_)
+                        merge(each->histograms[i].load(std::memory_order_acquire), histogram);
+                    result.histograms.push_back(std::move(histogram));
+                }
+                return result;
+            }
+
+        private:
+            struct Metric
+            {
+                std::string name;
+                Unit unit;
+            };
+            struct HistogramShard
+            {
+                std::atomic<std::uint64_t> buckets[LogLinearBuckets::count] = {};
+                std::atomic<std::uint64_t> sum{0}, min{~std::uint64_t(0)}, max{0};
+            };
+            // Written by its thread only , read by snapshot; a cache line of its own against false sharing
+            struct alignas(64) Shard
+            {
+                std::atomic<std::uint64_t> counters[maxCounters] = {};
+                std::atomic<HistogramShard *> histograms[maxHistograms] = {};
+
+                ~Shard()
+                {
+                    for (auto &each : histograms)
+                        delete each.load(std::memory_order_relaxed);
+                }
+            };
+            // Gives the shard of the thread to the registry and folds it into the totals when the thread exits
+            struct ThreadState
+            {
+                Shard *shard;
+
+                ThreadState() : shard(new Shard)
+                {
+                    auto &registry = instance();
+                    std::lock_guard lock(registry.mutex_);
+                    registry.live_.push_back(shard);
+                }
+                ~ThreadState()
+                {
+                    auto &registry = instance();
+                    {
+                        std::lock_guard lock(registry.mutex_);
+                        registry.live_.erase(std::find(registry.live_.begin(), registry.live_.end(), shard));
+                        fold(*shard, registry.retired_);
+                    }
+                    delete shard;
+                    current_ = nullptr;
+                }
+            };
+
+            Registry() : startTicks_(platform::ticks()), startTime_(std::chrono::steady_clock::now())
+            {
+            }
+
+            // The only writer of an atomic needs no read-modify-write instruction
+            static void bump(std::atomic<std::uint64_t> &value, std::uint64_t amount) noexcept
+            {
+                value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+            }
+            static Shard &shard()
+            {
+                if (!current_) // first metric updated by this thread
+                {
+                    static thread_local ThreadState state;
+                    current_ = state.shard;
+                }
+                return *current_;
+            }
+
+            MetricId define(std::vector<Metric> &metrics, std::size_t capacity, std::string_view name, Unit unit)
+            {
+                std::lock_guard lock(mutex_);
+                auto found = std::find_if(metrics.begin(), metrics.end(), [&](Metric const &each)
+                                          { return each.name == name; });
+                if (found != metrics.end())
+                    return static_cast<MetricId>(found - metrics.begin());
+                if (metrics.size() == capacity)
+                    throw std::length_error("Registry: too many metrics");
+                metrics.push_back({std::string(name), unit});
+                return static_cast<MetricId>(metrics.size() - 1);
+            }
+            // Called under the lock , by the exiting thread: nobody else writes to into
+            static void fold(Shard const &from, Shard &into)
+            {
+                for (std::size_t i = 0; i < maxCounters; ++i)
+                    bump(into.counters[i], from.counters[i].load(std::memory_order_relaxed));
+                for (std::size_t i = 0; i < maxHistograms; ++i)
+                    if (auto histogram = from.histograms[i].load(std::memory_order_relaxed))
+                    {
+                        auto target = into.histograms[i].load(std::memory_order_relaxed);
+                        if (!target)
+                            into.histograms[i].store(target = new HistogramShard, std::memory_order_release);
+                        for (std::size_t b = 0; b < LogLinearBuckets::count; ++b)
+                            bump(target->buckets[b], histogram->buckets[b].load(std::memory_order_relaxed));
+                        bump(target->sum, histogram->sum.load(std::memory_order_relaxed));
+                        target->min.store(std::min(target->min.load(), histogram->min.load()), std::memory_order_relaxed);
+                        target->max.store(std::max(target->max.load(), histogram->max.load()), std::memory_order_relaxed);
+                    }
+            }
+            static void merge(HistogramShard const *from, HistogramSnapshot &into)
+            {
+                if (!from)
+                    return;
+                for (std::size_t b = 0; b < LogLinearBuckets::count; ++b)
+                {
+                    auto count = from->buckets[b].load(std::memory_order_relaxed);
+                    into.buckets[b] += count;
+                    into.count += count;
+                }
+                into.sum += from->sum.load(std::memory_order_relaxed);
+                into.min = std::min(into.min, from->min.load(std::memory_order_relaxed));
+                into.max = std::max(into.max, from->max.load(std::memory_order_relaxed));
+            }
+
+            inline static thread_local Shard *current_ = nullptr;
+
+            std::uint64_t const startTicks_;
+            std::chrono::steady_clock::time_point const startTime_;
+            std::mutex mutex_;
+            std::vector<Metric> counters_, histograms_;
+            std::vector<Shard *> live_;
+            Shard retired_;
+        };
+
+        // Records the ticks from its construction to its destruction
+        class ScopedTimer
+        {
+        public:
+            explicit ScopedTimer(MetricId histogram) noexcept : histogram_(histogram), start_(platform::ticks())
+            {
+            }
+            ScopedTimer(ScopedTimer const &) = delete;
+            ScopedTimer &operator=(ScopedTimer const &) = delete;
+            ~ScopedTimer()
+            {
+                Registry::record(histogram_, platform::ticks() - start_);
+            }
+
+        private:
+            MetricId histogram_;
+            std::uint64_t start_;
+        };
+
+        // NOTE 1.3 Exports
+        namespace detail
+        {
+            inline std::string jsonEscape(std::string_view text)
+            {
+                std::string result;
+                for (auto c : text)
+                {
+                    if ('"' == c || '\\' == c)
+                        result += '\\';
+                    if (static_cast<unsigned char>(c) < 0x20)
+                        result += ' ';
+                    else
+                        result += c;
+                }
+                return result;
+            }
+            // Metric names are [a-zA-Z_:][a-zA-Z0-9_:]* in Prometheus , "chapter4.print" becomes tcg_chapter4_print
+            inline std::string prometheusName(std::string_view name)
+            {
+                std::string result = "tcg_";
+                for (auto c : name)
+                    result += std::isalnum(static_cast<unsigned char>(c)) || '_' == c ? c : '_';
+                return result;
+            }
+            struct Quantile
+            {
+                char const *label, *key;
+                double p;
+            };
+            constexpr Quantile quantiles[] = {{"0.5", "p50", 0.5}, {"0.9", "p90", 0.9}, {"0.99", "p99", 0.99}, {"0.999", "p999", 0.999}};
+        } // namespace detail
+
+        // Durations in nanoseconds
+        inline void writeJson(std::ostream &os, Snapshot const &snapshot)
+        {
+            os << "{\n  \"nanoseconds_per_tick\": " << snapshot.nanosecondsPerTick << ",\n  \"counters\": {";
+            char const *separator = "";
+            for (auto const &[name, value] : snapshot.counters)
+            {
+                os << separator << "\n    \"" << detail::jsonEscape(name) << "\": " << value;
+                separator = ",";
+            }
+            os << "\n  },\n  \"histograms\": {";
+            separator = "";
+            for (auto const &each : snapshot.histograms)
+            {
+                os << separator << "\n    \"" << detail::jsonEscape(each.name) << "\": {\"unit\": \""
+                   << (Unit::Ticks == each.unit ? "ns" : "") << "\", \"count\": " << each.count << ", \"min\": " << each.minimum()
+                   << ", \"mean\": " << each.mean();
+                for (auto const &quantile : detail::quantiles)
+                    os << ", \"" << quantile.key << "\": " << each.percentile(quantile.p);
+                os << ", \"max\": " << each.maximum() << '}';
+                separator = ",";
+            }
+            os << "\n  }\n}\n";
+        }
+
+        // Text exposition format: counters as _total , histograms as summaries , durations in seconds
+        inline void writePrometheus(std::ostream &os, Snapshot const &snapshot)
+        {
+            for (auto const &[name, value] : snapshot.counters)
+            {
+                auto metric = detail::prometheusName(name) + "_total";
+                os << "# TYPE " << metric << " counter\n"
+                   << metric << ' ' << value << '\n';
+            }
+            for (auto const &each : snapshot.histograms)
+            {
+                auto seconds = Unit::Ticks == each.unit;
+                auto metric = detail::prometheusName(each.name) + (seconds ? "_seconds" : "");
+                auto scale = seconds ? 1e-9 : 1.0;
+                os << "# TYPE " << metric << " summary\n";
+                for (auto const &quantile : detail::quantiles)
+                    os << metric << "{quantile=\"" << quantile.label << "\"} " << scale * each.percentile(quantile.p) << '\n';
+                os << metric << "_sum " << scale * each.scale * static_cast<double>(each.sum) << '\n'
+                   << metric << "_count " << each.count << '\n';
+            }
+        }
+
+        // Write a snapshot of the registry to a temporary file renamed over path , so that a collector never
+        // reads half of it , e.g. the textfile collector of the Prometheus node exporter
+        inline bool writeFile(std::string const &path, void (*writer)(std::ostream &, Snapshot const &))
+        {
+            auto temporary = path + ".tmp";
+            {
+                std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+                if (!file)
+                    return false;
+                writer(file, Registry::instance().snapshot());
+                if (!file.flush())
+                    return false;
+            }
+#if defined _WIN32
+            std::remove(path.c_str()); // rename does not replace there
+#endif
+            return 0 == std::rename(temporary.c_str(), path.c_str());
+        }
+
+    } // namespace instrumentation
+
+} // namespace TemplateCompleteGuide
+
+// NOTE 1.4 The macros: the id of a metric is looked up once per call site (and per template instantiation)
+#if TCG_INSTRUMENT
+#define TCG_INSTRUMENT_CONCAT_IMPL(a, b) a##b
+#define TCG_INSTRUMENT_CONCAT(a, b) TCG_INSTRUMENT_CONCAT_IMPL(a, b)
+#define TCG_METRIC_ID(kind, ...)                                                                                                \
+    []                                                                                                                          \
+    {                                                                                                                           \
+        static auto const id = ::TemplateCompleteGuide::instrumentation::Registry::instance().kind(__VA_ARGS__);                \
+        return id;                                                                                                              \
+    }()
+// Latency of the rest of the enclosing scope , not for constexpr functions
+#define TCG_SCOPED_TIMER(name)                                                                                                  \
+    ::TemplateCompleteGuide::instrumentation::ScopedTimer TCG_INSTRUMENT_CONCAT(tcgScopedTimer, __LINE__)(                      \
+        TCG_METRIC_ID(histogram, name, ::TemplateCompleteGuide::instrumentation::Unit::Ticks))
+#define TCG_COUNTER_ADD(name, value)                                                                                            \
+    (TCG_CONSTANT_EVALUATED() ? void()                                                                                          \
+                              : ::TemplateCompleteGuide::instrumentation::Registry::add(TCG_METRIC_ID(counter, name),           \
+                                                                                        static_cast<std::uint64_t>(value)))
+#define TCG_HISTOGRAM_RECORD(name, value)                                                                                       \
+    (TCG_CONSTANT_EVALUATED() ? void()                                                                                          \
+                              : ::TemplateCompleteGuide::instrumentation::Registry::record(TCG_METRIC_ID(histogram, name),      \
+                                                                                           static_cast<std::uint64_t>(value)))
+#else
+#define TCG_SCOPED_TIMER(name) static_cast<void>(0)
+#define TCG_COUNTER_ADD(name, value) static_cast<void>(0)
+#define TCG_HISTOGRAM_RECORD(name, value) static_cast<void>(0)
+#endif
+#define TCG_COUNTER_INC(name) TCG_COUNTER_ADD(name, 1)
+
+#endif
@@ -0,0 +1,353 @@
+#ifndef INTERNED_STRING_H
+#define INTERNED_STRING_H
+
+#pragma once
+
+#include "template_complete_guide.h"
+#include <cstddef>
+#include <limits>
+#include <shared_mutex>
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter2
+    {
+        /**
+         * NOTE 2.1 Interned strings
+         * The deduction guides above turn every literal into a std::string of its own. Interned , every distinct
+         * text is stored once in the bump arena of a StringPool , next to its hash , and an InternedString is a
+         * pointer to it: copying , hashing and comparing are O(1) whatever the length.
+         *
+         * NOTICE handles compare equal only when they come from the same pool , and live as long as it does
+         */
+        class StringPool;
+
+        class InternedString
+        {
+        public:
+            // The empty string , shared by every pool
+            InternedString() noexcept : entry_(&emptyEntry)
+            {
+            }
+
+            std::string_view view() const noexcept
+            {
+                return {entry_->text, entry_->size};
+            }
+            operator std::string_view() const noexcept
+            {
+                return view();
+            }
+            char const *c_str() const noexcept
+            {
+                return entry_->text;
+            }
+            std::size_t size() const noexcept
+            {
+                return entry_->size;
+            }
+            bool empty() const noexcept
+            {
+                return 0 == entry_->size;
+            }
+            std::size_t hash() const noexcept
+            {
+                return entry_->hash;
+            }
+            // Dense number of the string in its pool , e.g. to index a side table
+            std::uint32_t id() const noexcept
+            {
+                return entry_->id;
+            }
+
+            friend bool operator==(InternedString lhs, InternedString rhs) noexcept
+            {
+                return lhs.entry_ == rhs.entry_;
+            }
+            friend bool operator!=(InternedString lhs, InternedString rhs) noexcept
+            {
+                return lhs.entry_ != rhs.entry_;
+            }
+            friend std::ostream &operator<<(std::ostream &os, InternedString text)
+            {
+                return os << text.view();
+            }
+
+        private:
+            friend class StringPool;
+
+            // Stored in the arena , the characters follow the header
+            struct Entry
+            {
+                std::size_t hash;
+                std::uint32_t id;
+                std::uint32_t size;
+                char text[1]; // null-terminated
+            };
+            inline static Entry const emptyEntry{std::hash<std::string_view>()({}), 0, 0, {'\0'}};
+
+            explicit InternedString(Entry const *entry) noexcept : entry_(entry)
+            {
+            }
+
+            Entry const *entry_;
+        };
+
+        /**
+         * NOTE 2.2 Lazy concatenation
+         * comment + value on interned strings builds a Rope , a tree of views , instead of a new string: it is
+         * streamed piece by piece , or copied once into a buffer of the exact size by str() or StringPool::intern.
+         *
+         * NOTICE a Rope holds views , like ArrayExpression it is meant to be consumed by the full expression
+         * that builds it
+         */
+        template <typename L, typename R>
+        class Rope;
+
+        template <typename T>
+        struct IsRopePiece : std::is_convertible<T const &, std::string_view>
+        {
+        };
+        template <typename L, typename R>
+        struct IsRopePiece<Rope<L, R>> : std::true_type
+        {
+        };
+        template <typename T>
+        constexpr bool isRope = false;
+        template <typename L, typename R>
+        constexpr bool isRope<Rope<L, R>> = true;
+
+        // Ropes keep ropes and interned strings , and views of anything else
+        template <typename T>
+        using RopePiece = std::conditional_t<isRope<T> || std::is_same_v<T, InternedString>, T, std::string_view>;
+
+        template <typename L, typename R>
+        class Rope
+        {
+        public:
+            Rope(L left, R right) noexcept : left_(left), right_(right), size_(sizeOf(left) + sizeOf(right))
+            {
+            }
+
+            std::size_t size() const noexcept
+            {
+                return size_;
+            }
+            // Copy the characters to out , which has room for size() of them , returns the end
+            char *copy(char *out) const noexcept
+            {
+                return copyOf(right_, copyOf(left_, out));
+            }
+            std::string str() const
+            {
+                std::string result(size_, '\0');
+                copy(result.data());
+                return result;
+            }
+
+            friend std::ostream &operator<<(std::ostream &os, Rope const &rope)
+            {
+                return os << rope.left_ << rope.right_;
+            }
+
+        private:
+            template <typename T>
+            static std::size_t sizeOf(T const &piece) noexcept
+            {
+                if constexpr (isRope<T>)
+                    return piece.size();
+                else
+                    return std::string_view(piece).size();
+            }
+            template <typename T>
+            static char *copyOf(T const &piece, char *out) noexcept
+            {
+                if constexpr (isRope<T>)
+                    return piece.copy(out);
+                else
+                {
+                    auto text = std::string_view(piece);
+                    std::memcpy(out, text.data(), text.size());
+                    return out + text.size();
+                }
+            }
+
+            L left_;
+            R right_;
+            std::size_t size_;
+        };
+
+        // At least one side is interned or already a rope , so that std::string + std::string is left alone
+        template <typename L, typename R,
+                  typename = std::enable_if_t<IsRopePiece<L>::value && IsRopePiece<R>::value &&
+                                              (isRope<L> || isRope<R> || std::is_same_v<L, InternedString> || std::is_same_v<R, InternedString>)>>
+        Rope<RopePiece<L>, RopePiece<R>> operator+(L const &left, R const &right) noexcept
+        {
+            return {RopePiece<L>(left), RopePiece<R>(right)};
+        }
+
+        /**
+         * NOTE 2.3 The pool: a bump arena of entries and an open-addressing table of them
+         * Lookups share a lock , insertions take it exclusively , as FlyweightFactory does. The arena grows by
+         * blocks that never move , so handles stay valid until the pool is destroyed.
+         */
+        class StringPool
+        {
+            using Entry = InternedString::Entry;
+
+        public:
+            StringPool() = default;
+            StringPool(StringPool const &) = delete;
+            StringPool &operator=(StringPool const &) = delete;
+
+            // Pool of the _interned literals
+            static StringPool &global()
+            {
+                static StringPool pool;
+                return pool;
+            }
+
+            InternedString intern(std::string_view text)
+            {
+                auto hash = std::hash<std::string_view>()(text);
+                {
+                    std::shared_lock lock(mutex_);
+                    if (auto found = find(text, hash))
+                        return InternedString(found);
+                }
+                if (text.empty())
+                    return {};
+                std::lock_guard lock(mutex_);
+                if (auto found = find(text, hash)) // interned by another thread meanwhile
+                    return InternedString(found);
+                return InternedString(insert(text, hash));
+            }
+            // Short ropes are put together on the stack , longer ones in one exact-size string
+            template <typename L, typename R>
+            InternedString intern(Rope<L, R> const &rope)
+            {
+                char buffer[256];
+                if (rope.size() <= sizeof(buffer))
+                    return intern(std::string_view(buffer, static_cast<std::size_t>(rope.copy(buffer) - buffer)));
+                return intern(std::string_view(rope.str()));
+            }
+
+            std::size_t size() const
+            {
+                std::shared_lock lock(mutex_);
+                return count_;
+            }
+            // Memory held by the pool: arena blocks and table
+            std::size_t bytes() const
+            {
+                std::shared_lock lock(mutex_);
+                return arenaBytes_ + table_.capacity() * sizeof(Entry const *);
+            }
+
+        private:
+            static constexpr std::size_t blockSize = 64 * 1024;
+
+            Entry const *find(std::string_view text, std::size_t hash) const noexcept
+            {
+                if (table_.empty())
+                    return text.empty() ? &InternedString::emptyEntry : nullptr;
+                auto mask = table_.size() - 1;
+                for (auto i = hash & mask;; i = (i + 1) & mask)
+                {
+                    auto entry = table_[i];
+                    if (!entry)
+                        return text.empty() ? &InternedString::emptyEntry : nullptr;
+                    if (entry->hash == hash && std::string_view(entry->text, entry->size) == text)
+                        return entry;
+                }
+            }
+            Entry const *insert(std::string_view text, std::size_t hash)
+            {
+                if (text.size() > std::numeric_limits<std::uint32_t>::max() || count_ == std::numeric_limits<std::uint32_t>::max())
+                    throw std::length_error("StringPool: string or pool too large");
+                if (2 * (count_ + 1) > table_.size())
+                    rehash(std::max<std::size_t>(64, 2 * table_.size()));
+                auto entry = static_cast<Entry *>(allocate(offsetof(Entry, text) + text.size() + 1));
+                entry->hash = hash;
+                entry->id = static_cast<std::uint32_t>(++count_);
+                entry->size = static_cast<std::uint32_t>(text.size());
+                std::memcpy(entry->text, text.data(), text.size());
+                entry->text[text.size()] = '\0';
+                place(entry);
+                return entry;
+            }
+            void place(Entry const *entry) noexcept
+            {
+                auto mask = table_.size() - 1;
+                auto i = entry->hash & mask;
+                while (table_[i])
+                    i = (i + 1) & mask;
+                table_[i] = entry;
+            }
+            void rehash(std::size_t slots)
+            {
+                std::vector<Entry const *> old(slots, nullptr);
+                old.swap(table_);
+                for (auto entry : old)
+                    if (entry)
+                        place(entry);
+            }
+            // Bump allocation , a string larger than a block gets a block of its own
+            void *allocate(std::size_t size)
+            {
+                size = (size + alignof(Entry) - 1) / alignof(Entry) * alignof(Entry);
+                if (static_cast<std::size_t>(end_ - cursor_) < size)
+                {
+                    auto bytes = std::max(size, blockSize);
+                    blocks_.push_back(std::make_unique<Block[]>(bytes / sizeof(Block) + 1));
+                    arenaBytes_ += bytes;
+                    cursor_ = reinterpret_cast<char *>(blocks_.back().get());
+                    end_ = cursor_ + bytes;
+                }
+                return std::exchange(cursor_, cursor_ + size);
+            }
+
+            struct alignas(Entry) Block
+            {
+                char bytes[alignof(Entry)];
+            };
+
+            mutable std::shared_mutex mutex_;
+            std::vector<std::unique_ptr<Block[]>> blocks_;
+            char *cursor_ = nullptr, *end_ = nullptr;
+            std::vector<Entry const *> table_;
+            std::size_t count_ = 0, arenaBytes_ = 0;
+        };
+
+        // NOTE 2.4 Opting in: "text"_interned is an InternedString of the global pool
+        namespace literals
+        {
+            inline InternedString operator""_interned(char const *text, std::size_t size)
+            {
+                return StringPool::global().intern(std::string_view(text, size));
+            }
+        } // namespace literals
+
+        // Deduction guides , the interned counterparts of the ones of Stack and ValueWithComment
+        Stack(InternedString)->Stack<InternedString>;
+        template <typename T>
+        ValueWithComment(T, InternedString) -> ValueWithComment<T, InternedString>;
+
+    } // namespace chapter2
+
+} // namespace TemplateCompleteGuide
+
+// Hash tables keyed by interned strings reuse the precomputed hash
+namespace std
+{
+    template <>
+    struct hash<TemplateCompleteGuide::chapter2::InternedString>
+    {
+        std::size_t operator()(TemplateCompleteGuide::chapter2::InternedString text) const noexcept
+        {
+            return text.hash();
+        }
+    };
+} // namespace std
+
+#endif
@@ -1,6 +1,27 @@
 #include "utils.h"
 #include "template_complete_guide.h"
 #include "cpp_features.h"
+#include "array_expression.h"
+#include "operation_vm.h"
+#include "buffered_print.h"
+#include "static_dispatch.h"
+#include "node_arena.h"
+#include "batched_traverse.h"
+#include "simd_reduce.h"
+#include "flat_hash_set.h"
+#include "concurrent_hash_set.h"
+#include "tuple_variant.h"
+#include "columns.h"
+#include "gather.h"
+#include "algorithm_in_cpp.h"
+#include "design_pattern.h"
+#include "concurrent_stack.h"
+#include "async_log.h"
+#include "interned_string.h"
+#include "terminal.h"
+#include "instrumentation.h"
+#include <filesystem>
+#include <fstream>
 
 int main()
 {
@@ -13,6 +34,32 @@ int main()
         Operation<Operators::Mut> operationMutiple;
         auto theSum = operationMutiple(1, 5L);
         assert(5 == theSum);
+        {
+            // Lazy expression over arrays , evaluated by one fused loop on assignment
+            std::vector<double> a = {1, 2, 3, 4}, b = {2, 2, 2, 2}, c = {1, 1, 1, 1}, d = {0, 1, 2, 3}, result(4);
+            ArrayView<double> out(result);
+            auto expression = ArrayView(a) * ArrayView(b) + ArrayView(c) - ArrayView(d);
+            static_assert(std::is_same_v<decltype(expression), ArrayExpression<Operators::Sub, ArrayExpression<Operators::Add, ArrayExpression<Operators::Mut, ArrayView<double>, ArrayView<double>>, ArrayView<double>>, ArrayView<double>>>);
+            out = expression;
+            assert((result == std::vector<double>{3, 4, 5, 6}));
+            evaluateParallel(out, operationMutiple(ArrayView(result), 0.5) / 2, 2, 1);
+            assert((result == std::vector<double>{0.75, 1, 1.25, 1.5}));
+        }
+        {
+            // Formula known at runtime: r3 = (r0 * r1 + r2) / r1
+            using namespace vm;
+            Program formula({{Operators::Mut, 3, 0, 1}, {Operators::Add, 3, 3, 2}, {Operators::Div, 3, 3, 1}}, 4);
+            double registers[4] = {3, 2, 4, 0};
+            execute(formula, registers);
+            assert(5 == registers[3]);
+            std::vector<double> x(3000, 3), y(3000, 2), z(3000, 4), formulaResult(3000);
+            evaluateColumns<double>(formula, {x.data(), y.data(), z.data()}, formulaResult.data(), formulaResult.size(), 3);
+            assert(std::all_of(formulaResult.begin(), formulaResult.end(), [](double v) { return 5 == v; }));
+            // Integers over a partial last batch: the rows past the input are not divided
+            std::vector<int> dividends(1027, 7), divisors(1027, 2), quotients(1027);
+            evaluateColumns<int>(Program({{Operators::Div, 2, 0, 1}}, 3), {dividends.data(), divisors.data()}, quotients.data(), quotients.size(), 2);
+            assert(std::all_of(quotients.begin(), quotients.end(), [](int v) { return 3 == v; }));
+        }
     }
 
     // chapter2
@@ -24,11 +71,85 @@ int main()
             auto holder = std::shared_ptr<std::remove_pointer_t<decltype(stringStack)>>(stringStack);
             holder->showElementType();
         }
+        // Small-buffer optimization , move-only elements
+        {
+            Stack<std::unique_ptr<int>, 2> pointers;
+            for (auto i = 0; i < 5; ++i)
+                pointers.emplace(std::make_unique<int>(i));
+            assert(!pointers.isInline() && 5 == pointers.size() && 4 == *pointers.top());
+            auto moved = std::move(pointers);
+            while (moved.size() > 2)
+                moved.pop();
+            moved.shrink_to_fit();
+            assert(moved.isInline() && 1 == *moved.top() && pointers.empty());
+        }
+        // Lock-free stack: producers and consumers at once , every value must come out exactly once
+        {
+            ConcurrentStack names{"vvvv"};
+            auto name = names.try_pop();
+            auto none = names.try_pop();
+            assert(name && "vvvv" == *name && !none);
+
+            constexpr int producers = 4, perProducer = 20000;
+            ConcurrentStack<int> values;
+            std::vector<std::atomic<int>> seen(producers * perProducer);
+            std::atomic<int> popped{0};
+            auto consume = [&]
+            {
+                int batch[17]; // up to 16 from try_pop_batch , one more from try_pop
+                while (popped.load() < producers * perProducer)
+                {
+                    auto count = static_cast<int>(values.try_pop_batch(batch, 1 + popped.load() % 16));
+                    if (auto one = values.try_pop())
+                        batch[count++] = *one;
+                    for (auto i = 0; i < count; ++i)
+                        seen[batch[i]].fetch_add(1);
+                    popped.fetch_add(count);
+                }
+            };
+            std::vector<std::thread> threads;
+            for (auto p = 0; p < producers; ++p)
+                threads.emplace_back([&, p]
+                                     {
+                                         for (auto i = 0; i < perProducer; i += 4)
+                                         {
+                                             auto first = p * perProducer + i;
+                                             values.push(first);
+                                             int rest[] = {first + 1, first + 2, first + 3};
+                                             values.push_batch(std::begin(rest), std::end(rest));
+                                         }
+                                     });
+            for (auto c = 0; c < 3; ++c)
+                threads.emplace_back(consume);
+            for (auto &thread : threads)
+                thread.join();
+            assert(values.empty() && 0 == values.size() && std::all_of(seen.begin(), seen.end(), [](auto const &count) { return 1 == count.load(); }));
+        }
         // Templatized aggregates
         {
             auto valueWithComment = ValueWithComment{"Nice", "Person"};
             std::cout << valueWithComment.comment + valueWithComment.value << std::endl;
         }
+        // Interned: both texts stored once in the global pool , the concatenation is a rope of views
+        {
+            using namespace literals;
+            auto valueWithComment = ValueWithComment{"Nice"_interned, "Person"_interned};
+            static_assert(std::is_same_v<decltype(valueWithComment), ValueWithComment<InternedString, InternedString>>);
+            auto sentence = valueWithComment.comment + " " + valueWithComment.value;
+            std::cout << sentence << std::endl;
+            assert(11 == sentence.size() && "Person Nice" == sentence.str());
+
+            StringPool pool;
+            auto first = pool.intern(sentence);
+            [[maybe_unused]] auto again = pool.intern("Person Nice"), other = pool.intern("Person"), empty = pool.intern("");
+            assert(first == again && first != other && 2 == pool.size());
+            assert(first.hash() == std::hash<std::string_view>()("Person Nice") && InternedString() == empty);
+
+            auto name = "vvvv"_interned;
+            auto names = Stack{name};
+            static_assert(std::is_same_v<decltype(names), Stack<InternedString>>);
+            assert(name == names.top());
+        }
     }
 
     // chapter3
@@ -39,13 +160,46 @@ int main()
         Stack<100u> unsignedStack;
         Stack<100l> longStack;
         assert(!(std::is_same_v<decltype(unsignedStack.size()), decltype(longStack.size())>));
+        {
+            // Bounded stack : elements are stored inline , overflow handled by policy
+            Stack<2u, std::string, RejectOnOverflow> names;
+            [[maybe_unused]] bool pushed = names.push("Alex") && names.emplace(3, 'v');
+            [[maybe_unused]] bool overflowed = !names.push("Alice");
+            assert(pushed && overflowed && names.full());
+            assert(names.top() == "vvv");
+            names.pop();
+            assert(names.size() == 1 && names.top() == "Alex");
+            constexpr auto topOfStack = [] {
+                Stack<4> stack{};
+                stack.push(1);
+                stack.push(2);
+                stack.pop();
+                stack.push(3);
+                return stack.top();
+            }();
+            static_assert(3 == topOfStack);
+            static_assert(sizeof(Stack<4>) == 4 * sizeof(int) + sizeof(std::size_t));
+        }
         greeting<3>();
-        // NOTE static type
-        static const char msg[] = "World";
+        // NOTE static type , constexpr so that the compiler can read the characters too
+        static constexpr char msg[] = "World";
         greeting<msg, 10>();
         constexpr int cout = 0;
         DecltypeAuto<cout> bb;
         bb.operate();
+        {
+            // The texts above are built by the compiler
+            static_assert(FixedString(" Hello ") + toFixedString<-120>() + "\n" == FixedString(" Hello -120\n"));
+            static_assert(repeat<3>(FixedString("ab")).view() == "ababab" && 6 == decltype(repeat<3>(FixedString("ab")))::capacity());
+            static_assert(constantText<msg>().view() == "World" && constantText<'c'>().view() == "c" && isConstantText<msg>);
+            static char mutableMsg[] = "Mutable";
+            static_assert(!isConstantText<mutableMsg>);
+            greeting<mutableMsg, 2>();
+            static int counter = 7;
+            DecltypeAuto<(counter)> reference;
+            counter = 8;
+            reference.operate();
+        }
     }
     // chapter4
     {
@@ -54,12 +208,68 @@ int main()
         overload::print(1, 3, " Hello world");
         overload::preferred::detailedPrint(1, 3, 8.8, " Hello world", std::string("Hello\n"));
         usageOfSizeof::print("One", "Two", " Hello world", "VV", "MM");
+        {
+            // One formatted buffer and a single write per line , flush std::cout first to keep the order
+            std::cout << std::flush;
+            buffered::print(1, 3, " Hello world");
+            buffered::print(8.8, ' ', 1.0 / 3, ' ', -42L, ' ', std::string("Hello"), ' ', true);
+            char line[64];
+            auto end = buffered::formatLine(line, 1, 1.0 / 3, std::string_view(" vv"));
+            assert(std::string_view(line, end - line) == "10.333333 vv\n");
+        }
+        {
+            // Formatted on a background thread , the file gets exactly what detailedPrint prints
+            auto path = (std::filesystem::temp_directory_path() / "tcg_async_log.log").string();
+            {
+                asynchronous::AsyncLogger log(path);
+                log.detailedPrint(1, 3, 8.8, " Hello world", std::string("Hello\n"));
+            }
+            std::ostringstream expected;
+            auto previous = std::cout.rdbuf(expected.rdbuf());
+            overload::preferred::detailedPrint(1, 3, 8.8, " Hello world", std::string("Hello\n"));
+            std::cout.rdbuf(previous);
+            std::ifstream written(path);
+            assert(std::string(std::istreambuf_iterator<char>(written), {}) == expected.str());
+            written.close();
+            std::filesystem::remove(path);
+        }
         {
             using namespace variadicExpression;
             constexpr auto additional = 10;
             assert(calcSum<additional>(1, 2, 3, 4, 5, 6, 7) - calcSum<0>(1, 2, 3, 4, 5, 6, 7) == additional);
             assert(calcDouble(1, 2, 3) == 12);
             assert(addOne(1, 2, 3) == 9);
+            {
+                // Same folds over runtime ranges , every SIMD level is checked against the scalar left fold
+                using TemplateCompleteGuide::platform::SimdLevel;
+                std::vector<int> ints(1003);
+                std::vector<float> floats(1003);
+                std::vector<double> doubles(1003);
+                for (std::size_t i = 0; i < ints.size(); ++i)
+                {
+                    ints[i] = static_cast<int>(i % 7) - 3;
+                    floats[i] = 1.0f + static_cast<float>(i % 5) * 0.25f;
+                    doubles[i] = 1.0 + static_cast<double>(i % 3) * 1e-3;
+                }
+                auto intSum = std::accumulate(ints.begin(), ints.end(), 0);
+                auto floatSum = std::accumulate(floats.begin(), floats.end(), 0.0f);
+                auto doubleProduct = std::accumulate(doubles.begin(), doubles.end(), 1.0, std::multiplies<>());
+                std::vector<int> factors = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, -1, 1, 1, 1, 1};
+                for (auto level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512})
+                {
+                    assert(intSum == simd::reduce<simd::Plus>(ints.data(), ints.size(), level));
+                    assert(std::abs(floatSum - simd::reduce<simd::Plus>(floats.data(), floats.size(), level)) < 1e-3f * floatSum);
+                    assert(std::abs(doubleProduct - simd::reduce<simd::Multiplies>(doubles.data(), doubles.size(), level)) < 1e-12 * doubleProduct);
+                    assert(-479001600 == simd::reduce<simd::Multiplies>(factors.data(), factors.size(), level));
+                }
+                assert(calcSumRange<additional>(ints) - foldSumRange(ints) == additional);
+                assert(foldSumRange(std::list<int>{1, 2, 3}) == 6 && foldMutipleRange(factors.data(), factors.data() + 5) == 120);
+                assert(intSum == foldSumRange(ints.begin(), ints.end()) && 0 == foldSumRange(ints.end(), ints.end()));
+                // Narrow integers wrap as unsigned int , without going through int
+                std::vector<unsigned short> shorts = {65535, 65535};
+                std::vector<bool> flags = {true, false};
+                assert(1 == foldMutipleRange(shorts) && 65534 == foldSumRange(shorts) && foldSumRange(flags.begin(), flags.end()));
+            }
         }
         {
             using namespace variadicIndices;
@@ -68,6 +278,39 @@ int main()
             std::vector array = {"HelloElementsPrinter\n", "World\n", "Alex\b", "Alice\b", "Mike\n"};
             printElements(array, 1, 2, 4);
             printIndex<0, 1, 2>(array);
+            {
+                // Runtime index lists , run at every SIMD level the CPU supports
+                using TemplateCompleteGuide::platform::SimdLevel;
+                std::vector<double> source(100);
+                std::iota(source.begin(), source.end(), 0.0);
+                std::vector<int> indices(37);
+                for (std::size_t i = 0; i < indices.size(); ++i)
+                    indices[i] = static_cast<int>(i * 7 % 100);
+                for (auto level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512})
+                {
+                    std::vector<double> gathered(indices.size()), scattered(100, -1);
+                    gather(source.data(), source.size(), indices.data(), indices.size(), gathered.data(), level);
+                    scatter(gathered.data(), indices.data(), indices.size(), scattered.data(), scattered.size(), level);
+                    for (std::size_t i = 0; i < indices.size(); ++i)
+                        assert(gathered[i] == indices[i] && scattered[indices[i]] == indices[i]);
+                }
+                auto picked = gather(std::vector<int>{5, 6, 7, 8}, std::array<int, 3>{3, 0, 3});
+                assert((picked == std::vector<int>{8, 5, 8}));
+                assert((gatherIndex<0, 4>(array) == std::array<char const *, 2>{array[0], array[4]}));
+                int fixed[] = {1, 2, 3};
+                static_assert(std::is_same_v<decltype(gatherIndex<2, 0>(fixed)), std::array<int, 2>>);
+                assert((3 == gatherIndex<2, 0>(fixed)[0]));
+#if TCG_GATHER_BOUNDS_CHECK
+                try
+                {
+                    gather(source, std::vector<int>{100});
+                    assert(false);
+                }
+                catch (std::out_of_range const &)
+                {
+                }
+#endif
+            }
         }
         {
             using namespace variadicClassTemplates;
@@ -75,21 +318,156 @@ int main()
             std::array<int, 5> testArray = {1, 3, 7, 8, 9};
             printByIndex(testTuple, Indices<0, 1, 3>());
             printByIndex(testArray, Indices<0, 1, 3>());
+            {
+                // Members stored by decreasing alignment , accessed by their declared position
+                static_assert(sizeof(Tuple<char, double, char>) < sizeof(std::tuple<char, double, char>));
+                static_assert(sizeof(Tuple<int, std::equal_to<int>, char>) == 2 * sizeof(int));
+                Tuple tuple{'a', 2.5, std::string("Tuple\n"), 3};
+                auto &[letter, real, text, number] = tuple;
+                assert('a' == letter && 2.5 == real && 3 == number);
+                text = "HelloTuple\n";
+                printByIndex(tuple, MakeIndices<4>());
+            }
+            {
+                static_assert(sizeof(Variant<char, short>) == 2 * sizeof(short));
+                Variant<int, double, std::string, bool> value = "Variant";
+                assert(2 == value.index() && holdsAlternative<std::string>(value));
+                auto size = visit(variadicBaseClassAndUsing::Overloader{[](std::string const &s) { return s.size(); }, [](auto const &) { return std::size_t(0); }}, value);
+                assert(7 == size);
+                value = 1.5;
+                auto copy = value;
+                assert(1.5 == get<double>(copy) && nullptr == copy.getIf<0>());
+                value = true;
+                assert(3 == value.index() && get<3>(value));
+                try
+                {
+                    get<int>(value);
+                    assert(false);
+                }
+                catch (BadVariantAccess const &)
+                {
+                }
+                copy = std::move(value);
+                assert(holdsAlternative<bool>(copy) && !copy.valueless_by_exception());
+            }
+            {
+                // One array per field , scans only read the fields they use
+                std::vector<CppFeatures::Person> persons = {{12, "Alex"}, {30, "Alice"}, {45, "Mike"}};
+                Columns<int, std::string, double> people;
+                people.load(persons.begin(), persons.end(), &CppFeatures::Person::age, &CppFeatures::Person::name, &CppFeatures::Person::age);
+                people.append(8, "Bob", 1.5);
+                int totalAge = 0;
+                people.forEach<0>([&](int age) { totalAge += age; });
+                assert(4 == people.size() && 95 == totalAge);
+                std::size_t adults = 0;
+                people.forEach<0, 1>([&](int age, std::string const &name) { adults += age >= 18 && name.size() >= 4; });
+                assert(2 == adults);
+                auto [age, name, weight] = people[3];
+                age += 1;
+                assert(9 == people.column<0>()[3] && "Bob" == name && 1.5 == weight);
+                for (auto row : people)
+                    get<2>(row) *= 2;
+                auto const &constPeople = people;
+                assert(90 == std::get<2>(constPeople[2].toTuple()) && 24 == get<2>(*constPeople.begin()));
+                // A field that throws leaves no column longer than the others
+                struct Fragile
+                {
+                    Fragile(int) {}
+                    Fragile(Fragile const &) { throw std::runtime_error("copy"); }
+                };
+                Columns<int, Fragile> fragile;
+                std::vector<std::pair<int, Fragile>> records;
+                records.emplace_back(1, 1);
+                try
+                {
+                    fragile.load(records.begin(), records.end(), &std::pair<int, Fragile>::first, &std::pair<int, Fragile>::second);
+                    assert(false);
+                }
+                catch (std::runtime_error const &)
+                {
+                }
+                try
+                {
+                    fragile.append(2, records[0].second);
+                    assert(false);
+                }
+                catch (std::runtime_error const &)
+                {
+                }
+                assert(fragile.empty() && std::as_const(fragile).column<0>().empty());
+            }
         }
         {
             using namespace variadicBaseClassAndUsing;
             using CustomerOP = Overloader<CustomerHash, CustomerEq>;
             std::unordered_set<Customer, CustomerHash, CustomerEq> coll1;
             std::unordered_set<Customer, CustomerOP, CustomerOP> coll2;
+            {
+                // Flat hash set , looked up by name without building a Customer
+                FlatHashSet<Customer, CustomerOP, CustomerOP> customers;
+                for (auto name : {"Alex", "Alice", "Mike", "Alex"})
+                    customers.emplace(name);
+                assert(3 == customers.size() && customers.contains(std::string_view("Mike")) && !customers.contains(std::string_view("Bob")));
+                assert(customers.find(std::string_view("Alice"))->getName() == "Alice");
+                FlatHashSet<int> numbers;
+                for (int i = 0; i < 1000; ++i)
+                    numbers.insert(i);
+                std::size_t erased = 0;
+                for (int i = 0; i < 1000; i += 2)
+                    erased += numbers.erase(i);
+                assert(500 == erased);
+                auto copy = numbers;
+                [[maybe_unused]] auto reinserted = numbers.insert(1).second;
+                assert(500 == copy.size() && copy.contains(999) && !copy.contains(998) && !reinserted);
+                assert(500 == std::distance(copy.begin(), copy.end()));
+            }
+            {
+                // Registry shared by several threads
+                ConcurrentHashSet<Customer, CustomerOP, CustomerOP> registry(8);
+                std::vector<Customer> initial = {Customer("Alex"), Customer("Alice")};
+                [[maybe_unused]] auto inserted = registry.bulkInsert(initial.begin(), initial.end());
+                assert(2 == inserted);
+                std::vector<std::thread> workers;
+                for (int t = 0; t < 4; ++t)
+                    workers.emplace_back([&registry, t]
+                                         {
+                                             for (int i = 0; i < 100; ++i)
+                                             {
+                                                 registry.emplace(std::to_string(t * 100 + i));
+                                                 assert(registry.contains(std::string_view("Alex")));
+                                             } });
+                for (auto &worker : workers)
+                    worker.join();
+                assert(402 == registry.size() && 402 == registry.snapshot().size());
+                [[maybe_unused]] bool erased = registry.erase(std::string_view("Alex"));
+                assert(erased && !registry.find(std::string_view("Alex")));
+            }
         }
         {
             using namespace application;
-            Node *root = new Node{0};
-            root->left = new Node{1};
-            root->left->right = new Node{2};
-            root->left->right->left = new Node{7};
+            NodeArena arena;
+            Node *root = arena.create(0);
+            root->left = arena.create(1);
+            root->left->right = arena.create(2);
+            root->left->right->left = arena.create(7);
             Node *node = traverse(root, left, right, left);
             assert(node->value == 7 && 7 == (root->*(left)->*(right)->*(left))->value);
+            {
+                // Rebuild the same tree in one pass from its serialized shape
+                NodeArena copyArena(2);
+                auto shape = serializeTree(root);
+                Node *copy = buildTree(copyArena, shape.begin(), shape.end());
+                assert(4 == copyArena.size() && 7 == traverse(copy, left, right, left)->value);
+                copyArena.reset();
+                assert(0 == copyArena.size() && buildTree(copyArena, shape.begin(), shape.end())->left->value == 1);
+            }
+            {
+                // Same path for many roots , a missing child yields nullptr
+                std::vector<Node *> roots = {root, root->left, nullptr, root};
+                std::vector<Node *> found;
+                traverseBatch(roots.begin(), roots.end(), std::back_inserter(found), left, right, left);
+                assert(4 == found.size() && node == found[0] && !found[1] && !found[2] && node == found[3]);
+            }
             assert(isHomogeneous(1, 2, 3, 4, "1") == false);
             assert(isHomogeneous(1, 2, 3, 4, 6.1) == false);
             assert(isHomogeneous(1, 2, 3, 4, 6) == true);
@@ -108,6 +486,33 @@ int main()
         MoreFoolArrayList cc;
         std::cout << isArray<decltype(new FoolArrayList)>();
         std::cout << isArray<decltype(cc)>();
+        // Classification is resolved at compile time
+        static_assert(!isArray<int>() && !isArray<int *>() && !isArray<void>() && !isArray<Animal>());
+        static_assert(isArray<FoolArrayList>() && isArray<MoreFoolArrayList>());
+        static_assert(isArray<FoolArrayList const &>() && isArray<MoreFoolArrayList *const>());
+        static_assert(!isArray<std::vector<FoolArrayList>>() && !isArray<FoolArrayList **>());
+        static_assert(adapter<MoreFoolArrayList>(MoreFoolArrayList{}) && !adapter<int>(0));
+        {
+            // Static type switch on the kind id instead of dynamic_cast
+            using namespace staticDispatch;
+            using TemplateCompleteGuide::chapter4::variadicBaseClassAndUsing::Overloader;
+            Dog dog;
+            Cat cat;
+            Animal animal;
+            std::vector<Animal *> zoo = {&dog, &cat, nullptr, &animal, &cat, &dog, &cat};
+            int dogs = 0, cats = 0, others = 0;
+            auto counter = Overloader{[&](Dog &) { ++dogs; }, [&](Cat &) { ++cats; }, [&](Animal &) { ++others; }};
+            for (auto each : zoo)
+                dispatch(each, counter);
+            assert(2 == dogs && 3 == cats && 1 == others);
+            dispatchBatch(zoo.begin(), zoo.end(), Overloader{[&](Cat &) { --cats; }});
+            assert(0 == cats && isKindOf<Animal>(dog.kind()) && !isKindOf<Cat>(dog.kind()));
+            // A handler may dispatch another batch while the outer one is visited
+            std::vector<Animal *> inner = {&cat, &cat};
+            dispatchBatch(zoo.begin(), zoo.end(), Overloader{[&](Dog &) { dispatchBatch(inner.begin(), inner.end(), Overloader{[&](Cat &) { ++cats; }}); }, [&](Animal &) { ++others; }});
+            assert(4 == cats && 5 == others);
+            DispatchHelper<Dog>{}(&dog);
+        }
         std::cout << typeid(int).name() << std::endl;
         std::cout << typeid(FoolArrayList).name() << std::endl;
 
@@ -118,5 +523,153 @@ int main()
         auto bb = int{};
     }
 
+    // AlgorithmInCpp
+    {
+        using namespace AlgorithmInCpp;
+        // A small grain on purpose , so that even these sizes are split between the workers
+        WorkStealingPool pool(4);
+        parallel::Policy policy(pool, 256);
+        std::vector<int> values(100000);
+        std::iota(values.begin(), values.end(), 0);
+        parallel::forEach(policy, values, [](int &value) { value = value * 7 % 100003; });
+        std::vector<long long> squares(values.size());
+        parallel::transform(policy, values.begin(), values.end(), squares.begin(), [](int value) { return 1LL * value * value; });
+        assert(parallel::reduce(policy, squares, 0LL) == std::accumulate(squares.begin(), squares.end(), 0LL));
+        // The inclusive scan adds in the value type of the input , as std::inclusive_scan
+        std::vector<long long> inclusive(values.begin(), values.end()), exclusive(values.size());
+        parallel::inclusiveScan(policy, inclusive.begin(), inclusive.end(), inclusive.begin());
+        parallel::exclusiveScan(policy, values.begin(), values.end(), exclusive.begin(), 0LL);
+        assert(inclusive.back() == std::accumulate(values.begin(), values.end(), 0LL) && exclusive[1] == values[0]);
+        assert(std::equal(exclusive.begin() + 1, exclusive.end(), inclusive.begin()));
+        parallel::sort(policy, values, std::greater<>());
+        assert(std::is_sorted(values.begin(), values.end(), std::greater<>()));
+        std::vector<std::string> words = {"pear", "fig", "apple", "kiwi"};
+        parallel::sort(words); // below the grain: std::sort on the calling thread
+        assert(words.front() == "apple");
+        try
+        {
+            parallel::forEach(policy, values, [](int value) { if (value == 42) throw std::runtime_error("42"); });
+            assert(false);
+        }
+        catch (std::runtime_error const &error)
+        {
+            std::cout << "Parallel forEach rethrew " << error.what() << std::endl;
+        }
+    }
+
+    // DesignPattern
+    {
+        using namespace DesignPattern;
+        using TemplateCompleteGuide::chapter4::application::Node;
+        ObjectPool<Node> nodes;
+        {
+            auto root = nodes.make(1);
+            auto child = nodes.make(2);
+            root->left = child.get();
+            assert(2 == root->left->value);
+        }
+        // The slots of the handles above are handed out again , from this thread's cache
+        std::vector<Node *> many;
+        for (int i = 0; i < 1000; ++i)
+            many.push_back(nodes.create(i));
+        assert(999 == many.back()->value && nodes.capacity() >= 1000);
+        for (auto each : many)
+            nodes.destroy(each);
+
+        FlyweightFactory<std::string> names;
+        auto first = names.intern(std::string("Customer"));
+        auto second = names.emplace("Customer");
+        auto other = names.intern(std::string("Supplier"));
+        assert(first == second && first != other && 2 == names.size());
+        std::cout << "Flyweight " << *first << " stored once at " << first.get() << std::endl;
+    }
+
+#if !defined _WIN32
+    // Terminal rendering , into a pipe here: the second frame only carries the counter that changed
+    {
+        using namespace TemplateCompleteGuide::terminal;
+        int ends[2];
+        if (::pipe(ends) == 0)
+        {
+            std::size_t first = 0, second = 0;
+            {
+                Renderer screen(ends[1], Size{40, 12});
+                Dashboard dashboard(screen, "demo");
+                auto &latency = dashboard.histogram("latency");
+                for (std::uint64_t ns : {120, 130, 900, 1500, 40000})
+                    latency.record(ns);
+                dashboard.counter("requests", 41);
+                first = dashboard.render();
+                dashboard.counter("requests", 42);
+                second = dashboard.render();
+                [[maybe_unused]] auto unchanged = dashboard.render();
+                assert(0 == unchanged && '4' == screen.at(32, 2).character && '#' == screen.at(11, 5).character);
+            }
+            ::close(ends[1]);
+            std::string frames;
+            char chunk[4096];
+            for (ssize_t length; (length = ::read(ends[0], chunk, sizeof(chunk))) > 0;)
+                frames.append(chunk, static_cast<std::size_t>(length));
+            ::close(ends[0]);
+            assert(second < first / 10 && frames.find("requests") != std::string::npos && frames.find("p99") != std::string::npos);
+        }
+    }
+#endif
+
+    // Instrumentation: per-thread counters and histograms merged on read , exported as JSON and Prometheus text
+    {
+        using namespace TemplateCompleteGuide::instrumentation;
+        auto &registry = Registry::instance();
+        auto requests = registry.counter("demo.requests");
+        auto latency = registry.histogram("demo.latency");
+        std::thread worker([&]
+                           {
+                               for (std::uint64_t i = 0; i < 1000; ++i)
+                               {
+                                   Registry::add(requests, 1);
+                                   Registry::record(latency, i);
+                               } });
+        for (int i = 0; i < 1000; ++i)
+            Registry::add(requests, 2);
+        worker.join(); // its shard is folded into the totals
+        {
+            ScopedTimer timer(registry.histogram("demo.sleep", Unit::Ticks));
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        auto snapshot = registry.snapshot();
+        auto counter = [&](std::string_view name)
+        {
+            auto found = std::find_if(snapshot.counters.begin(), snapshot.counters.end(), [&](auto const &each)
+                                      { return each.first == name; });
+            return found == snapshot.counters.end() ? 0 : found->second;
+        };
+        auto histogram = [&](std::string_view name) -> HistogramSnapshot const &
+        {
+            return *std::find_if(snapshot.histograms.begin(), snapshot.histograms.end(), [&](auto const &each)
+                                 { return each.name == name; });
+        };
+        auto const &values = histogram("demo.latency");
+        auto const &sleep = histogram("demo.sleep");
+        assert(3000 == counter("demo.requests") && 1000 == values.count && 999 == values.max);
+        assert(values.percentile(0.5) >= 499 && values.percentile(0.5) <= 499 * 1.0625 && 999 == values.percentile(0.999));
+        assert(1 == sleep.count && sleep.mean() >= 2e6 && sleep.mean() < 2e9); // nanoseconds
+        std::ostringstream json, prometheus;
+        writeJson(json, snapshot);
+        writePrometheus(prometheus, snapshot);
+        assert(json.str().find("\"demo.requests\": 3000") != std::string::npos);
+        assert(prometheus.str().find("tcg_demo_requests_total 3000\n") != std::string::npos &&
+               prometheus.str().find("tcg_demo_sleep_seconds_count 1\n") != std::string::npos);
+#if TCG_INSTRUMENT
+        // The hot constructs above fed the registry too
+        assert(counter("CppFeatures.ArrayExpression.evaluate") > 0 && counter("CppFeatures.vm.executeBatch.rows") > 0 &&
+               counter("constexprTest.DispatchHelper.matched") > 0);
+        assert(histogram("chapter4.print").count > 0 && histogram("chapter4.application.traverse").count > 0);
+        auto directory = std::filesystem::temp_directory_path();
+        auto jsonPath = (directory / "tcg_metrics.json").string(), prometheusPath = (directory / "tcg_metrics.prom").string();
+        if (writeFile(jsonPath, writeJson) && writeFile(prometheusPath, writePrometheus))
+            std::cout << "Metrics written to " << jsonPath << " and " << prometheusPath << std::endl;
+#endif
+    }
+
     return 0;
 }
@@ -0,0 +1,184 @@
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#pragma once
+
+#include "template_complete_guide.h"
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter4
+    {
+        namespace application
+        {
+            /**
+             * e.g. 4. Arena of tree nodes
+             * Nodes are carved out of a few contiguous blocks instead of being allocated one by one , so that
+             * a tree built in one go is laid out (nearly) sequentially in memory. The nodes are plain Node
+             * objects linked by pointers , so traverse(np, paths...) works on them unchanged.
+             * A whole tree is released at once: reset() is O(1) , destruction is O(number of blocks).
+             */
+            class NodeArena
+            {
+                static_assert(std::is_trivially_destructible_v<Node>, "Nodes are released without running destructors");
+
+            public:
+                explicit NodeArena(std::size_t firstBlockNodes = 1024) : nextBlockNodes_(std::max<std::size_t>(firstBlockNodes, 1))
+                {
+                }
+                NodeArena(NodeArena const &) = delete;
+                NodeArena &operator=(NodeArena const &) = delete;
+                NodeArena(NodeArena &&other) noexcept
+                    : blocks_(std::move(other.blocks_)), current_(std::exchange(other.current_, 0)),
+                      nextBlockNodes_(other.nextBlockNodes_), size_(std::exchange(other.size_, 0)),
+                      begin_(std::exchange(other.begin_, nullptr)), cursor_(std::exchange(other.cursor_, nullptr)),
+                      end_(std::exchange(other.end_, nullptr))
+                {
+                    other.blocks_.clear();
+                }
+                NodeArena &operator=(NodeArena &&other) noexcept
+                {
+                    if (this != &other)
+                    {
+                        this->~NodeArena();
+                        ::new (static_cast<void *>(this)) NodeArena(std::move(other));
+                    }
+                    return *this;
+                }
+
+                template <typename... Args>
+                Node *create(Args &&...args)
+                {
+                    if (cursor_ == end_)
+                        nextBlock(1);
+                    return ::new (static_cast<void *>(cursor_++)) Node(std::forward<Args>(args)...);
+                }
+                // Make room for count more contiguous nodes , e.g. before building a tree of known size
+                void reserve(std::size_t count)
+                {
+                    if (static_cast<std::size_t>(end_ - cursor_) < count)
+                        nextBlock(count);
+                }
+                // Forget every node but keep the memory for the next tree
+                void reset() noexcept
+                {
+                    current_ = 0;
+                    if (!blocks_.empty())
+                        useBlock(0);
+                    size_ = 0;
+                }
+                std::size_t size() const noexcept
+                {
+                    return size_ + static_cast<std::size_t>(cursor_ - begin_);
+                }
+
+            private:
+                struct Block
+                {
+                    std::unique_ptr<Node[], void (*)(Node *)> nodes;
+                    std::size_t count;
+                };
+                static Node *allocate(std::size_t count)
+                {
+                    return static_cast<Node *>(::operator new(count * sizeof(Node)));
+                }
+                static void deallocate(Node *nodes)
+                {
+                    ::operator delete(nodes);
+                }
+                void useBlock(std::size_t index) noexcept
+                {
+                    begin_ = cursor_ = blocks_[index].nodes.get();
+                    end_ = begin_ + blocks_[index].count;
+                }
+                // Move to the next retained block holding at least minNodes nodes , or allocate a new one ,
+                // twice as large as the previous one , so that a tree of n nodes spans O(log n) blocks
+                void nextBlock(std::size_t minNodes)
+                {
+                    size_ += static_cast<std::size_t>(cursor_ - begin_);
+                    auto next = blocks_.empty() ? 0 : current_ + 1;
+                    while (next < blocks_.size() && blocks_[next].count < minNodes)
+                        ++next;
+                    if (next == blocks_.size())
+                    {
+                        auto count = std::max(nextBlockNodes_, minNodes);
+                        blocks_.push_back(Block{{allocate(count), &deallocate}, count});
+                        nextBlockNodes_ = count * 2;
+                    }
+                    current_ = next;
+                    useBlock(current_);
+                }
+
+                std::vector<Block> blocks_;
+                std::size_t current_ = 0;
+                std::size_t nextBlockNodes_;
+                std::size_t size_ = 0; // nodes in the blocks before the current one
+                Node *begin_ = nullptr;
+                Node *cursor_ = nullptr;
+                Node *end_ = nullptr;
+            };
+
+            // e.g. 5. Serialized shape of a tree: the nodes in preorder , each with flags telling which children follow
+            struct SerializedNode
+            {
+                enum : std::uint8_t
+                {
+                    HasLeft = 1,
+                    HasRight = 2
+                };
+                int value;
+                std::uint8_t children;
+            };
+
+            inline std::vector<SerializedNode> serializeTree(Node const *root)
+            {
+                std::vector<SerializedNode> shape;
+                std::vector<Node const *> pending;
+                if (root)
+                    pending.push_back(root);
+                while (!pending.empty())
+                {
+                    auto node = pending.back();
+                    pending.pop_back();
+                    shape.push_back({node->value, static_cast<std::uint8_t>((node->left ? SerializedNode::HasLeft : 0) |
+                                                                            (node->right ? SerializedNode::HasRight : 0))});
+                    if (node->right)
+                        pending.push_back(node->right);
+                    if (node->left)
+                        pending.push_back(node->left);
+                }
+                return shape;
+            }
+
+            // Build the tree described by a preorder shape in one pass , without recursion
+            template <typename Iterator>
+            Node *buildTree(NodeArena &arena, Iterator first, Iterator last)
+            {
+                Node *root = nullptr;
+                if (first == last)
+                    return root;
+                std::vector<Node **> slots = {&root}; // child pointers still waiting for their node
+                if constexpr (std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>)
+                    arena.reserve(static_cast<std::size_t>(last - first));
+                for (; first != last && !slots.empty(); ++first)
+                {
+                    SerializedNode const &each = *first;
+                    auto slot = slots.back();
+                    slots.pop_back();
+                    auto node = *slot = arena.create(each.value);
+                    if (each.children & SerializedNode::HasRight)
+                        slots.push_back(&node->right);
+                    if (each.children & SerializedNode::HasLeft)
+                        slots.push_back(&node->left);
+                }
+                assert(first == last && slots.empty() && "malformed tree shape");
+                return root;
+            }
+
+        } // namespace application
+
+    } // namespace chapter4
+
+} // namespace TemplateCompleteGuide
+
+#endif
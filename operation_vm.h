@@ -0,0 +1,185 @@
+#ifndef OPERATION_VM_H
+#define OPERATION_VM_H
+
+#pragma once
+
+#include "cpp_features.h"
+#include "instrumentation.h"
+
+namespace CppFeatures
+{
+    /**
+     * NOTE 4. Runtime Operators: a tiny register bytecode machine
+     * Formulas known only at runtime are compiled to a sequence of instructions
+     *      dest = lhs <op> rhs
+     * over a small register file. The handler of every Operators enumerator is instantiated from Operation<op>.
+     * The interpreter loop jumps straight from one handler to the next with computed goto where the compiler
+     * supports it (GCC , Clang) , and calls through a table generated from the enumerators otherwise.
+     *
+     * Two register files are available:
+     *  - scalar: every register holds one value
+     *  - batch: every register holds a column of batchSize values , each instruction runs a loop over the whole
+     *    column , so the cost of interpretation is paid once per batchSize values
+     */
+    namespace vm
+    {
+        struct Instruction
+        {
+            Operators op;
+            std::uint8_t dest;
+            std::uint8_t lhs;
+            std::uint8_t rhs;
+        };
+
+        // Instructions validated against a register count once , so that execution needs no checks
+        class Program
+        {
+        public:
+            Program(std::vector<Instruction> code, std::size_t registerCount) : code_(std::move(code)), registerCount_(registerCount)
+            {
+                for (auto const &each : code_)
+                    if (static_cast<std::size_t>(each.op) >= operatorCount || each.dest >= registerCount || each.lhs >= registerCount ||
+                        each.rhs >= registerCount)
+                        throw std::invalid_argument("vm::Program: invalid instruction");
+            }
+            Instruction const *begin() const
+            {
+                return code_.data();
+            }
+            Instruction const *end() const
+            {
+                return code_.data() + code_.size();
+            }
+            std::size_t registerCount() const
+            {
+                return registerCount_;
+            }
+
+        private:
+            std::vector<Instruction> code_;
+            std::size_t registerCount_;
+        };
+
+        // One value per register
+        template <typename T>
+        struct ScalarKernel
+        {
+            using Registers = T *;
+
+            template <Operators op>
+            static void apply(Registers registers, Instruction const &instruction, std::size_t)
+            {
+                registers[instruction.dest] = Operation<op>{}(registers[instruction.lhs], registers[instruction.rhs]);
+            }
+        };
+
+        constexpr std::size_t batchSize = 1024;
+
+        // One column of batchSize values per register , each instruction is a vectorizable loop over the first rows:
+        // the rows past them are never computed , e.g. a division of integers by the zeros there
+        template <typename T>
+        struct BatchKernel
+        {
+            using Column = std::array<T, batchSize>;
+            using Registers = Column *;
+
+            template <Operators op>
+            static void apply(Registers registers, Instruction const &instruction, std::size_t rows)
+            {
+                auto dest = registers[instruction.dest].data();
+                auto lhs = registers[instruction.lhs].data();
+                auto rhs = registers[instruction.rhs].data();
+                for (std::size_t i = 0; i < rows; ++i)
+                    dest[i] = Operation<op>{}(lhs[i], rhs[i]);
+            }
+        };
+
+        template <typename Kernel>
+        using Handler = void (*)(typename Kernel::Registers, Instruction const &, std::size_t);
+
+        template <typename Kernel, std::size_t... op>
+        constexpr std::array<Handler<Kernel>, operatorCount> makeHandlers(std::index_sequence<op...>)
+        {
+            return {&Kernel::template apply<static_cast<Operators>(op)>...};
+        }
+
+        // Run every instruction of the program on the register file , on its first rows for BatchKernel
+        template <typename Kernel>
+        void interpret(Program const &program, typename Kernel::Registers registers, std::size_t rows)
+        {
+            auto ip = program.begin();
+            auto const end = program.end();
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic" // labels as values are an extension
+            // Labels in the order of the enumerators , one indirect jump per instruction and no bounds check
+            static_assert(4 == operatorCount, "Add a label for the new enumerator");
+            static void *const labels[operatorCount] = {&&add, &&sub, &&mut, &&div};
+#define TCG_VM_DISPATCH      \
+    if (ip == end)           \
+        return;              \
+    goto *labels[static_cast<std::size_t>(ip->op)]
+
+            TCG_VM_DISPATCH;
+        add:
+            Kernel::template apply<Operators::Add>(registers, *ip++, rows);
+            TCG_VM_DISPATCH;
+        sub:
+            Kernel::template apply<Operators::Sub>(registers, *ip++, rows);
+            TCG_VM_DISPATCH;
+        mut:
+            Kernel::template apply<Operators::Mut>(registers, *ip++, rows);
+            TCG_VM_DISPATCH;
+        div:
+            Kernel::template apply<Operators::Div>(registers, *ip++, rows);
+            TCG_VM_DISPATCH;
+#undef TCG_VM_DISPATCH
+#pragma GCC diagnostic pop
+#else
+            static constexpr auto handlers = makeHandlers<Kernel>(std::make_index_sequence<operatorCount>{});
+            for (; ip != end; ++ip)
+                handlers[static_cast<std::size_t>(ip->op)](registers, *ip, rows);
+#endif
+        }
+
+        template <typename T>
+        void execute(Program const &program, T *registers)
+        {
+            TCG_COUNTER_INC("CppFeatures.vm.execute");
+            interpret<ScalarKernel<T>>(program, registers, 1);
+        }
+
+        template <typename T>
+        void executeBatch(Program const &program, typename BatchKernel<T>::Column *registers, std::size_t rows = batchSize)
+        {
+            assert(rows <= batchSize);
+            TCG_COUNTER_INC("CppFeatures.vm.executeBatch");
+            TCG_COUNTER_ADD("CppFeatures.vm.executeBatch.rows", rows);
+            interpret<BatchKernel<T>>(program, registers, rows);
+        }
+
+        /**
+         * Evaluate the program for every row of the input columns: column i is loaded into register i , and
+         * register resultRegister is stored into the output , batchSize rows at a time
+         */
+        template <typename T>
+        void evaluateColumns(Program const &program, std::vector<T const *> const &inputs, T *output, std::size_t rows,
+                             std::size_t resultRegister)
+        {
+            assert(inputs.size() <= program.registerCount() && resultRegister < program.registerCount());
+            std::vector<typename BatchKernel<T>::Column> registers(program.registerCount());
+            for (std::size_t row = 0; row < rows; row += batchSize)
+            {
+                auto count = std::min(batchSize, rows - row);
+                for (std::size_t i = 0; i < inputs.size(); ++i)
+                    std::copy(inputs[i] + row, inputs[i] + row + count, registers[i].begin());
+                executeBatch<T>(program, registers.data(), count);
+                std::copy(registers[resultRegister].begin(), registers[resultRegister].begin() + count, output + row);
+            }
+        }
+
+    } // namespace vm
+
+} // namespace CppFeatures
+
+#endif
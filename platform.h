@@ -0,0 +1,103 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+// x86 SIMD kernels are compiled per function with target attributes , which needs GCC or Clang
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define TCG_SIMD_X86 1
+#include <immintrin.h>
+#define TCG_TARGET_SSE2 __attribute__((target("sse2")))
+#define TCG_TARGET_AVX2 __attribute__((target("avx2")))
+#define TCG_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+namespace TemplateCompleteGuide
+{
+    namespace platform
+    {
+        // Hint the CPU to start loading the cache line of address , a no-op where unsupported
+        inline void prefetch(void const *address)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_prefetch(static_cast<char const *>(address), _MM_HINT_T0);
+#else
+            (void)address;
+#endif
+        }
+
+        // Free-running tick counter: the time stamp counter on x86 , steady_clock nanoseconds elsewhere.
+        // NOTICE not serializing , an out-of-order CPU may move it by a few instructions
+        inline std::uint64_t ticks() noexcept
+        {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+            return __builtin_ia32_rdtsc();
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                  std::chrono::steady_clock::now().time_since_epoch())
+                                                  .count());
+#endif
+        }
+
+        // Number of bits needed to write value , 0 for 0
+        inline int bitWidth(std::uint64_t value) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return value ? 64 - __builtin_clzll(value) : 0;
+#elif defined(_MSC_VER) && defined(_M_X64)
+            unsigned long index;
+            return _BitScanReverse64(&index, value) ? static_cast<int>(index) + 1 : 0;
+#else
+            int width = 0;
+            for (; value; value >>= 1)
+                ++width;
+            return width;
+#endif
+        }
+
+        // Instruction sets the SIMD kernels are compiled for , in increasing order
+        enum class SimdLevel
+        {
+            Scalar,
+            SSE2,
+            AVX2,
+            AVX512
+        };
+
+        inline SimdLevel detectSimdLevel()
+        {
+#if defined(TCG_SIMD_X86)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f"))
+                return SimdLevel::AVX512;
+            if (__builtin_cpu_supports("avx2"))
+                return SimdLevel::AVX2;
+            if (__builtin_cpu_supports("sse2"))
+                return SimdLevel::SSE2;
+#endif
+            return SimdLevel::Scalar;
+        }
+
+        // Best level supported by the running CPU , detected once
+        inline SimdLevel simdLevel()
+        {
+            static const auto level = detectSimdLevel();
+            return level;
+        }
+
+    } // namespace platform
+
+} // namespace TemplateCompleteGuide
+
+#endif
@@ -0,0 +1,351 @@
+#ifndef SIMD_REDUCE_H
+#define SIMD_REDUCE_H
+
+#pragma once
+
+#include "platform.h"
+#include "std.h"
+#include <iterator>
+#include <numeric>
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter4
+    {
+        namespace variadicExpression
+        {
+            /**
+             * NOTE 9.1.1 The fold expressions above over runtime ranges
+             * foldSumRange , calcSumRange<value> and foldMutipleRange reduce a range of int , float or double with
+             * SSE2 / AVX2 / AVX-512 kernels chosen at runtime for the running CPU , with a scalar fallback.
+             * Every kernel keeps four independent accumulators so that consecutive additions or multiplications
+             * do not wait for each other.
+             *
+             * NOTICE The elements are combined in a different order than (... + arg):
+             *  - int wraps around on overflow in every kernel (two's complement) , so the result is exact
+             *    whenever the left fold does not overflow , and identical between kernels anyway
+             *  - float and double are reassociated: the result may differ from the left fold by rounding ,
+             *    typically a few ulps of the sum of the magnitudes , and may differ between SIMD levels
+             */
+            namespace simd
+            {
+                // Integers wrap around instead of overflowing: they are combined as unsigned , at least as wide as
+                // unsigned int so that narrower types (and bool) are not promoted back to int
+                template <typename T, typename = void>
+                struct Wrapping
+                {
+                    using type = unsigned;
+                };
+                template <typename T>
+                struct Wrapping<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) >= sizeof(int)>>
+                {
+                    using type = std::make_unsigned_t<T>;
+                };
+
+                struct Plus
+                {
+                    template <typename T>
+                    static constexpr T identity()
+                    {
+                        return T(0);
+                    }
+                    template <typename T>
+                    static T apply(T lhs, T rhs)
+                    {
+                        if constexpr (std::is_integral_v<T>)
+                        {
+                            using U = typename Wrapping<T>::type;
+                            return static_cast<T>(static_cast<U>(lhs) + static_cast<U>(rhs));
+                        }
+                        else
+                            return lhs + rhs;
+                    }
+                };
+                struct Multiplies
+                {
+                    template <typename T>
+                    static constexpr T identity()
+                    {
+                        return T(1);
+                    }
+                    template <typename T>
+                    static T apply(T lhs, T rhs)
+                    {
+                        if constexpr (std::is_integral_v<T>)
+                        {
+                            using U = typename Wrapping<T>::type;
+                            return static_cast<T>(static_cast<U>(lhs) * static_cast<U>(rhs));
+                        }
+                        else
+                            return lhs * rhs;
+                    }
+                };
+
+                template <typename T>
+                constexpr bool isVectorizable = std::is_same_v<T, int> || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+                template <typename Op, typename T>
+                T reduceScalar(T const *data, std::size_t size)
+                {
+                    T acc[4] = {Op::template identity<T>(), Op::template identity<T>(), Op::template identity<T>(), Op::template identity<T>()};
+                    std::size_t i = 0;
+                    for (; i + 4 <= size; i += 4)
+                        for (std::size_t lane = 0; lane < 4; ++lane)
+                            acc[lane] = Op::apply(acc[lane], data[i + lane]);
+                    for (; i < size; ++i)
+                        acc[0] = Op::apply(acc[0], data[i]);
+                    return Op::apply(Op::apply(acc[0], acc[1]), Op::apply(acc[2], acc[3]));
+                }
+
+#if defined(TCG_SIMD_X86)
+                // NOTE Every instruction set gets its own operations and kernel , each compiled for that target only
+
+                struct Sse2
+                {
+                    static constexpr std::size_t width = 16; // bytes per vector
+
+                    TCG_TARGET_SSE2 static __m128 load(float const *p) { return _mm_loadu_ps(p); }
+                    TCG_TARGET_SSE2 static __m128d load(double const *p) { return _mm_loadu_pd(p); }
+                    TCG_TARGET_SSE2 static __m128i load(int const *p) { return _mm_loadu_si128(reinterpret_cast<__m128i const *>(p)); }
+                    TCG_TARGET_SSE2 static void store(float *p, __m128 v) { _mm_storeu_ps(p, v); }
+                    TCG_TARGET_SSE2 static void store(double *p, __m128d v) { _mm_storeu_pd(p, v); }
+                    TCG_TARGET_SSE2 static void store(int *p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+                    TCG_TARGET_SSE2 static __m128 broadcast(float v) { return _mm_set1_ps(v); }
+                    TCG_TARGET_SSE2 static __m128d broadcast(double v) { return _mm_set1_pd(v); }
+                    TCG_TARGET_SSE2 static __m128i broadcast(int v) { return _mm_set1_epi32(v); }
+                    TCG_TARGET_SSE2 static __m128 add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+                    TCG_TARGET_SSE2 static __m128d add(__m128d a, __m128d b) { return _mm_add_pd(a, b); }
+                    TCG_TARGET_SSE2 static __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+                    TCG_TARGET_SSE2 static __m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+                    TCG_TARGET_SSE2 static __m128d mul(__m128d a, __m128d b) { return _mm_mul_pd(a, b); }
+                    // SSE2 has no 32 bit multiply , multiply the even and the odd lanes as 64 bit and interleave the low halves
+                    TCG_TARGET_SSE2 static __m128i mul(__m128i a, __m128i b)
+                    {
+                        auto even = _mm_mul_epu32(a, b);
+                        auto odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+                        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+                    }
+                    template <typename Op, typename V>
+                    TCG_TARGET_SSE2 static V combine(V a, V b)
+                    {
+                        if constexpr (std::is_same_v<Op, Plus>)
+                            return add(a, b);
+                        else
+                            return mul(a, b);
+                    }
+                };
+
+                struct Avx2
+                {
+                    static constexpr std::size_t width = 32; // bytes per vector
+
+                    TCG_TARGET_AVX2 static __m256 load(float const *p) { return _mm256_loadu_ps(p); }
+                    TCG_TARGET_AVX2 static __m256d load(double const *p) { return _mm256_loadu_pd(p); }
+                    TCG_TARGET_AVX2 static __m256i load(int const *p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)); }
+                    TCG_TARGET_AVX2 static void store(float *p, __m256 v) { _mm256_storeu_ps(p, v); }
+                    TCG_TARGET_AVX2 static void store(double *p, __m256d v) { _mm256_storeu_pd(p, v); }
+                    TCG_TARGET_AVX2 static void store(int *p, __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+                    TCG_TARGET_AVX2 static __m256 broadcast(float v) { return _mm256_set1_ps(v); }
+                    TCG_TARGET_AVX2 static __m256d broadcast(double v) { return _mm256_set1_pd(v); }
+                    TCG_TARGET_AVX2 static __m256i broadcast(int v) { return _mm256_set1_epi32(v); }
+                    TCG_TARGET_AVX2 static __m256 add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+                    TCG_TARGET_AVX2 static __m256d add(__m256d a, __m256d b) { return _mm256_add_pd(a, b); }
+                    TCG_TARGET_AVX2 static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+                    TCG_TARGET_AVX2 static __m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+                    TCG_TARGET_AVX2 static __m256d mul(__m256d a, __m256d b) { return _mm256_mul_pd(a, b); }
+                    TCG_TARGET_AVX2 static __m256i mul(__m256i a, __m256i b) { return _mm256_mullo_epi32(a, b); }
+                    template <typename Op, typename V>
+                    TCG_TARGET_AVX2 static V combine(V a, V b)
+                    {
+                        if constexpr (std::is_same_v<Op, Plus>)
+                            return add(a, b);
+                        else
+                            return mul(a, b);
+                    }
+                };
+
+                struct Avx512
+                {
+                    static constexpr std::size_t width = 64; // bytes per vector
+
+                    TCG_TARGET_AVX512 static __m512 load(float const *p) { return _mm512_loadu_ps(p); }
+                    TCG_TARGET_AVX512 static __m512d load(double const *p) { return _mm512_loadu_pd(p); }
+                    TCG_TARGET_AVX512 static __m512i load(int const *p) { return _mm512_loadu_si512(p); }
+                    TCG_TARGET_AVX512 static void store(float *p, __m512 v) { _mm512_storeu_ps(p, v); }
+                    TCG_TARGET_AVX512 static void store(double *p, __m512d v) { _mm512_storeu_pd(p, v); }
+                    TCG_TARGET_AVX512 static void store(int *p, __m512i v) { _mm512_storeu_si512(p, v); }
+                    TCG_TARGET_AVX512 static __m512 broadcast(float v) { return _mm512_set1_ps(v); }
+                    TCG_TARGET_AVX512 static __m512d broadcast(double v) { return _mm512_set1_pd(v); }
+                    TCG_TARGET_AVX512 static __m512i broadcast(int v) { return _mm512_set1_epi32(v); }
+                    TCG_TARGET_AVX512 static __m512 add(__m512 a, __m512 b) { return _mm512_add_ps(a, b); }
+                    TCG_TARGET_AVX512 static __m512d add(__m512d a, __m512d b) { return _mm512_add_pd(a, b); }
+                    TCG_TARGET_AVX512 static __m512i add(__m512i a, __m512i b) { return _mm512_add_epi32(a, b); }
+                    TCG_TARGET_AVX512 static __m512 mul(__m512 a, __m512 b) { return _mm512_mul_ps(a, b); }
+                    TCG_TARGET_AVX512 static __m512d mul(__m512d a, __m512d b) { return _mm512_mul_pd(a, b); }
+                    TCG_TARGET_AVX512 static __m512i mul(__m512i a, __m512i b) { return _mm512_mullo_epi32(a, b); }
+                    template <typename Op, typename V>
+                    TCG_TARGET_AVX512 static V combine(V a, V b)
+                    {
+                        if constexpr (std::is_same_v<Op, Plus>)
+                            return add(a, b);
+                        else
+                            return mul(a, b);
+                    }
+                };
+
+                // Lanes left in the accumulator are folded by the scalar kernel , then the tail of the range
+                template <typename Op, typename T, std::size_t lanes>
+                T finishReduce(T const (&acc)[lanes], T const *tail, std::size_t tailSize)
+                {
+                    auto result = reduceScalar<Op>(acc, lanes);
+                    for (std::size_t i = 0; i < tailSize; ++i)
+                        result = Op::apply(result, tail[i]);
+                    return result;
+                }
+
+                // The kernel of every instruction set: always inlined into the entry point compiled for that set ,
+                // where the operations of Isa are inlined in turn. Never called , its vectors never cross an ABI boundary
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+                template <typename Isa, typename Op, typename T>
+                __attribute__((always_inline)) inline T reduceVectors(T const *data, std::size_t size)
+                {
+                    constexpr std::size_t lanes = Isa::width / sizeof(T);
+                    auto acc0 = Isa::broadcast(Op::template identity<T>()), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+                    std::size_t i = 0;
+                    for (; i + 4 * lanes <= size; i += 4 * lanes)
+                    {
+                        acc0 = Isa::template combine<Op>(acc0, Isa::load(data + i));
+                        acc1 = Isa::template combine<Op>(acc1, Isa::load(data + i + lanes));
+                        acc2 = Isa::template combine<Op>(acc2, Isa::load(data + i + 2 * lanes));
+                        acc3 = Isa::template combine<Op>(acc3, Isa::load(data + i + 3 * lanes));
+                    }
+                    for (; i + lanes <= size; i += lanes)
+                        acc0 = Isa::template combine<Op>(acc0, Isa::load(data + i));
+                    T acc[lanes];
+                    Isa::store(acc, Isa::template combine<Op>(Isa::template combine<Op>(acc0, acc1), Isa::template combine<Op>(acc2, acc3)));
+                    return finishReduce<Op>(acc, data + i, size - i);
+                }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+                template <typename Op, typename T>
+                TCG_TARGET_SSE2 T reduceSse2(T const *data, std::size_t size)
+                {
+                    return reduceVectors<Sse2, Op>(data, size);
+                }
+                template <typename Op, typename T>
+                TCG_TARGET_AVX2 T reduceAvx2(T const *data, std::size_t size)
+                {
+                    return reduceVectors<Avx2, Op>(data, size);
+                }
+                template <typename Op, typename T>
+                TCG_TARGET_AVX512 T reduceAvx512(T const *data, std::size_t size)
+                {
+                    return reduceVectors<Avx512, Op>(data, size);
+                }
+#endif // TCG_SIMD_X86
+
+                // Reduce with the kernel of the given level , lowered to what the running CPU supports
+                template <typename Op, typename T>
+                T reduce(T const *data, std::size_t size, platform::SimdLevel level = platform::simdLevel())
+                {
+                    static_assert(isVectorizable<T>, "SIMD reductions support int , float and double");
+                    level = std::min(level, platform::simdLevel());
+#if defined(TCG_SIMD_X86)
+                    switch (level)
+                    {
+                    case platform::SimdLevel::AVX512:
+                        return reduceAvx512<Op>(data, size);
+                    case platform::SimdLevel::AVX2:
+                        return reduceAvx2<Op>(data, size);
+                    case platform::SimdLevel::SSE2:
+                        return reduceSse2<Op>(data, size);
+                    default:
+                        break;
+                    }
+#endif
+                    return reduceScalar<Op>(data, size);
+                }
+
+                // Iterators over contiguous elements , C++17 has no iterator category telling them apart: pointers
+                // (which std::array iterators are with libstdc++ and libc++) and the iterators of std::vector
+                template <typename Iterator, typename T = typename std::iterator_traits<Iterator>::value_type>
+                constexpr bool isContiguousIterator = std::is_pointer_v<Iterator> || std::is_same_v<Iterator, typename std::vector<T>::iterator> ||
+                                                      std::is_same_v<Iterator, typename std::vector<T>::const_iterator>;
+
+                template <typename Op, typename Iterator>
+                auto reduceRange(Iterator first, Iterator last)
+                {
+                    using T = typename std::iterator_traits<Iterator>::value_type;
+                    if constexpr (isContiguousIterator<Iterator> && isVectorizable<T>)
+                    {
+                        if (first == last)
+                            return Op::template identity<T>();
+                        return reduce<Op>(std::addressof(*first), static_cast<std::size_t>(last - first));
+                    }
+                    else
+                        return std::accumulate(first, last, Op::template identity<T>(), [](T lhs, T rhs) { return Op::apply(lhs, rhs); });
+                }
+
+                template <typename Range, typename = void>
+                constexpr bool isContiguous = false;
+                template <typename Range>
+                constexpr bool isContiguous<Range, std::void_t<decltype(std::data(std::declval<Range const &>()))>> = true;
+
+                template <typename Op, typename Range>
+                auto reduceRange(Range const &range)
+                {
+                    if constexpr (isContiguous<Range>)
+                        return reduceRange<Op>(std::data(range), std::data(range) + std::size(range));
+                    else
+                        return reduceRange<Op>(std::begin(range), std::end(range));
+                }
+
+            } // namespace simd
+
+            // Pointers and vector iterators are reduced by the SIMD kernels , any other iterator by a plain loop
+            template <typename Iterator>
+            auto foldSumRange(Iterator first, Iterator last)
+            {
+                return simd::reduceRange<simd::Plus>(first, last);
+            }
+            // Contiguous ranges such as std::vector , std::array or a C array are reduced by the SIMD kernels too
+            template <typename Range>
+            auto foldSumRange(Range const &range)
+            {
+                return simd::reduceRange<simd::Plus>(range);
+            }
+
+            template <auto value, typename Iterator>
+            auto calcSumRange(Iterator first, Iterator last)
+            {
+                return value + foldSumRange(first, last);
+            }
+            template <auto value, typename Range>
+            auto calcSumRange(Range const &range)
+            {
+                return value + foldSumRange(range);
+            }
+
+            template <typename Iterator>
+            auto foldMutipleRange(Iterator first, Iterator last)
+            {
+                return simd::reduceRange<simd::Multiplies>(first, last);
+            }
+            template <typename Range>
+            auto foldMutipleRange(Range const &range)
+            {
+                return simd::reduceRange<simd::Multiplies>(range);
+            }
+
+        } // namespace variadicExpression
+
+    } // namespace chapter4
+
+} // namespace TemplateCompleteGuide
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef STATIC_DISPATCH_H
+#define STATIC_DISPATCH_H
+
+#pragma once
+
+#include "template_complete_guide.h"
+
+namespace TemplateCompleteGuide
+{
+    namespace constexprValidation
+    {
+        /**
+         * NOTE 0.3 Static type switch over the closed Animal hierarchy
+         * The visitor is any callable overloaded on the classes of the hierarchy , e.g.
+         *      dispatch(animal, Overloader{[](Dog &) {...}, [](Cat &) {...}});
+         * The most specific overload is chosen at compile time for every AnimalKind , and a table generated
+         * from AnimalHierarchy maps the kind id of the object to it. Kinds the visitor cannot handle are skipped ,
+         * as are null pointers , like a failing dynamic_cast.
+         */
+        namespace staticDispatch
+        {
+            template <typename Visitor, typename Q>
+            void visitAs(Visitor &visitor, Animal *animal)
+            {
+                if constexpr (std::is_invocable_v<Visitor &, Q &>)
+                    visitor(static_cast<Q &>(*animal));
+            }
+
+            template <typename Visitor>
+            using Handler = void (*)(Visitor &, Animal *);
+
+            template <typename Visitor, typename... Ts>
+            constexpr auto makeDispatchTable(TypeList<Ts...>)
+            {
+                return std::array<Handler<Visitor>, sizeof...(Ts)>{&visitAs<Visitor, Ts>...};
+            }
+
+            template <typename Visitor>
+            void dispatch(Animal *animal, Visitor &&visitor)
+            {
+                using V = std::remove_reference_t<Visitor>;
+                static constexpr auto table = makeDispatchTable<V>(AnimalHierarchy{});
+                if (animal)
+                    table[static_cast<std::size_t>(animal->kind())](visitor, animal);
+            }
+
+            // Visit every object of a group with the handler of its kind , called directly so it can be inlined
+            template <typename Visitor, typename... Ts>
+            void visitGroups(Animal *const *grouped, std::size_t const *offsets, Visitor &visitor, TypeList<Ts...>)
+            {
+                auto visitGroup = [&](auto *type, std::size_t kind)
+                {
+                    using Q = std::remove_pointer_t<decltype(type)>;
+                    if constexpr (std::is_invocable_v<Visitor &, Q &>)
+                        for (auto i = offsets[kind]; i < offsets[kind + 1]; ++i)
+                            visitor(static_cast<Q &>(*grouped[i]));
+                };
+                (visitGroup(static_cast<Ts *>(nullptr), static_cast<std::size_t>(Ts::staticKind)), ...);
+            }
+
+            /**
+             * Batch mode: the objects are first grouped by kind with a counting sort , then each group is visited
+             * in a tight loop with a single , statically known handler. The branch predictor and the instruction
+             * cache see one handler at a time instead of a random sequence of them.
+             * NOTICE The objects are visited grouped by kind , in their original order within a kind
+             */
+            template <typename Iterator, typename Visitor>
+            void dispatchBatch(Iterator first, Iterator last, Visitor &&visitor)
+            {
+                constexpr auto kindCount = static_cast<std::size_t>(AnimalKind::Count);
+                std::array<std::size_t, kindCount + 1> offsets{};
+                for (auto it = first; it != last; ++it)
+                    if (Animal *animal = *it)
+                        ++offsets[static_cast<std::size_t>(animal->kind()) + 1];
+                for (std::size_t kind = 0; kind < kindCount; ++kind)
+                    offsets[kind + 1] += offsets[kind];
+
+                // Reused across batches , but a handler may call dispatchBatch again: the nested calls get their own
+                thread_local std::vector<Animal *> reused;
+                thread_local bool reusedBusy = false;
+                std::vector<Animal *> nested;
+                struct Release
+                {
+                    bool owner;
+                    ~Release()
+                    {
+                        if (owner)
+                            reusedBusy = false;
+                    }
+                } release{!reusedBusy};
+                auto &grouped = release.owner ? reused : nested;
+                reusedBusy = true;
+                grouped.resize(offsets[kindCount]);
+                auto cursor = offsets;
+                for (auto it = first; it != last; ++it)
+                    if (Animal *animal = *it)
+                        grouped[cursor[static_cast<std::size_t>(animal->kind())]++] = animal;
+
+                visitGroups(grouped.data(), offsets.data(), visitor, AnimalHierarchy{});
+            }
+
+        } // namespace staticDispatch
+
+    } // namespace constexprValidation
+
+} // namespace TemplateCompleteGuide
+
+#endif
@@ -3,6 +3,7 @@
 #include <memory>
 #include <list>
 #include <string>
+#include <string_view>
 #include <assert.h>
 #include <tuple>
 #include <variant>
@@ -11,3 +12,9 @@
 #include <unordered_map>
 #include <functional>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
@@ -4,6 +4,8 @@
 #pragma once
 
 #include "std.h"
+#include "fixed_string.h"
+#include "instrumentation.h"
 
 namespace TemplateCompleteGuide
 {
@@ -16,8 +18,29 @@ namespace TemplateCompleteGuide
         struct MoreFoolArrayList : FoolArrayList
         {
         };
+        /**
+         * NOTE 0.2 Closed hierarchy: every class of the hierarchy carries a compact type id , set once by its
+         * constructor , so that dispatching on the dynamic type needs no RTTI walk
+         */
+        enum class AnimalKind : std::uint8_t
+        {
+            Animal,
+            Dog,
+            Cat,
+            Count
+        };
+
         struct Animal
         {
+            static constexpr AnimalKind staticKind = AnimalKind::Animal;
+
+            Animal() : kind_(staticKind)
+            {
+            }
+            AnimalKind kind() const
+            {
+                return kind_;
+            }
             virtual bool isAnimal() const
             {
                 return true;
@@ -25,9 +48,22 @@ namespace TemplateCompleteGuide
             virtual void speak()
             {
             }
+
+        protected:
+            explicit Animal(AnimalKind kind) : kind_(kind)
+            {
+            }
+
+        private:
+            AnimalKind kind_;
         };
         struct Dog : Animal
         {
+            static constexpr AnimalKind staticKind = AnimalKind::Dog;
+
+            Dog() : Animal(staticKind)
+            {
+            }
             bool isDog() const
             {
                 return true;
@@ -38,14 +74,43 @@ namespace TemplateCompleteGuide
             }
         };
 
+        /**
+         * NOTE 0.1 Compile-time classification by opt-in tagging
+         * A type is an array list when an overload of arrayListTag accepting a pointer to it is found by ADL ,
+         * i.e. declared next to the type. Since the probe passes a T const * , classes derived from a tagged
+         * class are classified through the derived-to-base pointer conversion , e.g. MoreFoolArrayList.
+         * The overloads are only named in unevaluated operands , they need no definition.
+         */
+        std::true_type arrayListTag(FoolArrayList const *);
+
+        namespace classification
+        {
+            std::false_type arrayListTag(...); // fallback for untagged types
+
+            // Pointers are classified by their pointee , e.g. FoolArrayList *
+            template <typename T>
+            using Classified = std::remove_cv_t<std::remove_pointer_t<std::remove_cv_t<std::remove_reference_t<T>>>>;
+
+            template <typename T>
+            using ArrayListTagOf = decltype(arrayListTag(static_cast<Classified<T> const *>(nullptr)));
+        } // namespace classification
+
+        template <typename T>
+        constexpr bool isArrayListV = classification::ArrayListTagOf<T>::value;
+
         template <typename T>
         constexpr auto isArray()
         {
-            return std::string::npos != std::string(typeid(T).name()).find("ArrayList");
+            return isArrayListV<T>;
         }
 
         struct Cat : Animal
         {
+            static constexpr AnimalKind staticKind = AnimalKind::Cat;
+
+            Cat() : Animal(staticKind)
+            {
+            }
             bool isCat() const
             {
                 return true;
@@ -55,6 +120,37 @@ namespace TemplateCompleteGuide
                 std::cout << "Meow\n";
             }
         };
+
+        template <typename... Ts>
+        struct TypeList
+        {
+        };
+        // Every class of the hierarchy , in the order of their AnimalKind
+        using AnimalHierarchy = TypeList<Animal, Dog, Cat>;
+
+        template <typename... Ts>
+        constexpr bool isIndexedByKind(TypeList<Ts...>)
+        {
+            std::size_t index = 0;
+            return ((static_cast<std::size_t>(Ts::staticKind) == index++) && ...) &&
+                   sizeof...(Ts) == static_cast<std::size_t>(AnimalKind::Count);
+        }
+        static_assert(isIndexedByKind(AnimalHierarchy{}), "AnimalHierarchy shall list every AnimalKind in order");
+
+        // Bit i is set if the class of kind i is Q or derives from Q
+        template <typename Q, typename... Ts>
+        constexpr unsigned kindMask(TypeList<Ts...>)
+        {
+            return ((std::is_base_of_v<Q, Ts> ? 1u << static_cast<unsigned>(Ts::staticKind) : 0u) | ...);
+        }
+
+        // Same answer as dynamic_cast<Q *>(animal) != nullptr , with a shift and a mask
+        template <typename Q>
+        constexpr bool isKindOf(AnimalKind kind)
+        {
+            constexpr auto mask = kindMask<Q>(AnimalHierarchy{});
+            return (mask >> static_cast<unsigned>(kind)) & 1u;
+        }
         struct DispatchHelperBase
         {
             constexpr auto operator()(Animal *animal)
@@ -70,48 +166,288 @@ namespace TemplateCompleteGuide
             }
             constexpr void operator()(Animal *animal)
             {
-                if (auto devi = dynamic_cast<Q *>(animal))
-                    devi->speak();
+                TCG_COUNTER_INC("constexprTest.DispatchHelper");
+                if (animal && isKindOf<Q>(animal->kind()))
+                {
+                    TCG_COUNTER_INC("constexprTest.DispatchHelper.matched");
+                    static_cast<Q *>(animal)->speak();
+                }
             }
         };
         template <typename T>
-        const auto adapter = [](const T &v)
+        constexpr auto adapter = [](const T &) constexpr
         {
-            return isArray<T>();
+            return isArrayListV<T>;
         };
 
     } // namespace constexprTest
 
     namespace chapter2
     {
+        // Default number of elements kept inline before spilling to the heap: about one cache line worth
         template <typename T>
+        constexpr std::size_t defaultInlineCapacity()
+        {
+            return sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+        }
+
+        /**
+         * Stack with small-buffer optimization: the first InlineCapacity elements are stored inside the
+         * object , the heap is only used once it grows beyond that.
+         * Capacity doubles on growth and is only given back on request (shrink_to_fit) , so a push/pop
+         * pattern around a capacity boundary never thrashes the allocator.
+         */
+        template <typename T, std::size_t InlineCapacity = defaultInlineCapacity<T>()>
         class Stack
         {
+            static_assert(InlineCapacity > 0, "At least one element shall be stored inline");
+
         private:
-            std::vector<T> elems; // elements
+            T *elems_;            // points to inline_ or to the heap buffer
+            std::size_t size_;
+            std::size_t capacity_;
+            alignas(T) unsigned char inline_[sizeof(T) * InlineCapacity];
+
         public:
+            using value_type = T;
+            using size_type = std::size_t;
+
+            Stack() noexcept : elems_(inlineData()), size_(0), capacity_(InlineCapacity)
+            {
+            }
             Stack(T elem) // initialize stack with one element by value
-                : elems({std::move(elem)})
+                : Stack()
+            {
+                push(std::move(elem));
+            }
+            Stack(Stack const &other) : Stack()
             {
+                reserve(other.size_);
+                std::uninitialized_copy(other.elems_, other.elems_ + other.size_, elems_);
+                size_ = other.size_;
             }
+            Stack(Stack &&other) noexcept(std::is_nothrow_move_constructible_v<T>) : Stack()
+            {
+                steal(other);
+            }
+            Stack &operator=(Stack const &other)
+            {
+                if (this != &other)
+                {
+                    Stack copy(other);
+                    clear();
+                    steal(copy);
+                }
+                return *this;
+            }
+            Stack &operator=(Stack &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+            {
+                if (this != &other)
+                {
+                    clear();
+                    steal(other);
+                }
+                return *this;
+            }
+            ~Stack()
+            {
+                clear();
+                releaseHeap();
+            }
+
+            void push(T const &elem)
+            {
+                emplace(elem);
+            }
+            void push(T &&elem)
+            {
+                emplace(std::move(elem));
+            }
+            template <typename... Args>
+            T &emplace(Args &&...args)
+            {
+                if (size_ == capacity_)
+                    return emplaceGrow(std::forward<Args>(args)...);
+                auto elem = ::new (static_cast<void *>(elems_ + size_)) T(std::forward<Args>(args)...);
+                ++size_;
+                return *elem;
+            }
+            void pop()
+            {
+                assert(!empty());
+                elems_[--size_].~T();
+            }
+            T &top()
+            {
+                assert(!empty());
+                return elems_[size_ - 1];
+            }
+            T const &top() const
+            {
+                assert(!empty());
+                return elems_[size_ - 1];
+            }
+            bool empty() const noexcept
+            {
+                return 0 == size_;
+            }
+            size_type size() const noexcept
+            {
+                return size_;
+            }
+            size_type capacity() const noexcept
+            {
+                return capacity_;
+            }
+            bool isInline() const noexcept
+            {
+                return elems_ == inlineData();
+            }
+            void clear() noexcept
+            {
+                if constexpr (!std::is_trivially_destructible_v<T>)
+                    std::destroy(elems_, elems_ + size_);
+                size_ = 0;
+            }
+            void reserve(size_type count)
+            {
+                if (count > capacity_)
+                    relocate(count);
+            }
+            // Moves the elements back inline when they fit , otherwise trims the heap buffer to size()
+            void shrink_to_fit()
+            {
+                if (!isInline() && size_ < capacity_)
+                    relocate(std::max(size_, InlineCapacity));
+            }
+
             auto showElementType()
             {
-                std::cout << typeid(this->elems).name() << std::endl;
-                std::cout << "The elements count is " << elems.size() << std::endl;
+                std::cout << typeid(T).name() << std::endl;
+                std::cout << "The elements count is " << size_ << std::endl;
+            }
+
+        private:
+            T *inlineData() noexcept
+            {
+                return std::launder(reinterpret_cast<T *>(inline_));
             }
-            virtual ~Stack()
+            T const *inlineData() const noexcept
             {
-                std::cout << "Bye ~ stack\n";
+                return std::launder(reinterpret_cast<T const *>(inline_));
+            }
+            // Construct the new element before relocating , args may refer to an element of this stack
+            template <typename... Args>
+            T &emplaceGrow(Args &&...args)
+            {
+                auto newCapacity = capacity_ * 2;
+                auto buffer = static_cast<T *>(::operator new(newCapacity * sizeof(T), std::align_val_t(alignof(T))));
+                try
+                {
+                    ::new (static_cast<void *>(buffer + size_)) T(std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    ::operator delete(buffer, std::align_val_t(alignof(T)));
+                    throw;
+                }
+                try
+                {
+                    moveElements(buffer);
+                }
+                catch (...)
+                {
+                    buffer[size_].~T();
+                    ::operator delete(buffer, std::align_val_t(alignof(T)));
+                    throw;
+                }
+                adopt(buffer, newCapacity);
+                ++size_;
+                return elems_[size_ - 1];
+            }
+            // Move the elements into a buffer of newCapacity elements , inline one if it fits
+            void relocate(size_type newCapacity)
+            {
+                if (newCapacity == InlineCapacity)
+                {
+                    if (isInline())
+                        return;
+                    moveElements(inlineData());
+                    releaseHeap();
+                    elems_ = inlineData();
+                    capacity_ = InlineCapacity;
+                    return;
+                }
+                auto buffer = static_cast<T *>(::operator new(newCapacity * sizeof(T), std::align_val_t(alignof(T))));
+                try
+                {
+                    moveElements(buffer);
+                }
+                catch (...)
+                {
+                    ::operator delete(buffer, std::align_val_t(alignof(T)));
+                    throw;
+                }
+                adopt(buffer, newCapacity);
+            }
+            // All the elements are built in dest before the sources are destroyed: if a copy throws , what was
+            // built is destroyed again and this stack is left unchanged
+            void moveElements(T *dest)
+            {
+                if constexpr (std::is_trivially_copyable_v<T>)
+                {
+                    if (size_)
+                        std::memcpy(static_cast<void *>(dest), elems_, size_ * sizeof(T));
+                }
+                else
+                {
+                    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+                        std::uninitialized_move(elems_, elems_ + size_, dest);
+                    else
+                        std::uninitialized_copy(elems_, elems_ + size_, dest); // as std::move_if_noexcept would
+                    std::destroy(elems_, elems_ + size_);
+                }
+            }
+            void adopt(T *buffer, size_type newCapacity) noexcept
+            {
+                releaseHeap();
+                elems_ = buffer;
+                capacity_ = newCapacity;
+            }
+            void releaseHeap() noexcept
+            {
+                if (!isInline())
+                    ::operator delete(elems_, std::align_val_t(alignof(T)));
+            }
+            // Take over the elements of an other stack , this stack shall be empty
+            void steal(Stack &other)
+            {
+                if (other.isInline())
+                {
+                    reserve(other.size_);
+                    other.moveElements(elems_);
+                }
+                else
+                {
+                    releaseHeap();
+                    elems_ = other.elems_;
+                    capacity_ = other.capacity_;
+                    other.elems_ = other.inlineData();
+                    other.capacity_ = InlineCapacity;
+                }
+                size_ = other.size_;
+                other.size_ = 0;
             }
         };
         // NOTE 1. Deduction guide , while passing char* constuct std::vector<std::string> instead
         Stack(char const *)->Stack<std::string>;
 
-        template <typename T>
+        // The comment type is a parameter so that comments can be interned , see interned_string.h
+        template <typename T, typename Comment = std::string>
         struct ValueWithComment
         {
             T value;
-            std::string comment;
+            Comment comment;
         };
         ValueWithComment(char const *, char const *)
             ->ValueWithComment<std::string>; // 2.Templatized Aggregates
@@ -121,33 +457,245 @@ namespace TemplateCompleteGuide
     namespace chapter3
     {
         // NOTE 2. Non-type parameters can be used as template param
+        // The line is known at compile time: one static buffer , see fixed_string.h
         template <int Msg>
         void greeting()
         {
-            std::cout << " Hello " << Msg << std::endl;
+            static constexpr auto line = " Hello " + toFixedString<Msg>() + "\n";
+            std::cout.write(line.data(), line.size()).flush();
         }
 
-        // NOTE 3. Using auto to accept any possible non-type template parameters
+        /**
+         * NOTE 3. Using auto to accept any possible non-type template parameters
+         * When the compiler can spell Msg , all the lines are one static buffer written at once , instead of a
+         * loop flushing every line
+         * NOTICE the buffer takes times lines of read-only data in the binary , see compile_time.cpp
+         */
         template <auto Msg, int times>
         void greeting()
         {
-            for (auto i = 0; i < times; i++)
-                std::cout << " Hello " << Msg << std::endl;
+            if constexpr (isConstantText<Msg>)
+            {
+                static constexpr auto lines = repeat<(times > 0 ? times : 0)>(" Hello " + constantText<Msg>() + "\n");
+                std::cout.write(lines.data(), static_cast<std::streamsize>(lines.size())).flush();
+            }
+            else
+            {
+                for (auto i = 0; i < times; i++)
+                    std::cout << " Hello " << Msg << '\n';
+                std::cout.flush();
+            }
         }
 
-        template <auto MaxSize, typename T = decltype(MaxSize)>
+        /**
+         * NOTE 3.1 Overflow policies of the bounded stack below, selected by template parameter.
+         * overflow() is called when pushing onto a full stack; its result is returned by push/emplace.
+         */
+        struct ThrowOnOverflow
+        {
+            static bool overflow()
+            {
+                throw std::length_error("chapter3::Stack overflow");
+            }
+        };
+        struct RejectOnOverflow
+        {
+            static constexpr bool overflow()
+            {
+                return false; // drop the element , the caller checks the result
+            }
+        };
+        struct AssertOnOverflow
+        {
+            static bool overflow()
+            {
+                assert(!"chapter3::Stack overflow"); // unchecked in release builds
+                return false;
+            }
+        };
+
+        namespace detail
+        {
+            // Trivially copyable elements live in a plain array : the stack stays a literal type usable in
+            // constant expressions , and copying it is a single memcpy.
+            // C++17 requires constexpr constructors to initialize every member , hence the value-initialized array ,
+            // O(N) for every stack built; since C++20 (P1331) the array is left uninitialized like the raw storage below
+            template <typename T, std::size_t N,
+                      bool = std::is_trivially_copyable_v<T> &&std::is_trivially_default_constructible_v<T>>
+            struct BoundedStorage
+            {
+#if __cpp_constexpr >= 201907L
+                T elems_[N];
+#else
+                T elems_[N]{};
+#endif
+                std::size_t count_ = 0;
+
+                constexpr T *data()
+                {
+                    return elems_;
+                }
+                constexpr T const *data() const
+                {
+                    return elems_;
+                }
+                template <typename... Args>
+                constexpr void construct(Args &&...args)
+                {
+                    if constexpr (std::is_constructible_v<T, Args...>)
+                        elems_[count_] = T(std::forward<Args>(args)...);
+                    else
+                        elems_[count_] = T{std::forward<Args>(args)...};
+                    ++count_;
+                }
+                constexpr void destroyTop()
+                {
+                    --count_;
+                }
+            };
+
+            // Everything else is constructed in place inside aligned raw storage
+            template <typename T, std::size_t N>
+            struct BoundedStorage<T, N, false>
+            {
+                alignas(T) unsigned char bytes_[sizeof(T) * N];
+                std::size_t count_ = 0;
+
+                BoundedStorage() = default;
+                // No destructor runs for a constructor that throws: the uninitialized algorithms destroy the
+                // elements they built themselves
+                BoundedStorage(BoundedStorage const &other)
+                {
+                    std::uninitialized_copy(other.data(), other.data() + other.count_, data());
+                    count_ = other.count_;
+                }
+                BoundedStorage(BoundedStorage &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+                {
+                    std::uninitialized_move(other.data(), other.data() + other.count_, data());
+                    count_ = other.count_;
+                }
+                BoundedStorage &operator=(BoundedStorage const &other)
+                {
+                    if (this != &other)
+                    {
+                        clear();
+                        for (; count_ < other.count_;)
+                            construct(other.data()[count_]);
+                    }
+                    return *this;
+                }
+                BoundedStorage &operator=(BoundedStorage &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+                {
+                    if (this != &other)
+                    {
+                        clear();
+                        for (; count_ < other.count_;)
+                            construct(std::move(other.data()[count_]));
+                    }
+                    return *this;
+                }
+                ~BoundedStorage()
+                {
+                    clear();
+                }
+
+                T *data()
+                {
+                    return std::launder(reinterpret_cast<T *>(bytes_));
+                }
+                T const *data() const
+                {
+                    return std::launder(reinterpret_cast<T const *>(bytes_));
+                }
+                template <typename... Args>
+                void construct(Args &&...args)
+                {
+                    auto slot = bytes_ + count_ * sizeof(T);
+                    if constexpr (std::is_constructible_v<T, Args...>)
+                        ::new (static_cast<void *>(slot)) T(std::forward<Args>(args)...);
+                    else
+                        ::new (static_cast<void *>(slot)) T{std::forward<Args>(args)...};
+                    ++count_;
+                }
+                void destroyTop()
+                {
+                    data()[--count_].~T();
+                }
+                void clear()
+                {
+                    while (count_)
+                        destroyTop();
+                }
+            };
+        } // namespace detail
+
+        /**
+         * NOTE 3.2 Bounded stack whose capacity is a non-type template parameter:
+         * the elements are stored inline , no heap allocation is ever performed.
+         * The type of MaxSize also becomes the size_type of the stack , e.g. Stack<100u> vs Stack<100l>
+         */
+        template <auto MaxSize, typename T = decltype(MaxSize), typename OverflowPolicy = ThrowOnOverflow>
         class Stack
         {
+            static_assert(MaxSize > 0, "The capacity of a bounded stack shall be positive");
+
         public:
-            Stack() : numCount_(0) {}
-            auto size()
+            using value_type = T;
+            using size_type = decltype(MaxSize);
+
+            constexpr Stack() = default;
+
+            static constexpr size_type capacity()
             {
                 return MaxSize;
             }
+            constexpr size_type size() const
+            {
+                return static_cast<size_type>(storage_.count_);
+            }
+            constexpr bool empty() const
+            {
+                return 0 == storage_.count_;
+            }
+            constexpr bool full() const
+            {
+                return static_cast<std::size_t>(MaxSize) == storage_.count_;
+            }
+            constexpr bool push(T const &elem)
+            {
+                return emplace(elem);
+            }
+            constexpr bool push(T &&elem)
+            {
+                return emplace(std::move(elem));
+            }
+            // Returns false if the element was rejected by the overflow policy
+            template <typename... Args>
+            constexpr bool emplace(Args &&...args)
+            {
+                if (full())
+                    return OverflowPolicy::overflow();
+                storage_.construct(std::forward<Args>(args)...);
+                return true;
+            }
+            constexpr void pop()
+            {
+                assert(!empty());
+                storage_.destroyTop();
+            }
+            constexpr T &top()
+            {
+                assert(!empty());
+                return storage_.data()[storage_.count_ - 1];
+            }
+            constexpr T const &top() const
+            {
+                assert(!empty());
+                return storage_.data()[storage_.count_ - 1];
+            }
 
         private:
-            std::vector<T> elements_;
-            T numCount_;
+            detail::BoundedStorage<T, static_cast<std::size_t>(MaxSize)> storage_;
         };
 
         // NOTE 4. decltype(auto)
@@ -158,8 +706,18 @@ namespace TemplateCompleteGuide
             DecltypeAuto() : value_(N)
             {
             }
+            // A value (not a reference) the compiler can spell is written from a static buffer
             void operate()
             {
+                if constexpr (!std::is_reference_v<decltype(N)>)
+                {
+                    if constexpr (isConstantText<N>)
+                    {
+                        static constexpr auto line = constantText<N>() + "\n";
+                        std::cout.write(line.data(), static_cast<std::streamsize>(line.size())).flush();
+                        return;
+                    }
+                }
                 std::cout << value_ << std::endl;
             }
 
@@ -195,16 +753,21 @@ namespace TemplateCompleteGuide
          * NOTICE The empty/more specified version shall appear before more general ones
          *
          */
-        void print()
+        inline void print()
         {
             std::cout << std::endl;
         }
+        /**
+         * NOTE 6.1 The recursion of NOTE 5 instantiates print once per remaining suffix of the pack , i.e. N
+         * functions whose names grow with N for a call with N arguments. A fold expression does the same work in
+         * a single instantiation , see benchmark/compile_time.cpp for the compile time and memory of both forms.
+         */
         template <typename T, typename... Types>
         void print(T firstArg, Types... args)
         {
-
+            TCG_SCOPED_TIMER("chapter4.print");
             std::cout << firstArg; // print first argument
-            print(args...);        // Will call empty implementation if no argument remain
+            (std::cout << ... << args) << std::endl;
         }
         namespace overload
         {
@@ -222,33 +785,35 @@ namespace TemplateCompleteGuide
 
             namespace preferred
             {
-                auto detailedPrint()
-                {
-                }
-                template <typename T, typename... Ts>
-                auto detailedPrint(T const &arg, Ts const &...args)
+                /**
+                 * One overload per argument instead of one per remaining pack: every argument is matched against
+                 * all the printers below , whereas in the recursive form a printer declared later than its caller
+                 * was never chosen for fundamental types (two-phase lookup finds no associated namespace for them)
+                 */
+                template <typename T>
+                auto detailedPrintArg(T const &arg)
                 {
                     std::cout << "Calling generic printer:"
                               << "\n\btype:" << typeid(arg).name() << "\n\bvalue:" << arg << std::endl;
-                    detailedPrint(args...);
                 }
-                template <typename... T>
-                auto detailedPrint(int arg, T const &...args)
+                inline auto detailedPrintArg(int arg)
                 {
                     std::cout << "Calling int printer: " << arg << std::endl;
-                    detailedPrint(args...);
                 }
-                template <typename... T>
-                auto detailedPrint(double arg, T const &...args)
+                inline auto detailedPrintArg(double arg)
                 {
                     std::cout << "Calling double printer: " << arg << std::endl;
-                    detailedPrint(args...);
                 }
-                template <typename... T>
-                auto detailedPrint(const std::string &arg, T const &...args)
+                inline auto detailedPrintArg(const std::string &arg)
                 {
                     std::cout << "Calling string printer: " << arg << std::endl;
-                    detailedPrint(args...);
+                }
+
+                template <typename... Ts>
+                auto detailedPrint(Ts const &...args)
+                {
+                    TCG_SCOPED_TIMER("chapter4.overload.preferred.detailedPrint");
+                    (detailedPrintArg(args), ...);
                 }
 
             } // namespace preferred
@@ -262,7 +827,7 @@ namespace TemplateCompleteGuide
          */
         namespace usageOfSizeof
         {
-            void print()
+            inline void print()
             {
                 std::cout << std::endl;
             }
@@ -329,15 +894,10 @@ namespace TemplateCompleteGuide
          * NOTE 9.2 Usage of variadic template : variadic indices
          */
 
-        auto printHelper()
-        {
-        }
-
-        template <typename T, typename... Ts>
-        auto printHelper(const T &arg0, const Ts &...args)
+        template <typename... Ts>
+        auto printHelper(const Ts &...args)
         {
-            std::cout << arg0;
-            printHelper(args...);
+            (std::cout << ... << args); // one instantiation whatever the number of arguments
         }
         namespace variadicIndices
         {
@@ -376,10 +936,21 @@ namespace TemplateCompleteGuide
             {
             };
 
+            // Indices<0, 1, ..., N - 1>
+            template <int... idx>
+            constexpr Indices<idx...> toIndices(std::integer_sequence<int, idx...>)
+            {
+                return {};
+            }
+            template <int N>
+            using MakeIndices = decltype(toIndices(std::make_integer_sequence<int, N>()));
+
+            // get is looked up by ADL too , so any tuple-like type providing get<I> can be printed , e.g. Tuple
             template <int... idx, typename T>
-            auto printByIndex(T ct, Indices<idx...>)
+            auto printByIndex(T const &ct, Indices<idx...>)
             {
-                printHelper(std::get<idx>(ct)...);
+                using std::get;
+                printHelper(get<idx>(ct)...);
             }
 
         } // namespace variadicClassTemplates
@@ -415,21 +986,34 @@ namespace TemplateCompleteGuide
                 std::string name;
 
             public:
-                Customer(std::string const &n) : name(n) {}
-                std::string getName() const { return name; }
+                Customer(std::string n) : name(std::move(n)) {}
+                std::string const &getName() const { return name; } // no copy for every hash or comparison
             };
+            // Customers can also be compared with and hashed as a plain name , e.g. to look one up without building it
             struct CustomerEq
             {
                 bool operator()(Customer const &c1, Customer const &c2) const
                 {
                     return c1.getName() == c2.getName();
                 }
+                bool operator()(Customer const &c, std::string_view name) const
+                {
+                    return c.getName() == name;
+                }
+                bool operator()(std::string_view name, Customer const &c) const
+                {
+                    return c.getName() == name;
+                }
             };
             struct CustomerHash
             {
                 std::size_t operator()(Customer const &c) const
                 {
-                    return std::hash<std::string>()(c.getName());
+                    return std::hash<std::string_view>()(c.getName());
+                }
+                std::size_t operator()(std::string_view name) const
+                {
+                    return std::hash<std::string_view>()(name);
                 }
             };
             // define class that combines operator() for variadic base classes:
@@ -438,6 +1022,9 @@ namespace TemplateCompleteGuide
             {
                 using Bases::operator()...; // OK since C++17
             };
+            // e.g. Overloader{[](int) {}, [](double) {}}
+            template <typename... Bases>
+            Overloader(Bases...) -> Overloader<Bases...>;
 
         } // namespace variadicBaseClassAndUsing
 
@@ -490,13 +1077,15 @@ namespace TemplateCompleteGuide
                 }
                 //...
             };
-            auto left = &Node::left;
-            auto right = &Node::right;
+            inline constexpr auto left = &Node::left;
+            inline constexpr auto right = &Node::right;
 
             // e.g. 3. traverse tree, using fold expression:
             template <typename T, typename... TP>
             Node *traverse(T np, TP... paths)
             {
+                TCG_SCOPED_TIMER("chapter4.application.traverse");
+                TCG_COUNTER_ADD("chapter4.application.traverse.steps", sizeof...(paths));
                 return (np->*...->*paths); // np ->* paths1 ->* paths2 ...
             }
 
@@ -0,0 +1,547 @@
+#ifndef TERMINAL_H
+#define TERMINAL_H
+
+#pragma once
+
+#include "buffered_print.h"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+
+#if !defined _WIN32
+#include <signal.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace TemplateCompleteGuide
+{
+    /**
+     * NOTE Terminal rendering without a shell
+     * Clear() and reprint costs a process and a whole screen per refresh. The Renderer keeps what the terminal
+     * shows (front) and what the next frame shall show (back) as cells , and present() sends only the spans that
+     * differ , as ANSI escape sequences in a single write. Any ANSI terminal or pty will do , no terminfo needed.
+     *
+     *  terminal::Renderer screen;         // standard output , follows its size through SIGWINCH
+     *  for (;;)
+     *  {
+     *      screen.clear();                // starts a frame
+     *      screen.text(0, 0, "requests");
+     *      screen.present();              // one write with the changes
+     *  }
+     */
+    namespace terminal
+    {
+        enum class Color : std::uint8_t
+        {
+            Black,
+            Red,
+            Green,
+            Yellow,
+            Blue,
+            Magenta,
+            Cyan,
+            White,
+            Default = 9, // SGR 39
+        };
+        struct Style
+        {
+            Color foreground = Color::Default;
+            bool bold = false;
+            bool reverse = false;
+
+            friend bool operator==(Style lhs, Style rhs) noexcept
+            {
+                return lhs.foreground == rhs.foreground && lhs.bold == rhs.bold && lhs.reverse == rhs.reverse;
+            }
+            friend bool operator!=(Style lhs, Style rhs) noexcept
+            {
+                return !(lhs == rhs);
+            }
+        };
+        struct Cell
+        {
+            char character = ' ';
+            Style style;
+
+            friend bool operator==(Cell lhs, Cell rhs) noexcept
+            {
+                return lhs.character == rhs.character && lhs.style == rhs.style;
+            }
+            friend bool operator!=(Cell lhs, Cell rhs) noexcept
+            {
+                return !(lhs == rhs);
+            }
+        };
+
+        static_assert(sizeof(Cell) == 4 && std::is_trivially_copyable_v<Cell>, "Rows of cells are compared and copied as bytes");
+
+        struct Size
+        {
+            int columns = 80;
+            int rows = 24;
+
+            friend bool operator==(Size lhs, Size rhs) noexcept
+            {
+                return lhs.columns == rhs.columns && lhs.rows == rhs.rows;
+            }
+            friend bool operator!=(Size lhs, Size rhs) noexcept
+            {
+                return !(lhs == rhs);
+            }
+        };
+
+        // Size of the terminal behind fd , 80x24 when it is not a terminal
+        inline Size querySize(int fd)
+        {
+#if !defined _WIN32
+            winsize window{};
+            if (::ioctl(fd, TIOCGWINSZ, &window) == 0 && window.ws_col > 0 && window.ws_row > 0)
+                return {window.ws_col, window.ws_row};
+#else
+            (void)fd;
+#endif
+            return {};
+        }
+        inline bool isTerminal(int fd)
+        {
+#if defined _WIN32
+            return ::_isatty(fd) != 0;
+#else
+            return ::isatty(fd) != 0;
+#endif
+        }
+
+        namespace detail
+        {
+            // Set by the SIGWINCH handler , the next frame picks the new size up
+            inline std::atomic<bool> resizePending{false};
+            static_assert(std::atomic<bool>::is_always_lock_free, "Touched by a signal handler");
+
+            inline void onResize(int)
+            {
+                resizePending.store(true, std::memory_order_relaxed);
+            }
+        } // namespace detail
+
+        class Renderer
+        {
+        public:
+            // A terminal: its size is followed through SIGWINCH , the cursor is hidden while rendering
+            explicit Renderer(int fd = 1) : Renderer(fd, querySize(fd), isTerminal(fd))
+            {
+            }
+            // Anything else , e.g. a pipe or a file , of a fixed size
+            Renderer(int fd, Size size) : Renderer(fd, size, false)
+            {
+            }
+            Renderer(Renderer const &) = delete;
+            Renderer &operator=(Renderer const &) = delete;
+            ~Renderer()
+            {
+                // Default style , cursor shown again , below the last frame
+                char restore[32];
+                auto length = std::snprintf(restore, sizeof(restore), "\033[0m\033[%d;1H\n\033[?25h", size_.rows);
+                chapter4::buffered::writeAll(fd_, restore, static_cast<std::size_t>(length));
+#if !defined _WIN32
+                if (followsSize_)
+                    ::sigaction(SIGWINCH, &previousAction_, nullptr);
+#endif
+            }
+
+            Size size() const noexcept
+            {
+                return size_;
+            }
+
+            // Start a frame: adopt a new terminal size if any , and blank the back buffer
+            void clear(Style style = {})
+            {
+                if (followsSize_ && detail::resizePending.exchange(false, std::memory_order_relaxed))
+                    resize(querySize(fd_));
+                auto columns = static_cast<std::size_t>(size_.columns);
+                std::fill_n(back_.begin(), columns, Cell{' ', style});
+                for (auto row = back_.begin() + columns; row != back_.end(); row += columns)
+                    std::copy_n(back_.begin(), columns, row);
+            }
+            // Write text at (column , row) , clipped to the screen , returns the number of cells written
+            int text(int column, int row, std::string_view text, Style style = {})
+            {
+                if (row < 0 || row >= size_.rows || column >= size_.columns)
+                    return 0;
+                int written = 0;
+                for (auto character : text)
+                {
+                    if (column >= size_.columns)
+                        break;
+                    if (column >= 0)
+                    {
+                        back_[index(column, row)] = {character, style};
+                        ++written;
+                    }
+                    ++column;
+                }
+                return written;
+            }
+            int fill(int column, int row, int count, char character, Style style = {})
+            {
+                int written = 0;
+                for (; count > 0 && column < size_.columns; --count, ++column)
+                    written += text(column, row, std::string_view(&character, 1), style);
+                return written;
+            }
+            Cell const &at(int column, int row) const
+            {
+                return back_[index(column, row)];
+            }
+
+            // The next frame is sent whole , e.g. when something else wrote to the terminal
+            void invalidate() noexcept
+            {
+                fullRedraw_ = true;
+            }
+
+            // Send the cells that changed since the last frame in one write , returns the bytes written
+            std::size_t present()
+            {
+                out_.clear();
+                if (fullRedraw_)
+                {
+                    out_ += "\033[0m\033[2J"; // the screen is now blank in the default style , as front_ says
+                    std::fill(front_.begin(), front_.end(), Cell{});
+                    fullRedraw_ = false;
+                    cursorColumn_ = cursorRow_ = -1;
+                    currentStyle_ = Style{};
+                }
+                for (int row = 0; row < size_.rows; ++row)
+                    diffRow(row);
+                front_ = back_;
+                ++frames_;
+                if (out_.empty())
+                    return 0;
+                chapter4::buffered::writeAll(fd_, out_.data(), out_.size());
+                bytesWritten_ += out_.size();
+                return out_.size();
+            }
+
+            std::uint64_t frames() const noexcept
+            {
+                return frames_;
+            }
+            std::uint64_t bytesWritten() const noexcept
+            {
+                return bytesWritten_;
+            }
+
+        private:
+            // Equal cells between two changes are sent anyway below this gap , cheaper than moving the cursor
+            static constexpr int gapToSkip = 6;
+
+            Renderer(int fd, Size size, bool followsSize) : fd_(fd), followsSize_(followsSize)
+            {
+                resize(size);
+#if !defined _WIN32
+                if (followsSize_)
+                {
+                    struct sigaction action = {};
+                    action.sa_handler = detail::onResize;
+                    sigemptyset(&action.sa_mask);
+                    action.sa_flags = SA_RESTART;
+                    ::sigaction(SIGWINCH, &action, &previousAction_);
+                }
+#endif
+                chapter4::buffered::writeAll(fd_, "\033[?25l", 6); // hide the cursor
+            }
+
+            std::size_t index(int column, int row) const noexcept
+            {
+                return static_cast<std::size_t>(row) * static_cast<std::size_t>(size_.columns) + static_cast<std::size_t>(column);
+            }
+            void resize(Size size)
+            {
+                size_ = {std::max(size.columns, 1), std::max(size.rows, 1)};
+                back_.assign(index(0, size_.rows), Cell{});
+                front_ = back_;
+                fullRedraw_ = true;
+            }
+
+            void diffRow(int row)
+            {
+                auto begin = index(0, row);
+                if (std::memcmp(&back_[begin], &front_[begin], static_cast<std::size_t>(size_.columns) * sizeof(Cell)) == 0)
+                    return; // most rows of a live display
+                for (int column = 0; column < size_.columns;)
+                {
+                    if (back_[begin + column] == front_[begin + column])
+                    {
+                        ++column;
+                        continue;
+                    }
+                    // A span ends after gapToSkip equal cells in a row
+                    int end = column + 1, equal = 0;
+                    for (int next = end; next < size_.columns && equal < gapToSkip; ++next)
+                    {
+                        if (back_[begin + next] == front_[begin + next])
+                            ++equal;
+                        else
+                        {
+                            end = next + 1;
+                            equal = 0;
+                        }
+                    }
+                    emitSpan(row, column, end);
+                    column = end;
+                }
+            }
+            void emitSpan(int row, int begin, int end)
+            {
+                if (row != cursorRow_ || begin != cursorColumn_)
+                {
+                    char move[24];
+                    auto length = std::snprintf(move, sizeof(move), "\033[%d;%dH", row + 1, begin + 1);
+                    out_.append(move, static_cast<std::size_t>(length));
+                }
+                for (auto column = begin; column < end; ++column)
+                {
+                    auto const &cell = back_[index(column, row)];
+                    if (cell.style != currentStyle_)
+                        emitStyle(cell.style);
+                    out_ += cell.character;
+                }
+                cursorRow_ = row;
+                // After the last column the cursor waits to wrap , its position is not worth guessing
+                cursorColumn_ = end < size_.columns ? end : -1;
+            }
+            void emitStyle(Style style)
+            {
+                out_ += "\033[0";
+                if (style.bold)
+                    out_ += ";1";
+                if (style.reverse)
+                    out_ += ";7";
+                out_ += ";3";
+                out_ += static_cast<char>('0' + static_cast<int>(style.foreground));
+                out_ += 'm';
+                currentStyle_ = style;
+            }
+
+            int fd_;
+            bool followsSize_;
+            Size size_;
+            std::vector<Cell> back_, front_;
+            std::string out_; // the escape sequences of a frame , kept to reuse its capacity
+            bool fullRedraw_ = true;
+            int cursorColumn_ = -1, cursorRow_ = -1;
+            Style currentStyle_;
+            std::uint64_t frames_ = 0, bytesWritten_ = 0;
+#if !defined _WIN32
+            struct sigaction previousAction_ = {};
+#endif
+        };
+
+        /**
+         * Latencies in power-of-two buckets of nanoseconds , bucket i holds [2^i , 2^(i+1)) and bucket 0 holds 0
+         * and 1. record() may be called from any thread while the dashboard shows it.
+         */
+        class LatencyHistogram
+        {
+        public:
+            static constexpr int bucketCount = 40; // up to about 18 minutes
+
+            void record(std::uint64_t nanoseconds) noexcept
+            {
+                buckets_[bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+            }
+            std::uint64_t bucket(int i) const noexcept
+            {
+                return buckets_[i].load(std::memory_order_relaxed);
+            }
+            std::uint64_t count() const noexcept
+            {
+                std::uint64_t total = 0;
+                for (auto const &each : buckets_)
+                    total += each.load(std::memory_order_relaxed);
+                return total;
+            }
+            // Upper bound of the bucket holding the p-th quantile , 0 when empty
+            std::uint64_t percentile(double p) const noexcept
+            {
+                auto total = count();
+                if (!total)
+                    return 0;
+                auto rank = static_cast<std::uint64_t>(std::ceil(p * static_cast<double>(total)));
+                std::uint64_t seen = 0;
+                for (int i = 0; i < bucketCount; ++i)
+                    if ((seen += bucket(i)) >= std::max<std::uint64_t>(rank, 1))
+                        return upperBound(i);
+                return upperBound(bucketCount - 1);
+            }
+            void reset() noexcept
+            {
+                for (auto &each : buckets_)
+                    each.store(0, std::memory_order_relaxed);
+            }
+
+            static int bucketOf(std::uint64_t nanoseconds) noexcept
+            {
+                int i = 0;
+                while (nanoseconds > 1 && i < bucketCount - 1)
+                {
+                    nanoseconds >>= 1;
+                    ++i;
+                }
+                return i;
+            }
+            static std::uint64_t upperBound(int i) noexcept
+            {
+                return (std::uint64_t(2) << i) - 1;
+            }
+
+        private:
+            std::atomic<std::uint64_t> buckets_[bucketCount] = {};
+        };
+
+        // e.g. 950ns , 12.3us , 4.5ms , 2.0s
+        inline std::string formatDuration(double nanoseconds)
+        {
+            char text[32];
+            if (nanoseconds < 1e3)
+                std::snprintf(text, sizeof(text), "%.0fns", nanoseconds);
+            else if (nanoseconds < 1e6)
+                std::snprintf(text, sizeof(text), "%.1fus", nanoseconds / 1e3);
+            else if (nanoseconds < 1e9)
+                std::snprintf(text, sizeof(text), "%.1fms", nanoseconds / 1e6);
+            else
+                std::snprintf(text, sizeof(text), "%.1fs", nanoseconds / 1e9);
+            return text;
+        }
+
+        /**
+         * Live counters and latency histograms on a Renderer , redrawn by render()
+         *
+         *  terminal::Dashboard dashboard(screen , "server");
+         *  auto &latency = dashboard.histogram("request");
+         *  ...latency.record(ns) on any thread...
+         *  dashboard.counter("requests/s" , rate);
+         *  dashboard.render();
+         */
+        class Dashboard
+        {
+        public:
+            Dashboard(Renderer &renderer, std::string title) : renderer_(renderer), title_(std::move(title))
+            {
+            }
+
+            void counter(std::string_view name, double value)
+            {
+                for (auto &[each, current] : counters_)
+                    if (each == name)
+                    {
+                        current = value;
+                        return;
+                    }
+                counters_.emplace_back(std::string(name), value);
+            }
+            // Created on first use , the reference stays valid as long as the dashboard
+            LatencyHistogram &histogram(std::string_view name)
+            {
+                for (auto &[each, histogram] : histograms_)
+                    if (each == name)
+                        return histogram;
+                histograms_.emplace_back(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple());
+                return histograms_.back().second;
+            }
+
+            // Draw everything into the back buffer and present it , returns the bytes written
+            std::size_t render()
+            {
+                renderer_.clear();
+                auto size = renderer_.size();
+                int row = 0;
+                renderer_.fill(0, row, size.columns, ' ', titleStyle);
+                renderer_.text(1, row++, title_, titleStyle);
+                ++row;
+                for (auto const &[name, value] : counters_)
+                {
+                    renderer_.text(1, row, std::string_view(name).substr(0, nameWidth));
+                    number(2 + nameWidth + valueWidth, row++, value);
+                }
+                for (auto const &[name, histogram] : histograms_)
+                    row = drawHistogram(row + 1, name, histogram);
+                return renderer_.present();
+            }
+
+        private:
+            static constexpr Style titleStyle{Color::Default, true, true};
+            static constexpr Style headerStyle{Color::Default, true, false};
+            static constexpr Style barStyle{Color::Green, false, false};
+            static constexpr int nameWidth = 20, valueWidth = 12, labelWidth = 10, countWidth = 12;
+
+            // Formatted like std::cout does , right-aligned to end before column end; every frame formats
+            // all the numbers , so to_chars rather than snprintf
+            template <typename T>
+            void number(int end, int row, T value)
+            {
+                char text[chapter4::buffered::FormattedSize<T>::value];
+                auto length = static_cast<int>(chapter4::buffered::formatPiece(text, value) - text);
+                renderer_.text(end - length, row, std::string_view(text, static_cast<std::size_t>(length)));
+            }
+            // "<1.0us" and so on , the same for every frame
+            static std::string_view bucketLabel(int i)
+            {
+                static auto const labels = []
+                {
+                    std::vector<std::string> result;
+                    for (int each = 0; each < LatencyHistogram::bucketCount; ++each)
+                        result.push_back("<" + formatDuration(static_cast<double>(LatencyHistogram::upperBound(each) + 1)));
+                    return result;
+                }();
+                return labels[static_cast<std::size_t>(i)];
+            }
+
+            int drawHistogram(int row, std::string const &name, LatencyHistogram const &histogram)
+            {
+                auto size = renderer_.size();
+                std::uint64_t counts[LatencyHistogram::bucketCount], total = 0, highest = 0;
+                int first = LatencyHistogram::bucketCount, last = -1;
+                for (int i = 0; i < LatencyHistogram::bucketCount; ++i)
+                    if ((counts[i] = histogram.bucket(i)) != 0)
+                    {
+                        first = std::min(first, i);
+                        last = i;
+                        total += counts[i];
+                        highest = std::max(highest, counts[i]);
+                    }
+                auto header = name + "  count ";
+                auto column = 1 + renderer_.text(1, row, header, headerStyle);
+                char text[24];
+                auto end = std::to_chars(text, text + sizeof(text), total).ptr;
+                column += renderer_.text(column, row, std::string_view(text, static_cast<std::size_t>(end - text)), headerStyle);
+                for (auto [label, p] : {std::pair{"  p50 ", 0.5}, std::pair{"  p99 ", 0.99}, std::pair{"  p999 ", 0.999}})
+                {
+                    column += renderer_.text(column, row, label, headerStyle);
+                    column += renderer_.text(column, row, formatDuration(static_cast<double>(histogram.percentile(p))), headerStyle);
+                }
+                ++row;
+                auto barWidth = std::max(size.columns - labelWidth - countWidth - 4, 1);
+                for (int i = first; i <= last && row < size.rows; ++i, ++row)
+                {
+                    renderer_.text(1, row, bucketLabel(i));
+                    auto length = static_cast<int>(static_cast<double>(counts[i]) / static_cast<double>(highest) * barWidth + 0.5);
+                    renderer_.fill(1 + labelWidth, row, length, '#', barStyle);
+                    number(2 + labelWidth + barWidth + countWidth, row, counts[i]);
+                }
+                return row;
+            }
+
+            Renderer &renderer_;
+            std::string title_;
+            std::vector<std::pair<std::string, double>> counters_;
+            std::deque<std::pair<std::string, LatencyHistogram>> histograms_; // never moved , see histogram()
+        };
+
+    } // namespace terminal
+
+} // namespace TemplateCompleteGuide
+
+#endif
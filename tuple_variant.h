@@ -0,0 +1,512 @@
+#ifndef TUPLE_VARIANT_H
+#define TUPLE_VARIANT_H
+
+#pragma once
+
+#include "template_complete_guide.h"
+#include <exception>
+#include <limits>
+
+namespace TemplateCompleteGuide
+{
+    namespace chapter4
+    {
+        namespace variadicClassTemplates
+        {
+            template <std::size_t I, typename... T>
+            using TypeAt = std::tuple_element_t<I, std::tuple<T...>>;
+
+            /**
+             * NOTE 9.3.3 Implementation of Tuple
+             * The members are stored sorted by decreasing alignment , which minimizes the padding between them ,
+             * e.g. Tuple<char, double, char> takes 16 bytes where std::tuple takes 24. get<I> still uses the
+             * logical index , the position in T... , whatever the storage position.
+             * Empty members (stateless functors , tags) are base classes instead of members and take no room.
+             */
+            template <typename... T>
+            constexpr auto storageOrder()
+            {
+                std::array<std::size_t, sizeof...(T)> order{};
+                std::array<std::size_t, sizeof...(T)> alignments{alignof(T)...};
+                for (std::size_t i = 0; i < order.size(); ++i)
+                {
+                    // Stable insertion sort , members of the same alignment keep their logical order
+                    auto j = i;
+                    for (; j > 0 && alignments[order[j - 1]] < alignments[i]; --j)
+                        order[j] = order[j - 1];
+                    order[j] = i;
+                }
+                return order;
+            }
+            template <typename... T, std::size_t... position>
+            auto storageSequence(std::index_sequence<position...>) -> std::index_sequence<storageOrder<T...>()[position]...>;
+            template <typename... T>
+            using StorageSequence = decltype(storageSequence<T...>(std::index_sequence_for<T...>()));
+
+            // Member of logical index I
+            template <std::size_t I, typename T, bool = std::is_empty_v<T> && !std::is_final_v<T>>
+            struct TupleLeaf
+            {
+                T value;
+
+                constexpr TupleLeaf() : value()
+                {
+                }
+                template <typename U>
+                constexpr TupleLeaf(std::in_place_t, U &&u) : value(std::forward<U>(u))
+                {
+                }
+                constexpr T &get() noexcept
+                {
+                    return value;
+                }
+                constexpr T const &get() const noexcept
+                {
+                    return value;
+                }
+            };
+            // Empty base optimization
+            template <std::size_t I, typename T>
+            struct TupleLeaf<I, T, true> : T
+            {
+                constexpr TupleLeaf() : T()
+                {
+                }
+                template <typename U>
+                constexpr TupleLeaf(std::in_place_t, U &&u) : T(std::forward<U>(u))
+                {
+                }
+                constexpr T &get() noexcept
+                {
+                    return *this;
+                }
+                constexpr T const &get() const noexcept
+                {
+                    return *this;
+                }
+            };
+
+            // The leaves are base classes in storage order , which is the order they are laid out in
+            template <typename Order, typename... T>
+            struct TupleStorage;
+            template <std::size_t... order, typename... T>
+            struct TupleStorage<std::index_sequence<order...>, T...> : TupleLeaf<order, TypeAt<order, T...>>...
+            {
+                constexpr TupleStorage() = default;
+                // Every leaf picks its own argument , by logical index
+                template <typename... Args>
+                constexpr TupleStorage(std::in_place_t, Args &&...args)
+                    : TupleLeaf<order, TypeAt<order, T...>>(std::in_place, std::get<order>(std::forward_as_tuple(std::forward<Args>(args)...)))...
+                {
+                }
+            };
+
+            template <typename... T>
+            class Tuple
+            {
+            public:
+                constexpr Tuple() = default;
+                template <typename... Args,
+                          typename = std::enable_if_t<sizeof...(Args) == sizeof...(T) && sizeof...(T) != 0 &&
+                                                      (std::is_constructible_v<T, Args &&> && ...) &&
+                                                      !(sizeof...(Args) == 1 && (std::is_same_v<std::decay_t<Args>, Tuple> || ...))>>
+                constexpr Tuple(Args &&...args) : storage_(std::in_place, std::forward<Args>(args)...)
+                {
+                }
+
+                template <std::size_t I>
+                constexpr TypeAt<I, T...> &get() & noexcept
+                {
+                    return static_cast<TupleLeaf<I, TypeAt<I, T...>> &>(storage_).get();
+                }
+                template <std::size_t I>
+                constexpr TypeAt<I, T...> const &get() const & noexcept
+                {
+                    return static_cast<TupleLeaf<I, TypeAt<I, T...>> const &>(storage_).get();
+                }
+                template <std::size_t I>
+                constexpr TypeAt<I, T...> &&get() && noexcept
+                {
+                    return std::move(get<I>());
+                }
+
+            private:
+                TupleStorage<StorageSequence<T...>, T...> storage_;
+            };
+            template <typename... T>
+            Tuple(T...) -> Tuple<T...>;
+
+            template <std::size_t I, typename... T>
+            constexpr decltype(auto) get(Tuple<T...> &tuple) noexcept
+            {
+                return tuple.template get<I>();
+            }
+            template <std::size_t I, typename... T>
+            constexpr decltype(auto) get(Tuple<T...> const &tuple) noexcept
+            {
+                return tuple.template get<I>();
+            }
+            template <std::size_t I, typename... T>
+            constexpr decltype(auto) get(Tuple<T...> &&tuple) noexcept
+            {
+                return std::move(tuple).template get<I>();
+            }
+
+            /**
+             * NOTE 9.3.4 Implementation of Variant
+             *  - the discriminator is the smallest unsigned type able to index every alternative
+             *  - visit jumps through a table of one function per alternative , generated at compile time
+             *  - emplace builds the new value before destroying the current one whenever it may throw and the
+             *    alternative can be moved without throwing , so the variant only becomes valueless if an
+             *    alternative can throw both while being built and while being moved
+             */
+            struct BadVariantAccess : std::exception
+            {
+                char const *what() const noexcept override
+                {
+                    return "bad variant access";
+                }
+            };
+
+            template <std::size_t count>
+            using Discriminator = std::conditional_t<(count < std::numeric_limits<std::uint8_t>::max()), std::uint8_t,
+                                                     std::conditional_t<(count < std::numeric_limits<std::uint16_t>::max()), std::uint16_t, std::uint32_t>>;
+
+            // Which alternative a value of type U converts to: overload resolution among one operator() per
+            // alternative , with bool only considered for bool values (no pointer or string to bool surprises)
+            template <std::size_t I, typename T, typename U, bool = !std::is_same_v<std::decay_t<T>, bool> || std::is_same_v<std::decay_t<U>, bool>>
+            struct AlternativeSelector
+            {
+                std::integral_constant<std::size_t, I> operator()(T) const;
+            };
+            template <std::size_t I, typename T, typename U>
+            struct AlternativeSelector<I, T, U, false>
+            {
+                void operator()(struct NeverSelected) const;
+            };
+            template <typename U, typename Sequence, typename... T>
+            struct SelectAlternative;
+            template <typename U, std::size_t... I, typename... T>
+            struct SelectAlternative<U, std::index_sequence<I...>, T...> : AlternativeSelector<I, T, U>...
+            {
+                using AlternativeSelector<I, T, U>::operator()...;
+            };
+            template <typename U, typename... T>
+            using AlternativeFor = decltype(std::declval<SelectAlternative<U, std::index_sequence_for<T...>, T...>>()(std::declval<U>()));
+
+            template <typename T, typename... Ts>
+            constexpr std::size_t indexOf()
+            {
+                std::size_t index = 0;
+                bool found = ((++index, std::is_same_v<T, Ts>) || ...);
+                return found ? index - 1 : sizeof...(Ts);
+            }
+
+            template <typename... T>
+            class Variant
+            {
+                static_assert(sizeof...(T) > 0, "A variant needs at least one alternative");
+                using Index = Discriminator<sizeof...(T)>;
+
+            public:
+                static constexpr std::size_t npos = std::numeric_limits<Index>::max();
+
+                Variant() noexcept(std::is_nothrow_default_constructible_v<TypeAt<0, T...>>)
+                {
+                    construct<0>();
+                }
+                template <typename U, typename Selected = AlternativeFor<U &&, T...>,
+                          typename = std::enable_if_t<!std::is_same_v<std::decay_t<U>, Variant>>>
+                Variant(U &&value)
+                {
+                    construct<Selected::value>(std::forward<U>(value));
+                }
+                template <std::size_t I, typename... Args>
+                explicit Variant(std::in_place_index_t<I>, Args &&...args)
+                {
+                    construct<I>(std::forward<Args>(args)...);
+                }
+                Variant(Variant const &other)
+                {
+                    if (!other.valueless_by_exception())
+                        copyTable()[other.index_](*this, other);
+                }
+                Variant(Variant &&other) noexcept((std::is_nothrow_move_constructible_v<T> && ...))
+                {
+                    if (!other.valueless_by_exception())
+                        moveTable()[other.index_](*this, other);
+                }
+                Variant &operator=(Variant const &other)
+                {
+                    if (this != &other)
+                    {
+                        if (other.valueless_by_exception())
+                            reset();
+                        else
+                            copyAssignTable()[other.index_](*this, other);
+                    }
+                    return *this;
+                }
+                Variant &operator=(Variant &&other) noexcept(((std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>) && ...))
+                {
+                    if (this != &other)
+                    {
+                        if (other.valueless_by_exception())
+                            reset();
+                        else
+                            moveAssignTable()[other.index_](*this, other);
+                    }
+                    return *this;
+                }
+                template <typename U, typename Selected = AlternativeFor<U &&, T...>,
+                          typename = std::enable_if_t<!std::is_same_v<std::decay_t<U>, Variant>>>
+                Variant &operator=(U &&value)
+                {
+                    if (index_ == Selected::value)
+                        get<Selected::value>() = std::forward<U>(value);
+                    else
+                        emplace<Selected::value>(std::forward<U>(value));
+                    return *this;
+                }
+                ~Variant()
+                {
+                    reset();
+                }
+
+                std::size_t index() const noexcept
+                {
+                    return index_;
+                }
+                bool valueless_by_exception() const noexcept
+                {
+                    return npos == index_;
+                }
+
+                template <std::size_t I, typename... Args>
+                TypeAt<I, T...> &emplace(Args &&...args)
+                {
+                    using Alternative = TypeAt<I, T...>;
+                    if constexpr (std::is_nothrow_constructible_v<Alternative, Args &&...>)
+                    {
+                        reset();
+                        construct<I>(std::forward<Args>(args)...);
+                    }
+                    else if constexpr (std::is_nothrow_move_constructible_v<Alternative>)
+                    {
+                        Alternative value(std::forward<Args>(args)...); // if this throws the variant is untouched
+                        reset();
+                        construct<I>(std::move(value));
+                    }
+                    else
+                    {
+                        reset(); // valueless if the construction throws
+                        construct<I>(std::forward<Args>(args)...);
+                    }
+                    return get<I>();
+                }
+                template <typename U, typename... Args>
+                U &emplace(Args &&...args)
+                {
+                    return emplace<indexOf<U, T...>()>(std::forward<Args>(args)...);
+                }
+
+                template <std::size_t I>
+                TypeAt<I, T...> &get()
+                {
+                    if (index_ != I)
+                        throw BadVariantAccess();
+                    return *ptr<I>();
+                }
+                template <std::size_t I>
+                TypeAt<I, T...> const &get() const
+                {
+                    if (index_ != I)
+                        throw BadVariantAccess();
+                    return *ptr<I>();
+                }
+                template <std::size_t I>
+                TypeAt<I, T...> *getIf() noexcept
+                {
+                    return index_ == I ? ptr<I>() : nullptr;
+                }
+                template <std::size_t I>
+                TypeAt<I, T...> const *getIf() const noexcept
+                {
+                    return index_ == I ? ptr<I>() : nullptr;
+                }
+
+                // Call visitor with the active alternative , one indirect call through a generated table
+                template <typename Visitor>
+                decltype(auto) visit(Visitor &&visitor)
+                {
+                    return visitImpl(*this, std::forward<Visitor>(visitor));
+                }
+                template <typename Visitor>
+                decltype(auto) visit(Visitor &&visitor) const
+                {
+                    return visitImpl(*this, std::forward<Visitor>(visitor));
+                }
+
+            private:
+                template <std::size_t I>
+                TypeAt<I, T...> *ptr() noexcept
+                {
+                    return std::launder(reinterpret_cast<TypeAt<I, T...> *>(storage_));
+                }
+                template <std::size_t I>
+                TypeAt<I, T...> const *ptr() const noexcept
+                {
+                    return std::launder(reinterpret_cast<TypeAt<I, T...> const *>(storage_));
+                }
+                template <std::size_t I, typename... Args>
+                void construct(Args &&...args)
+                {
+                    ::new (static_cast<void *>(storage_)) TypeAt<I, T...>(std::forward<Args>(args)...);
+                    index_ = static_cast<Index>(I);
+                }
+                void reset() noexcept
+                {
+                    if (!valueless_by_exception())
+                        destroyTable()[index_](*this);
+                    index_ = static_cast<Index>(npos);
+                }
+
+                // NOTE Every operation depending on the active alternative goes through one of these tables
+                using Unary = void (*)(Variant &);
+                using Binary = void (*)(Variant &, Variant const &);
+                using MoveBinary = void (*)(Variant &, Variant &);
+
+                template <std::size_t... I>
+                static constexpr std::array<Unary, sizeof...(T)> makeDestroyTable(std::index_sequence<I...>)
+                {
+                    return {[](Variant &self)
+                            {
+                                using Alternative = TypeAt<I, T...>;
+                                self.ptr<I>()->~Alternative();
+                            }...};
+                }
+                static constexpr auto destroyTable()
+                {
+                    return makeDestroyTable(std::index_sequence_for<T...>());
+                }
+                template <std::size_t... I>
+                static constexpr std::array<Binary, sizeof...(T)> makeCopyTable(std::index_sequence<I...>)
+                {
+                    return {[](Variant &self, Variant const &other)
+                            { self.construct<I>(*other.ptr<I>()); }...};
+                }
+                static constexpr auto copyTable()
+                {
+                    return makeCopyTable(std::index_sequence_for<T...>());
+                }
+                template <std::size_t... I>
+                static constexpr std::array<MoveBinary, sizeof...(T)> makeMoveTable(std::index_sequence<I...>)
+                {
+                    return {[](Variant &self, Variant &other)
+                            { self.construct<I>(std::move(*other.ptr<I>())); }...};
+                }
+                static constexpr auto moveTable()
+                {
+                    return makeMoveTable(std::index_sequence_for<T...>());
+                }
+                template <std::size_t... I>
+                static constexpr std::array<Binary, sizeof...(T)> makeCopyAssignTable(std::index_sequence<I...>)
+                {
+                    return {[](Variant &self, Variant const &other)
+                            {
+                                if (self.index_ == I)
+                                    *self.ptr<I>() = *other.ptr<I>();
+                                else
+                                    self.emplace<I>(*other.ptr<I>());
+                            }...};
+                }
+                static constexpr auto copyAssignTable()
+                {
+                    return makeCopyAssignTable(std::index_sequence_for<T...>());
+                }
+                template <std::size_t... I>
+                static constexpr std::array<MoveBinary, sizeof...(T)> makeMoveAssignTable(std::index_sequence<I...>)
+                {
+                    return {[](Variant &self, Variant &other)
+                            {
+                                if (self.index_ == I)
+                                    *self.ptr<I>() = std::move(*other.ptr<I>());
+                                else
+                                    self.emplace<I>(std::move(*other.ptr<I>()));
+                            }...};
+                }
+                static constexpr auto moveAssignTable()
+                {
+                    return makeMoveAssignTable(std::index_sequence_for<T...>());
+                }
+
+                template <typename Self, typename Visitor, std::size_t... I>
+                static decltype(auto) visitWithTable(Self &self, Visitor &&visitor, std::index_sequence<I...>)
+                {
+                    using Result = decltype(std::forward<Visitor>(visitor)(*self.template ptr<0>()));
+                    using Handler = Result (*)(Self &, Visitor &&);
+                    static constexpr Handler table[] = {[](Self &variant, Visitor &&visit) -> Result
+                                                        { return std::forward<Visitor>(visit)(*variant.template ptr<I>()); }...};
+                    return table[self.index_](self, std::forward<Visitor>(visitor));
+                }
+                template <typename Self, typename Visitor>
+                static decltype(auto) visitImpl(Self &self, Visitor &&visitor)
+                {
+                    if (self.valueless_by_exception())
+                        throw BadVariantAccess();
+                    return visitWithTable(self, std::forward<Visitor>(visitor), std::index_sequence_for<T...>());
+                }
+
+                alignas(T...) unsigned char storage_[std::max({sizeof(T)...})];
+                Index index_ = static_cast<Index>(npos);
+            };
+
+            template <std::size_t I, typename... T>
+            decltype(auto) get(Variant<T...> &variant)
+            {
+                return variant.template get<I>();
+            }
+            template <std::size_t I, typename... T>
+            decltype(auto) get(Variant<T...> const &variant)
+            {
+                return variant.template get<I>();
+            }
+            template <typename U, typename... T>
+            decltype(auto) get(Variant<T...> &variant)
+            {
+                return variant.template get<indexOf<U, T...>()>();
+            }
+            template <typename U, typename... T>
+            decltype(auto) get(Variant<T...> const &variant)
+            {
+                return variant.template get<indexOf<U, T...>()>();
+            }
+            template <typename U, typename... T>
+            bool holdsAlternative(Variant<T...> const &variant) noexcept
+            {
+                return variant.index() == indexOf<U, T...>();
+            }
+            template <typename Visitor, typename V>
+            decltype(auto) visit(Visitor &&visitor, V &&variant)
+            {
+                return std::forward<V>(variant).visit(std::forward<Visitor>(visitor));
+            }
+
+        } // namespace variadicClassTemplates
+
+    } // namespace chapter4
+
+} // namespace TemplateCompleteGuide
+
+// NOTE Structured binding support: auto [a, b] = Tuple{1, 2.0};
+template <typename... T>
+struct std::tuple_size<TemplateCompleteGuide::chapter4::variadicClassTemplates::Tuple<T...>> : std::integral_constant<std::size_t, sizeof...(T)>
+{
+};
+template <std::size_t I, typename... T>
+struct std::tuple_element<I, TemplateCompleteGuide::chapter4::variadicClassTemplates::Tuple<T...>>
+{
+    using type = TemplateCompleteGuide::chapter4::variadicClassTemplates::TypeAt<I, T...>;
+};
+
+#endif
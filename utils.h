@@ -1,16 +1,17 @@
 #ifndef __UTILS_H__
 #define __UTILS_H__
 
-void Clear()
+#include <cstdlib>
+#include <iostream>
+
+// For a screen refreshed often , see terminal::Renderer in terminal.h: it only sends what changed
+inline void Clear()
 {
 #if defined _WIN32
     system("cls");
     // clrscr(); // including header file : conio.h
-#elif defined(__LINUX__) || defined(__gnu_linux__) || defined(__linux__)
-    system("clear");
-    // std::cout<< u8"\033[2J\033[1;1H"; //Using ANSI Escape Sequences
-#elif defined(__APPLE__)
-    system("clear");
+#else
+    std::cout << "\033[2J\033[1;1H" << std::flush; // Using ANSI Escape Sequences , instead of a shell running clear
 #endif
 }
 